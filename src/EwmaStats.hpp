@@ -0,0 +1,338 @@
+/**
+ *                                 [PHOTIC]
+ *                                  v3.2.0
+ *
+ * This file is part of Photic, a collection of utilities for writing high-power
+ * rocket flight computer software. Developed in Austin, TX by the Longhorn
+ * Rocketry Association at the University of Texas at Austin.
+ *
+ *                            ---- THIS FILE ----
+ *
+ * EwmaStats tracks an exponentially weighted mean and variance of a signal in
+ * a few words of state, for checks that do not need a window of raw elements.
+ * It has the same add, getMean and getStdev interface as History.
+ *
+ * TimedEwmaStats weights by a time constant instead of a fixed smoothing
+ * factor, for signals sampled at a varying rate. EwmaCrossover tracks a signal
+ * at two rates and reports when the fast mean crosses the slow mean.
+ *
+ *                              ---- USAGE ----
+ *
+ *   (1) Create an EwmaStats with a smoothing factor alpha in (0, 1]. Larger
+ *       factors weight new elements more.
+ *
+ *         Photic::EwmaStats<> pressureStats (0.05);
+ *         pressureStats.add (baro.getPressure ());
+ *         Real_t pressureStdev = pressureStats.getStdev ();
+ *
+ *   (2) Or create a TimedEwmaStats with a time constant in seconds, and add
+ *       elements with the time since the last element.
+ *
+ *         Photic::TimedEwmaStats<> accelStats (0.2);
+ *         accelStats.add (vertAccel, dt);
+ *
+ *   (3) Detect a sustained change as the fast mean crossing the slow mean,
+ *       e.g. liftoff.
+ *
+ *         Photic::EwmaCrossover<Photic::TimedEwmaStats<>> liftoff (
+ *             Photic::TimedEwmaStats<> (0.05),
+ *             Photic::TimedEwmaStats<> (2), 5);
+ *         if (liftoff.add (vertAccel, dt) > 0) { ... }
+ *
+ *                              ---- NOTES ----
+ *
+ *   (1) The mean and variance are updated with the incremental exponentially
+ *       weighted recurrence
+ *
+ *         d = x - mean
+ *         mean = mean + alpha d
+ *         var = (1 - alpha) (var + alpha d^2)
+ *
+ *       which never subtracts large sums. The first element sets the mean with
+ *       a variance of 0.
+ *
+ *   (2) An element dt seconds after the last is weighted by
+ *       alpha = 1 - e^(-dt / tau), so the weight of past elements decays by e
+ *       every tau seconds regardless of the sample rate. The exponential uses
+ *       MathUtils::Fast::exp.
+ *
+ *   (3) EwmaCrossover keeps the side of the slow mean the fast mean is on,
+ *       and only switches sides once the fast mean is past the slow mean by
+ *       more than a hysteresis margin, so noise near the crossing does not
+ *       report repeated crossings. Both means start at the first element,
+ *       level with each other, so the first excursion past the margin is a
+ *       crossing too.
+ *
+ *   (4) The mean of an empty EwmaStats is undefined.
+ */
+
+#ifndef PHOTIC_EWMA_STATS_HPP
+#define PHOTIC_EWMA_STATS_HPP
+
+#include <math.h>
+
+#include "MathUtils.hpp"
+#include "Types.hpp"
+
+namespace Photic
+{
+
+template <typename T_Scalar = Real_t>
+class EwmaStats
+{
+public:
+    typedef T_Scalar Scalar_t;
+
+protected:
+    T_Scalar mAlpha;    /* Weight of the newest element. */
+    T_Scalar mMean;     /* Weighted mean. */
+    T_Scalar mVariance; /* Weighted variance. */
+    bool     mEmpty;    /* If no element has been added since clearing. */
+
+    /**
+     * Adds an element weighted by mAlpha. See note (1).
+     *
+     * @param   kData New element.
+     */
+    void update (const T_Scalar kData)
+    {
+        if (mEmpty)
+        {
+            mMean = kData;
+            mVariance = 0;
+            mEmpty = false;
+            return;
+        }
+
+        const T_Scalar diff = kData - mMean;
+        const T_Scalar incr = mAlpha * diff;
+        mMean += incr;
+        mVariance = (1 - mAlpha) * (mVariance + diff * incr);
+    }
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param   kAlpha Smoothing factor in (0, 1].
+     */
+    explicit EwmaStats (const T_Scalar kAlpha) :
+        mAlpha (kAlpha), mMean (0), mVariance (0), mEmpty (true)
+    {}
+
+    /**
+     * Adds a new element.
+     *
+     * @param   kData New element.
+     */
+    void add (const T_Scalar kData)
+    {
+        this->update (kData);
+    }
+
+    /**
+     * Gets the weighted mean.
+     *
+     * @ret     Mean.
+     */
+    T_Scalar getMean () const
+    {
+        return mMean;
+    }
+
+    /**
+     * Gets the weighted variance.
+     *
+     * @ret     Variance.
+     */
+    T_Scalar getVariance () const
+    {
+        return mVariance;
+    }
+
+    /**
+     * Gets the weighted standard deviation.
+     *
+     * @ret     Standard deviation.
+     */
+    T_Scalar getStdev () const
+    {
+        return sqrt (mVariance);
+    }
+
+    /**
+     * Gets the weight of the newest element.
+     *
+     * @ret     Smoothing factor.
+     */
+    T_Scalar getAlpha () const
+    {
+        return mAlpha;
+    }
+
+    /**
+     * Clears all elements.
+     */
+    void clear ()
+    {
+        mMean = 0;
+        mVariance = 0;
+        mEmpty = true;
+    }
+};
+
+template <typename T_Scalar = Real_t>
+class TimedEwmaStats : public EwmaStats<T_Scalar>
+{
+protected:
+    T_Scalar mInvTau; /* Reciprocal of the time constant in 1/s. */
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param   kTau Time constant in seconds.
+     */
+    explicit TimedEwmaStats (const T_Scalar kTau) :
+        EwmaStats<T_Scalar> (1), mInvTau (1 / kTau)
+    {}
+
+    /**
+     * Adds a new element. See note (2).
+     *
+     * @param   kData New element.
+     * @param   kDt   Time since the last element in seconds.
+     */
+    void add (const T_Scalar kData, const T_Scalar kDt)
+    {
+        this->mAlpha = 1 - MathUtils::Fast::exp (-kDt * mInvTau);
+        this->update (kData);
+    }
+};
+
+template <typename T_Ewma>
+class EwmaCrossover
+{
+public:
+    typedef typename T_Ewma::Scalar_t Scalar_t;
+
+protected:
+    T_Ewma   mFast;       /* Fast tracker. */
+    T_Ewma   mSlow;       /* Slow tracker. */
+    Scalar_t mHysteresis; /* Margin to switch sides. */
+    int8_t   mSide;       /* 1 above, -1 below, 0 level. */
+
+    /**
+     * Updates the side of the slow mean the fast mean is on.
+     *
+     * @ret     1 if the fast mean crossed above the slow mean, -1 if it
+     *          crossed below, else 0.
+     */
+    int8_t updateSide ()
+    {
+        const Scalar_t spread = this->getSpread ();
+        const int8_t side = spread > mHysteresis ?
+            1 : (spread < -mHysteresis ? -1 : mSide);
+        const int8_t crossing = side != mSide ? side : 0;
+        mSide = side;
+        return crossing;
+    }
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param   kFast       Fast tracker, e.g. a short time constant.
+     * @param   kSlow       Slow tracker, e.g. a long time constant.
+     * @param   kHysteresis Margin to switch sides. See note (3).
+     */
+    EwmaCrossover (const T_Ewma& kFast, const T_Ewma& kSlow,
+                   const Scalar_t kHysteresis = 0) :
+        mFast (kFast), mSlow (kSlow), mHysteresis (kHysteresis), mSide (0)
+    {}
+
+    /**
+     * Adds a new element to both trackers.
+     *
+     * @param   kData New element.
+     *
+     * @ret     1 if the fast mean crossed above the slow mean, -1 if it
+     *          crossed below, else 0.
+     */
+    int8_t add (const Scalar_t kData)
+    {
+        mFast.add (kData);
+        mSlow.add (kData);
+        return this->updateSide ();
+    }
+
+    /**
+     * Adds a new element to both trackers. For time constant trackers.
+     *
+     * @param   kData New element.
+     * @param   kDt   Time since the last element in seconds.
+     *
+     * @ret     1 if the fast mean crossed above the slow mean, -1 if it
+     *          crossed below, else 0.
+     */
+    int8_t add (const Scalar_t kData, const Scalar_t kDt)
+    {
+        mFast.add (kData, kDt);
+        mSlow.add (kData, kDt);
+        return this->updateSide ();
+    }
+
+    /**
+     * Gets the fast mean less the slow mean.
+     *
+     * @ret     Spread.
+     */
+    Scalar_t getSpread () const
+    {
+        return mFast.getMean () - mSlow.getMean ();
+    }
+
+    /**
+     * Gets the side of the slow mean the fast mean is on.
+     *
+     * @ret     1 above, -1 below, 0 if not yet past the margin.
+     */
+    int8_t getSide () const
+    {
+        return mSide;
+    }
+
+    /**
+     * Gets the fast tracker.
+     *
+     * @ret     Fast tracker.
+     */
+    const T_Ewma& getFast () const
+    {
+        return mFast;
+    }
+
+    /**
+     * Gets the slow tracker.
+     *
+     * @ret     Slow tracker.
+     */
+    const T_Ewma& getSlow () const
+    {
+        return mSlow;
+    }
+
+    /**
+     * Clears both trackers.
+     */
+    void clear ()
+    {
+        mFast.clear ();
+        mSlow.clear ();
+        mSide = 0;
+    }
+};
+
+} // namespace Photic
+
+#endif
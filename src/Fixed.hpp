@@ -0,0 +1,413 @@
+/**
+ *                                 [PHOTIC]
+ *                                  v3.2.0
+ *
+ * This file is part of Photic, a collection of utilities for writing high-power
+ * rocket flight computer software. Developed in Austin, TX by the Longhorn
+ * Rocketry Association at the University of Texas at Austin.
+ *
+ *                            ---- THIS FILE ----
+ *
+ * Signed fixed-point number in Q format, e.g. Fixed<16> is Q16.16: a 32-bit
+ * integer scaled by 2^-16, with range [-32768, 32768) and resolution 2^-16.
+ *
+ * Fixed is intended for targets without an FPU (e.g. AVR), where every float
+ * operation is a software library call. It can be used as the element type of
+ * Matrix, SymmetricMatrix, StructuredMatrix, History and BasicKalmanFilter, and
+ * every operation is done with 32-bit (and for products, 64-bit) integer
+ * arithmetic.
+ *
+ *                              ---- USAGE ----
+ *
+ *   Fixed converts implicitly from any arithmetic type and explicitly to float
+ *   and double:
+ *
+ *     Fixed<16> x = 1.5;
+ *     Fixed<16> y = x * 2 + sqrt (x);
+ *     Matrix<3, 3, Fixed<16>> a = Matrix<3, 3, Fixed<16>>::identity ();
+ *     BasicKalmanFilter<Fixed<12>> kf;
+ *     float f = (float) y;
+ *
+ *                              ---- NOTES ----
+ *
+ *   (1) Arithmetic saturates: a result outside the representable range is
+ *       replaced by the nearest limit instead of wrapping around. Division by
+ *       zero saturates in the direction of the dividend's sign.
+ *
+ *   (2) Products and quotients are rounded to the nearest representable value.
+ *       Conversions from floating point are rounded to nearest, and NaN
+ *       converts to 0.
+ *
+ *   (3) Division multiplies by a reciprocal found with three Newton-Raphson
+ *       iterations, which is much cheaper than a 64-bit integer division on
+ *       8-bit targets. Quotients are within 2 LSB of the exact quotient.
+ *       reciprocal (x) exposes the same computation.
+ *
+ *   (4) sqrt (x) uses an integer digit-by-digit square root with no
+ *       multiplies. It requires an even number of fractional bits no greater
+ *       than 24. Negative inputs return 0.
+ *
+ *   (5) Choose the number of fractional bits to suit the range of the data,
+ *       not just its precision. Intermediate results must also fit, e.g. a
+ *       History's sum of squares. A History of large values can accumulate in
+ *       a wider type, e.g. History<100, Fixed<16>, float>.
+ */
+
+#ifndef PHOTIC_FIXED_HPP
+#define PHOTIC_FIXED_HPP
+
+#include "Types.hpp"
+
+namespace Photic
+{
+
+/**
+ * @param   T_FracBits Number of fractional bits, between 1 and 30.
+ */
+template <uint8_t T_FracBits = 16>
+class Fixed final
+{
+public:
+    static_assert (T_FracBits > 0 && T_FracBits < 31,
+                   "Fixed must have between 1 and 30 fractional bits");
+
+    /**
+     * Default constructor does nothing, like the built-in arithmetic types.
+     */
+    Fixed () = default;
+
+    /**
+     * Converts a number to fixed point. See notes (1) and (2).
+     *
+     * @param   kValue Value to convert. Any arithmetic type.
+     */
+    template <typename T_Value>
+    constexpr Fixed (const T_Value kValue) :
+        mRaw ((T_Value) 1 / (T_Value) 2 == 0 ?
+                  saturate ((int64_t) kValue * one) :
+                  roundRaw ((double) kValue * one)) {}
+
+    /**
+     * Makes a number from its underlying integer.
+     *
+     * @param   kRaw Value scaled by 2^T_FracBits.
+     *
+     * @ret     Fixed-point number.
+     */
+    static constexpr Fixed fromRaw (const int32_t kRaw)
+    {
+        return Fixed (kRaw, RawTag ());
+    }
+
+    /**
+     * Gets the largest representable number.
+     *
+     * @ret     Largest number.
+     */
+    static constexpr Fixed max ()
+    {
+        return fromRaw (maxRaw);
+    }
+
+    /**
+     * Gets the most negative representable number.
+     *
+     * @ret     Most negative number.
+     */
+    static constexpr Fixed lowest ()
+    {
+        return fromRaw (minRaw);
+    }
+
+    /**
+     * Gets the underlying integer.
+     *
+     * @ret     Value scaled by 2^T_FracBits.
+     */
+    constexpr int32_t raw () const
+    {
+        return mRaw;
+    }
+
+    /**
+     * Converts to floating point.
+     */
+    explicit constexpr operator float () const
+    {
+        return (float) mRaw / one;
+    }
+
+    explicit constexpr operator double () const
+    {
+        return (double) mRaw / one;
+    }
+
+    /**
+     * Arithmetic operators. See notes (1)-(3).
+     */
+    Fixed operator- () const
+    {
+        return fromRaw (mRaw == minRaw ? maxRaw : -mRaw);
+    }
+
+    friend Fixed operator+ (const Fixed kLhs, const Fixed kRhs)
+    {
+        // Overflow occurred if the operands have the same sign and the wrapped
+        // sum does not.
+        const int32_t sum = (int32_t) ((uint32_t) kLhs.mRaw +
+                                       (uint32_t) kRhs.mRaw);
+        if (((kLhs.mRaw ^ sum) & (kRhs.mRaw ^ sum)) < 0)
+        {
+            return fromRaw (kLhs.mRaw < 0 ? minRaw : maxRaw);
+        }
+
+        return fromRaw (sum);
+    }
+
+    friend Fixed operator- (const Fixed kLhs, const Fixed kRhs)
+    {
+        // Overflow occurred if the operands have different signs and the
+        // wrapped difference does not have the sign of the LHS.
+        const int32_t diff = (int32_t) ((uint32_t) kLhs.mRaw -
+                                        (uint32_t) kRhs.mRaw);
+        if (((kLhs.mRaw ^ kRhs.mRaw) & (kLhs.mRaw ^ diff)) < 0)
+        {
+            return fromRaw (kLhs.mRaw < 0 ? minRaw : maxRaw);
+        }
+
+        return fromRaw (diff);
+    }
+
+    friend Fixed operator* (const Fixed kLhs, const Fixed kRhs)
+    {
+        const int64_t product = (int64_t) kLhs.mRaw * kRhs.mRaw;
+        return fromRaw (saturate ((product + one / 2) >> T_FracBits));
+    }
+
+    friend Fixed operator/ (const Fixed kLhs, const Fixed kRhs)
+    {
+        if (kRhs.mRaw == 0)
+        {
+            return fromRaw (kLhs.mRaw < 0 ? minRaw : maxRaw);
+        }
+
+        // |rhs| = m 2^-shift with m normalized to [2^31, 2^32), so
+        // |lhs / rhs| = |lhs| (2^62 / m) 2^(shift + T_FracBits - 62) in raw
+        // units.
+        uint8_t shift;
+        const uint32_t recip = reciprocalMantissa (kRhs.mRaw, shift);
+        const uint8_t down = 62 - shift - T_FracBits;
+        const uint64_t quotient =
+            ((uint64_t) magnitude (kLhs.mRaw) * recip +
+             ((uint64_t) 1 << (down - 1))) >> down;
+
+        return fromRaw (saturate ((kLhs.mRaw < 0) != (kRhs.mRaw < 0) ?
+                                      -(int64_t) quotient :
+                                      (int64_t) quotient));
+    }
+
+    Fixed& operator+= (const Fixed kRhs)
+    {
+        return *this = *this + kRhs;
+    }
+
+    Fixed& operator-= (const Fixed kRhs)
+    {
+        return *this = *this - kRhs;
+    }
+
+    Fixed& operator*= (const Fixed kRhs)
+    {
+        return *this = *this * kRhs;
+    }
+
+    Fixed& operator/= (const Fixed kRhs)
+    {
+        return *this = *this / kRhs;
+    }
+
+    /**
+     * Comparison operators.
+     */
+    friend constexpr bool operator== (const Fixed kLhs, const Fixed kRhs)
+    {
+        return kLhs.mRaw == kRhs.mRaw;
+    }
+
+    friend constexpr bool operator!= (const Fixed kLhs, const Fixed kRhs)
+    {
+        return kLhs.mRaw != kRhs.mRaw;
+    }
+
+    friend constexpr bool operator< (const Fixed kLhs, const Fixed kRhs)
+    {
+        return kLhs.mRaw < kRhs.mRaw;
+    }
+
+    friend constexpr bool operator<= (const Fixed kLhs, const Fixed kRhs)
+    {
+        return kLhs.mRaw <= kRhs.mRaw;
+    }
+
+    friend constexpr bool operator> (const Fixed kLhs, const Fixed kRhs)
+    {
+        return kLhs.mRaw > kRhs.mRaw;
+    }
+
+    friend constexpr bool operator>= (const Fixed kLhs, const Fixed kRhs)
+    {
+        return kLhs.mRaw >= kRhs.mRaw;
+    }
+
+    /**
+     * Math functions, found by argument-dependent lookup like their
+     * <math.h> counterparts, e.g. sqrt (x).
+     */
+    friend Fixed fabs (const Fixed kValue)
+    {
+        return kValue.mRaw < 0 ? -kValue : kValue;
+    }
+
+    /**
+     * Computes 1 / x. See note (3).
+     */
+    friend Fixed reciprocal (const Fixed kValue)
+    {
+        return fromRaw ((int32_t) one) / kValue;
+    }
+
+    /**
+     * Computes the square root. See note (4).
+     */
+    friend Fixed sqrt (const Fixed kValue)
+    {
+        static_assert ((T_FracBits & 1) == 0 && T_FracBits <= 24,
+                       "Fixed sqrt requires an even number of fractional "
+                       "bits no greater than 24");
+
+        if (kValue.mRaw <= 0)
+        {
+            return fromRaw (0);
+        }
+
+        // Computes isqrt (raw 2^T_FracBits) two bits of the radicand at a
+        // time. The low T_FracBits bits of the radicand are zeros shifted in
+        // after the raw value is consumed.
+        uint32_t remLo = (uint32_t) kValue.mRaw;
+        uint32_t remHi = 0;
+        uint32_t root = 0;
+        for (uint8_t i = 0; i < 16 + T_FracBits / 2; i++)
+        {
+            remHi = (remHi << 2) | (remLo >> 30);
+            remLo <<= 2;
+            root <<= 1;
+            const uint32_t testDiv = (root << 1) + 1;
+            if (remHi >= testDiv)
+            {
+                remHi -= testDiv;
+                root++;
+            }
+        }
+
+        return fromRaw ((int32_t) root);
+    }
+
+private:
+    /**
+     * Raw value limits and the raw value of 1.
+     */
+    static constexpr int32_t maxRaw = 2147483647;
+    static constexpr int32_t minRaw = -maxRaw - 1;
+    static constexpr int64_t one = (int64_t) 1 << T_FracBits;
+
+    /**
+     * Distinguishes the raw constructor from the converting constructor.
+     */
+    struct RawTag {};
+
+    int32_t mRaw; /* Value scaled by 2^T_FracBits. */
+
+    constexpr Fixed (const int32_t kRaw, RawTag) : mRaw (kRaw) {}
+
+    /**
+     * Clamps a wide raw value to the representable range.
+     *
+     * @param   kRaw Raw value.
+     *
+     * @ret     Saturated raw value.
+     */
+    static constexpr int32_t saturate (const int64_t kRaw)
+    {
+        return kRaw > maxRaw ? maxRaw :
+               (kRaw < minRaw ? minRaw : (int32_t) kRaw);
+    }
+
+    /**
+     * Rounds and clamps a scaled floating point value to a raw value.
+     *
+     * @param   kRaw Scaled value.
+     *
+     * @ret     Saturated raw value, or 0 for NaN.
+     */
+    static constexpr int32_t roundRaw (const double kRaw)
+    {
+        return kRaw != kRaw ? 0 :
+               (kRaw >= maxRaw ? maxRaw :
+               (kRaw <= minRaw ? minRaw :
+               (int32_t) (kRaw < 0 ? kRaw - 0.5 : kRaw + 0.5)));
+    }
+
+    /**
+     * Gets the magnitude of a raw value. Exact for minRaw.
+     *
+     * @param   kRaw Raw value.
+     *
+     * @ret     |kRaw|.
+     */
+    static uint32_t magnitude (const int32_t kRaw)
+    {
+        return kRaw < 0 ? 0u - (uint32_t) kRaw : (uint32_t) kRaw;
+    }
+
+    /**
+     * Normalizes the magnitude of a non-zero raw value to m in [2^31, 2^32)
+     * and computes 2^62 / m with Newton-Raphson iterations.
+     *
+     * @param   kRaw   Non-zero raw value.
+     * @param   kShift Set to the shift applied to normalize the magnitude.
+     *
+     * @ret     2^62 / m, within a few units.
+     */
+    static uint32_t reciprocalMantissa (const int32_t kRaw, uint8_t& kShift)
+    {
+        uint32_t m = magnitude (kRaw);
+        kShift = 0;
+        while ((m & 0xFF000000u) == 0)
+        {
+            m <<= 8;
+            kShift += 8;
+        }
+        while ((m & 0x80000000u) == 0)
+        {
+            m <<= 1;
+            kShift++;
+        }
+
+        // Reciprocal of the mantissa m 2^-32 in [0.5, 1) is kept in Q2.30. The
+        // initial estimate 48/17 - 32/17 m 2^-32 is within 1/17 of it, and each
+        // iteration roughly doubles the number of correct bits.
+        uint32_t recip =
+            3031741621u - (uint32_t) (((uint64_t) m * 2021161080u) >> 32);
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            const uint32_t err = (uint32_t) (((uint64_t) m * recip) >> 32);
+            recip = (uint32_t) (((uint64_t) recip * (0x80000000u - err)) >> 30);
+        }
+
+        return recip;
+    }
+};
+
+} // namespace Photic
+
+#endif
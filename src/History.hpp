@@ -44,13 +44,44 @@
  *       is implemented with a statically sized array and wrapping index. This
  *       is the fastest data structure for the task since History is unordered.
  *
- *   (2) History statistics (currently just mean and standard deviation) are
- *       cached. They are only recomputed when the user tries to access a
- *       statistic and the History has changed since the last statistic
- *       computation. This action will recompute ALL statistics and not just the
- *       requested statistic.
+ *   (2) History maintains running sums of its elements and their squares,
+ *       which add updates by removing the evicted element and adding the new
+ *       one, so statistics cost O(1) regardless of capacity. The sums are of
+ *       the elements less a reference element, which avoids the cancellation
+ *       of large squares when the spread is small next to the values. To bound
+ *       the rounding drift of the running sums, they are recomputed exactly
+ *       from the elements each time the ring buffer index wraps, i.e. once
+ *       every T_Dim adds, which keeps add amortized O(1). Statistics computed
+ *       from the sums are cached until the next add.
  *
  *   (3) The behavior of a zero capacity History is undefined.
+ *
+ *   (4) The element type is a template parameter which defaults to Real_t,
+ *       e.g. History<100, double>. Statistics are accumulated and returned in
+ *       the element type unless a wider accumulator type is given, e.g.
+ *       History<1000, float, double> stores floats but computes its mean and
+ *       standard deviation in double.
+ *
+ *   (5) How elements are stored is set by a storage policy, the fourth
+ *       template parameter. The default stores elements as is. Quantized
+ *       storage keeps each element as an int8_t or int16_t, offset + scale q,
+ *       cutting memory 2-4x for float elements, e.g.
+ *
+ *         Photic::History<1000, float, float,
+ *                         Photic::QuantizedStorage<int16_t>>
+ *             altHist (Photic::QuantizedStorage<int16_t> (0.01));
+ *
+ *       stores altitudes to the nearest centimeter in 2 KB instead of 4 KB.
+ *       With no offset given, the offset starts at the first element added to
+ *       the empty history, so elements are stored as deltas from it. When an
+ *       element falls outside the representable range, the offset moves by
+ *       whole steps to center the elements in the range, which re-encodes the
+ *       buffer in O(T_Dim) but keeps every quantized value. A drifting signal
+ *       is therefore only limited by the spread of the window, not by how far
+ *       it drifts. Elements that still do not fit, or that fall outside the
+ *       range of a fixed offset, saturate, and getSaturations counts them.
+ *       Statistics are computed in full precision from the decoded elements,
+ *       so they are exact for the quantized values.
  */
 
 #ifndef PHOTIC_HISTORY_HPP
@@ -70,57 +101,303 @@ namespace Photic
  */
 typedef uint16_t HistoryDim_t;
 
-template <HistoryDim_t T_Dim>
-class History
+/**
+ * Default History storage policy, which stores elements as is.
+ */
+template <typename T_Scalar>
+struct HistoryStorage
+{
+    typedef T_Scalar Stored_t;
+
+    static T_Scalar encode (const T_Scalar kVal)
+    {
+        return kVal;
+    }
+
+    static T_Scalar decode (const T_Scalar kStored)
+    {
+        return kStored;
+    }
+
+    void rebase (const T_Scalar) {}
+
+    void accommodate (const T_Scalar, T_Scalar* const, const HistoryDim_t,
+                      const HistoryDim_t) {}
+
+    static uint32_t getSaturations ()
+    {
+        return 0;
+    }
+};
+
+/**
+ * History storage policy which stores each element as a signed integer q,
+ * representing offset + scale q. See note (5).
+ *
+ * Since the scale is positive, stored integers order the same as the values
+ * they represent.
+ */
+template <typename T_Int, typename T_Scalar = Real_t>
+class QuantizedStorage
+{
+    static_assert (sizeof (T_Int) <= 2, "Quantized storage must be int8_t or "
+                                        "int16_t");
+
+public:
+    typedef T_Int Stored_t;
+
+    /**
+     * Constructor for storage relative to the first element added to an empty
+     * history.
+     *
+     * @param   kScale Positive quantization step.
+     */
+    explicit QuantizedStorage (const T_Scalar kScale) :
+        mScale (kScale), mInvScale (1 / kScale), mOffset (0),
+        mAutoOffset (true), mSaturations (0)
+    {}
+
+    /**
+     * Constructor for storage relative to a fixed offset.
+     *
+     * @param   kScale  Positive quantization step.
+     * @param   kOffset Value represented by 0.
+     */
+    QuantizedStorage (const T_Scalar kScale, const T_Scalar kOffset) :
+        mScale (kScale), mInvScale (1 / kScale), mOffset (kOffset),
+        mAutoOffset (false), mSaturations (0)
+    {}
+
+    /**
+     * Quantizes a value, rounding to the nearest step and saturating.
+     *
+     * @param   kVal Value.
+     *
+     * @ret     Stored integer.
+     */
+    T_Int encode (const T_Scalar kVal) const
+    {
+        const T_Scalar maxStored = MAX_STORED;
+        const T_Scalar q = (kVal - mOffset) * mInvScale;
+        if (!(q < maxStored))
+        {
+            return (T_Int) maxStored;
+        }
+        if (!(q > -maxStored - 1))
+        {
+            return (T_Int) (-maxStored - 1);
+        }
+        return (T_Int) (q < 0 ? q - (T_Scalar) 0.5 : q + (T_Scalar) 0.5);
+    }
+
+    /**
+     * Gets the value a stored integer represents.
+     *
+     * @param   kStored Stored integer.
+     *
+     * @ret     Value.
+     */
+    T_Scalar decode (const T_Int kStored) const
+    {
+        return mOffset + mScale * kStored;
+    }
+
+    /**
+     * Takes the offset from the first element added to an empty history, if
+     * no fixed offset was given.
+     *
+     * @param   kFirst First element.
+     */
+    void rebase (const T_Scalar kFirst)
+    {
+        if (mAutoOffset)
+        {
+            mOffset = kFirst;
+        }
+    }
+
+    /**
+     * Makes room for a new element outside the representable range. With an
+     * automatic offset, the offset moves by whole steps to center the new and
+     * stored elements in the range, and the stored integers shift to match.
+     * If they span more than the range, or the offset is fixed, the new
+     * element will saturate, which is counted. See note (5).
+     *
+     * @param   kVal   New element.
+     * @param   kData  Stored integers.
+     * @param   kCount Number of stored integers.
+     * @param   kSkip  Index of a stored integer about to be overwritten, or
+     *                 kCount if none.
+     */
+    void accommodate (const T_Scalar kVal, T_Int* const kData,
+                      const HistoryDim_t kCount, const HistoryDim_t kSkip)
+    {
+        const T_Scalar q = (kVal - mOffset) * mInvScale;
+        if (q < MAX_STORED && q > -MAX_STORED - 1)
+        {
+            return;
+        }
+
+        // Range of the stored integers and the new element, in steps.
+        T_Scalar lo = q;
+        T_Scalar hi = q;
+        for (HistoryDim_t i = 0; i < kCount; i++)
+        {
+            lo = i != kSkip && kData[i] < lo ? kData[i] : lo;
+            hi = i != kSkip && kData[i] > hi ? kData[i] : hi;
+        }
+        if (!mAutoOffset || !(hi - lo < 2 * MAX_STORED - 1))
+        {
+            mSaturations++;
+            return;
+        }
+
+        // Shifting by whole steps leaves every stored value unchanged.
+        const T_Scalar mid = (lo + hi) / 2;
+        const int32_t shift =
+            (int32_t) (mid < 0 ? mid - (T_Scalar) 0.5 : mid + (T_Scalar) 0.5);
+        for (HistoryDim_t i = 0; i < kCount; i++)
+        {
+            kData[i] = i == kSkip ? 0 : (T_Int) (kData[i] - shift);
+        }
+        mOffset += mScale * shift;
+    }
+
+    /**
+     * Gets the number of elements that saturated when stored.
+     *
+     * @ret     Number of saturated elements.
+     */
+    uint32_t getSaturations () const
+    {
+        return mSaturations;
+    }
+
+private:
+    /**
+     * Largest stored integer.
+     */
+    static constexpr int32_t MAX_STORED =
+        (int32_t) ((1L << (8 * sizeof (T_Int) - 1)) - 1);
+
+    T_Scalar mScale;       /* Quantization step. */
+    T_Scalar mInvScale;    /* 1 / step. */
+    T_Scalar mOffset;      /* Value represented by 0. */
+    bool mAutoOffset;      /* If the offset comes from the elements. */
+    uint32_t mSaturations; /* Number of saturated elements. */
+};
+
+template <HistoryDim_t T_Dim, typename T_Scalar = Real_t,
+          typename T_Accum = T_Scalar,
+          typename T_Storage = HistoryStorage<T_Scalar>>
+class History : protected T_Storage
 {
 protected:
-    Real_t       mData[T_Dim]; /* Data in history in no particular order. */
+    typedef typename T_Storage::Stored_t Stored_t;
+
+    Stored_t     mData[T_Dim]; /* Data in history in no particular order. */
     HistoryDim_t mCurrentSize; /* Current number of elements in history. */
     HistoryDim_t mIdx;         /* Index where next history entry will go. */
-    Real_t       mMean;        /* Last computed history mean. */
-    Real_t       mStdev;       /* Last computed history standard deviation. */
+    T_Accum      mShift;       /* Reference subtracted from x in sums. */
+    T_Accum      mSigmaX;      /* Running Sigma(x - shift) over history. */
+    T_Accum      mSigmaXSqr;   /* Running Sigma((x - shift)^2). */
+    T_Accum      mMean;        /* Last computed history mean. */
+    T_Accum      mStdev;       /* Last computed history standard deviation. */
     bool         mDirty;       /* If mMean and mStdev are out of date. */
 
     /**
-     * Computes the mean and standard deviation of the history.
+     * Recomputes the running sums exactly from the elements in the history,
+     * shifted by the first element.
      */
-    void computeStats ()
+    void computeSums ()
     {
-        const HistoryDim_t n = mCurrentSize;
-        Real_t sigmaX = 0;
-        Real_t sigmaXSqr = 0;
+        mShift = this->element (0);
+        mSigmaX = 0;
+        mSigmaXSqr = 0;
 
-        // For all x in history, compute Sigma(x) and Sigma(x^2).
-        for (HistoryDim_t i = 0; i < n; i++)
+        // For all x in history, compute Sigma(x - shift) and
+        // Sigma((x - shift)^2).
+        for (HistoryDim_t i = 0; i < mCurrentSize; i++)
         {
-            sigmaX += mData[i];
-            sigmaXSqr += mData[i] * mData[i];
+            const T_Accum x = this->element (i) - mShift;
+            mSigmaX += x;
+            mSigmaXSqr += x * x;
         }
+    }
 
-        // Compute mean and stdev.
-        mMean = sigmaX / n;
-        mStdev = n < 2 ?
-                     0 : sqrt ((sigmaXSqr - sigmaX * sigmaX / n) / n);
+    /**
+     * Computes the mean and standard deviation of the history from the
+     * running sums.
+     */
+    void computeStats ()
+    {
+        const HistoryDim_t n = mCurrentSize;
+
+        // Compute mean and stdev. Rounding can leave the variance slightly
+        // negative when the elements are nearly equal.
+        mMean = mShift + mSigmaX / n;
+        const T_Accum variance =
+            n < 2 ? 0 : (mSigmaXSqr - mSigmaX * mSigmaX / n) / n;
+        mStdev = variance > 0 ? sqrt (variance) : 0;
 
         // Mark these stats as up to date.
         mDirty = false;
     }
 
+    /**
+     * Gets an element.
+     *
+     * @param   kSlot Ring buffer slot.
+     *
+     * @ret     Element in slot.
+     */
+    T_Scalar element (const HistoryDim_t kSlot) const
+    {
+        return this->decode (mData[kSlot]);
+    }
+
 public:
     /**
      * Constructor.
+     *
+     * @param   kStorage Storage policy. See note (5).
      */
-    History () : mCurrentSize (0), mIdx (0), mDirty (true) {}
+    explicit History (const T_Storage& kStorage = T_Storage ()) :
+        T_Storage (kStorage), mCurrentSize (0), mIdx (0), mShift (0),
+        mSigmaX (0), mSigmaXSqr (0), mMean (0), mStdev (0), mDirty (true)
+    {}
 
     /**
      * Adds a new element to the history. If the history is at capacity, the
-     * oldest element is thrown out.
+     * oldest element is thrown out. See note (2).
      *
      * @param   kData New element.
      */
-    void add (const Real_t kData)
+    void add (const T_Scalar kData)
     {
-        mData[mIdx++] = kData;
+        // Replace the oldest element's contribution to the running sums. The
+        // first element of an empty history becomes the shift.
+        if (mCurrentSize == T_Dim)
+        {
+            const T_Accum oldest = this->element (mIdx) - mShift;
+            mSigmaX -= oldest;
+            mSigmaXSqr -= oldest * oldest;
+        }
+        else if (mCurrentSize == 0)
+        {
+            this->rebase (kData);
+            mShift = kData;
+        }
+        this->accommodate (kData, mData, mCurrentSize,
+                           mCurrentSize == T_Dim ? mIdx : mCurrentSize);
+
+        // Sum the element as stored, so that removing it later cancels
+        // exactly.
+        mData[mIdx] = this->encode (kData);
+        const T_Accum x = this->element (mIdx) - mShift;
+        mSigmaX += x;
+        mSigmaXSqr += x * x;
+        mIdx++;
 
         // Increment size if not yet at capacity.
         if (mCurrentSize < T_Dim)
@@ -129,10 +406,11 @@ public:
         }
 
         // Wrap index around to start of history to replace oldest value on
-        // next add call.
+        // next add call, and discard the running sums' accumulated rounding.
         if (mIdx >= T_Dim)
         {
             mIdx = 0;
+            this->computeSums ();
         }
 
         // Invalidate last stat computations.
@@ -144,7 +422,7 @@ public:
      *
      * @ret     History mean.
      */
-    Real_t getMean ()
+    T_Accum getMean ()
     {
         if (mDirty)
         {
@@ -159,7 +437,7 @@ public:
      *
      * @ret     History standard deviation.
      */
-    Real_t getStdev ()
+    T_Accum getStdev ()
     {
         if (mDirty)
         {
@@ -179,6 +457,17 @@ public:
         return (mCurrentSize == T_Dim);
     }
 
+    /**
+     * Gets the number of elements that saturated when stored. Always 0 with
+     * the default storage policy. See note (5).
+     *
+     * @ret     Number of saturated elements.
+     */
+    uint32_t getSaturations () const
+    {
+        return T_Storage::getSaturations ();
+    }
+
     /**
      * Clears all elements from the history.
      */
@@ -186,6 +475,10 @@ public:
     {
         mIdx = 0;
         mCurrentSize = 0;
+        mSigmaX = 0;
+        mSigmaXSqr = 0;
+        mMean = 0;
+        mStdev = 0;
         mDirty = true;
     }
 };
@@ -110,32 +110,65 @@
  *       on liftoff, temporarily causing very low altitude readings. This can be
  *       fixed with simple sanity checks on the observations being passed to
  *       the filter, e.g. floor altitude observations at the launchpad altitude.
+ *
+ *   (4) KalmanFilter is the filter over Real_t. BasicKalmanFilter can be
+ *       instantiated over another scalar type, e.g. BasicKalmanFilter<double>
+ *       to run the gain computation in double precision on a host.
  */
 
 #ifndef PHOTIC_KALMAN_FILTER_HPP
 #define PHOTIC_KALMAN_FILTER_HPP
 
+#include "MathUtils.hpp"
 #include "Matrix.hpp"
+#include "MatrixFactorization.hpp"
+#include "StructuredMatrix.hpp"
+#include "SymmetricMatrix.hpp"
 #include "Types.hpp"
 
 namespace Photic
 {
 
-class KalmanFilter final
+template <typename T_Scalar>
+class BasicKalmanFilter final
 {
 public:
     /**
      * Filter is uninitialized and filled with garbage. See usage instructions
      * above.
      */
-    KalmanFilter ();
+    BasicKalmanFilter ()
+    {
+        // State transition matrix is initially the identity, and the state ->
+        // observation map is entirely structural. Both are set on
+        // construction. The time-variant elements which do the transition are
+        // set in setDeltaT.
+
+        // Process noise covariance is always 0. This is currently unused.
+        mQ = SymmetricMatrix<3, T_Scalar>::zero ();
+
+        // Measurement noise covariance is initially 0. The elements on its
+        // diagonal are set in setSensorVariance. This actually makes it a
+        // variance matrix (observations of different state variables are not
+        // expected to co-vary).
+        mR = SymmetricMatrix<2, T_Scalar>::zero ();
+
+        // Error covariance is initially the identity. This is computed
+        // side-by-side with the Kalman gain in computeKg.
+        mP = SymmetricMatrix<3, T_Scalar>::identity ();
+    }
 
     /**
      * Sets the timestep size for filter iterations.
      *
      * @param   kDt Timestep size.
      */
-    void setDeltaT (const Real_t kDt);
+    void setDeltaT (const T_Scalar kDt)
+    {
+        mA (0, 1) = kDt;
+        mA (0, 2) = 0.5 * kDt * kDt;
+        mA (1, 2) = kDt;
+    }
 
     /**
      * Sets the variance in altitude and acceleration readings.
@@ -143,7 +176,11 @@ public:
      * @param   kAltVar   Altitude reading variance.
      * @param   kAccelVar Acceleration reading variance.
      */
-    void setSensorVariance (const Real_t kAltVar, const Real_t kAccelVar);
+    void setSensorVariance (const T_Scalar kAltVar, const T_Scalar kAccelVar)
+    {
+        mR (0, 0) = kAltVar;
+        mR (1, 1) = kAccelVar;
+    }
 
     /**
      * Sets the rocket's initial state.
@@ -152,15 +189,25 @@ public:
      * @param   kVel   Initial velocity.
      * @param   kAccel Initial acceleration.
      */
-    void setInitialState (const Real_t kAlt, const Real_t kVel,
-                          const Real_t kAccel);
+    void setInitialState (const T_Scalar kAlt, const T_Scalar kVel,
+                          const T_Scalar kAccel)
+    {
+        mE = MathUtils::makeVector3<T_Scalar> (kAlt, kVel, kAccel);
+    }
 
     /**
      * Computes the Kalman gain.
      *
      * @param   kIterations Number of iterations in calculation.
      */
-    void computeKg (const uint32_t kIterations);
+    void computeKg (const uint32_t kIterations)
+    {
+        mP = SymmetricMatrix<3, T_Scalar>::identity ();
+        for (uint32_t i = 0; i < kIterations; i++)
+        {
+            this->computeKg ();
+        }
+    }
 
     /**
      * Advances the filter and returns a new state estimate.
@@ -173,24 +220,87 @@ public:
      *
      * @ret     Estimated state <altitude, velocity, acceleration>.
      */
-    Vector3_t filter (const Real_t kAlt, const Real_t kAccel);
+    Matrix<3, 1, T_Scalar> filter (const T_Scalar kAlt, const T_Scalar kAccel)
+    {
+        // Predict the new state.
+        Matrix<3, 1, T_Scalar> estNew;
+        multiplyInto (estNew, mA, mE);
+
+        // Compute the innovation, i.e. observation minus predicted
+        // observation.
+        Matrix<2, 1, T_Scalar> innovation =
+            MathUtils::makeVector2<T_Scalar> (kAlt, kAccel);
+        multiplySubtractInto (innovation, mH, estNew);
+
+        // Correct the prediction by the weighted innovation.
+        multiplyInto (mE, mK, innovation);
+        mE += estNew;
+
+        return mE;
+    }
 
 private:
-    Matrix<3, 3> mA; /* State transition matrix. */
-    Matrix<3, 3> mQ; /* Process noise covariance. Unused currently. */
-    Matrix<2, 3> mH; /* Mapping of state to observations. */
-    Matrix<2, 2> mR; /* Measurement noise covariance. */
-    Matrix<3, 3> mP; /* Error covariance. */
-    Matrix<3, 2> mK; /* Kalman gain. */
-    Matrix<3, 1> mE; /* Last computed state estimate. */
+    /**
+     * State transition matrix is unit upper triangular. Only the time-variant
+     * elements above the diagonal are stored in practice.
+     */
+    typedef StructuredMatrix<3, 3, matrixPatternUpper (3, 3),
+                             matrixPatternDiagonal (3, 3), T_Scalar>
+        Transition_t;
+
+    /**
+     * State -> observation map selects altitude and acceleration:
+     * [1 0 0
+     *  0 0 1]
+     */
+    static constexpr uint64_t observationPattern =
+        matrixPatternBit (0, 0, 3) | matrixPatternBit (1, 2, 3);
+    typedef StructuredMatrix<2, 3, observationPattern, observationPattern,
+                             T_Scalar> Observation_t;
+
+    Transition_t mA;                 /* State transition matrix. */
+    SymmetricMatrix<3, T_Scalar> mQ; /* Process noise covariance. Unused. */
+    Observation_t mH;                /* Mapping of state to observations. */
+    SymmetricMatrix<2, T_Scalar> mR; /* Measurement noise covariance. */
+    SymmetricMatrix<3, T_Scalar> mP; /* Error covariance. */
+    Matrix<3, 2, T_Scalar> mK;       /* Kalman gain. */
+    Matrix<3, 1, T_Scalar> mE;       /* Last computed state estimate. */
 
     /**
      * Performs a single refinement on the current Kalman gain based on the
      * current error covariance. Called iteratively by computeKg (uint32_t).
      */
-    void computeKg ();
+    void computeKg ()
+    {
+        // K = P H^T S^-1 with S = H P H^T + R, computed without inverting S
+        // by solving K S = P H^T. P H^T is shared by both sides, and H P H^T
+        // is computed as H (P H^T).
+        Matrix<3, 2, T_Scalar> pht;
+        multiplyTransposedInto (pht, mP, mH);
+        SymmetricMatrix<2, T_Scalar> x;
+        multiplyInto (x, mH, pht);
+        x += mR;
+        Matrix<2, 2, T_Scalar> s = x;
+        ldltDecompose (s);
+        mK = pht;
+        ldltSolveRight (s, mK);
+
+        // P = (I - K H) P, expanded to P - K (H P) to skip the identity. H P
+        // is (P H^T)^T since P is symmetric, and K (H P) is symmetric since K
+        // is (P H^T) S^-1 with S symmetric.
+        multiplyTransposedSubtractInto (mP, mK, pht);
+
+        // P = A P A^T + Q.
+        propagateInto (mP, mA, mP);
+        mP += mQ;
+    }
 };
 
+/**
+ * Filter over the default scalar type. See usage instructions above.
+ */
+typedef BasicKalmanFilter<Real_t> KalmanFilter;
+
 } // namespace Photic
 
-#endif
\ No newline at end of file
+#endif
@@ -8,12 +8,17 @@
  *
  *                            ---- THIS FILE ----
  *
- * Math utilities used across Photic.
+ * Math utilities used across Photic. Every utility is generic over the matrix
+ * element type. Rotations of whole buffers of vectors, stored as structures of
+ * arrays, are vectorized for float on host builds. Approximations that trade a
+ * bounded error for speed are in MathUtils::Fast.
  */
 
 #ifndef PHOTIC_MATH_UTILS_HPP
 #define PHOTIC_MATH_UTILS_HPP
 
+#include <math.h>
+
 #include "Matrix.hpp"
 
 namespace Photic
@@ -21,6 +26,17 @@ namespace Photic
 
 namespace MathUtils
 {
+    /**
+     * Prevents deduction of a template parameter from a function argument, so
+     * that the make* functions below default to Real_t elements regardless of
+     * the argument types, e.g. makeVector2 (1, 2) is a Matrix<2, 1, Real_t>.
+     */
+    template <typename T_Type>
+    struct NonDeduced
+    {
+        typedef T_Type Type;
+    };
+
     /**
      * Makes a 2x2 matrix.
      *
@@ -28,10 +44,14 @@ namespace MathUtils
      *
      * @ret     Constructed matrix.
      */
-    inline Matrix<2, 2> makeMatrix2 (const Real_t e00, const Real_t e01,
-                                     const Real_t e10, const Real_t e11)
+    template <typename T_Scalar = Real_t>
+    inline Matrix<2, 2, T_Scalar> makeMatrix2 (
+        const typename NonDeduced<T_Scalar>::Type e00,
+        const typename NonDeduced<T_Scalar>::Type e01,
+        const typename NonDeduced<T_Scalar>::Type e10,
+        const typename NonDeduced<T_Scalar>::Type e11)
     {
-        Matrix<2, 2> mat;
+        Matrix<2, 2, T_Scalar> mat;
 
         mat.mData[0] = e00; mat.mData[1] = e01;
         mat.mData[2] = e10; mat.mData[3] = e11;
@@ -46,11 +66,19 @@ namespace MathUtils
      *
      * @ret     Constructed matrix.
      */
-    inline Matrix<3, 3> makeMatrix3 (const Real_t e00, const Real_t e01, const Real_t e02,
-                                     const Real_t e10, const Real_t e11, const Real_t e12,
-                                     const Real_t e20, const Real_t e21, const Real_t e22)
+    template <typename T_Scalar = Real_t>
+    inline Matrix<3, 3, T_Scalar> makeMatrix3 (
+        const typename NonDeduced<T_Scalar>::Type e00,
+        const typename NonDeduced<T_Scalar>::Type e01,
+        const typename NonDeduced<T_Scalar>::Type e02,
+        const typename NonDeduced<T_Scalar>::Type e10,
+        const typename NonDeduced<T_Scalar>::Type e11,
+        const typename NonDeduced<T_Scalar>::Type e12,
+        const typename NonDeduced<T_Scalar>::Type e20,
+        const typename NonDeduced<T_Scalar>::Type e21,
+        const typename NonDeduced<T_Scalar>::Type e22)
     {
-        Matrix<3, 3> mat;
+        Matrix<3, 3, T_Scalar> mat;
 
         mat.mData[0] = e00; mat.mData[1] = e01; mat.mData[2] = e02;
         mat.mData[3] = e10; mat.mData[4] = e11; mat.mData[5] = e12;
@@ -67,9 +95,12 @@ namespace MathUtils
      *
      * @ret     2-vector (x, y).
      */
-    inline Matrix<2, 1> makeVector2 (const Real_t x, const Real_t y)
+    template <typename T_Scalar = Real_t>
+    inline Matrix<2, 1, T_Scalar> makeVector2 (
+        const typename NonDeduced<T_Scalar>::Type x,
+        const typename NonDeduced<T_Scalar>::Type y)
     {
-        Matrix<2, 1> mat;
+        Matrix<2, 1, T_Scalar> mat;
 
         mat.mData[0] = x;
         mat.mData[1] = y;
@@ -86,10 +117,13 @@ namespace MathUtils
      *
      * @ret     3-vector (x, y, z).
      */
-    inline Matrix<3, 1> makeVector3 (const Real_t x, const Real_t y,
-                                     const Real_t z)
+    template <typename T_Scalar = Real_t>
+    inline Matrix<3, 1, T_Scalar> makeVector3 (
+        const typename NonDeduced<T_Scalar>::Type x,
+        const typename NonDeduced<T_Scalar>::Type y,
+        const typename NonDeduced<T_Scalar>::Type z)
     {
-        Matrix<3, 1> mat;
+        Matrix<3, 1, T_Scalar> mat;
 
         mat.mData[0] = x;
         mat.mData[1] = y;
@@ -108,10 +142,14 @@ namespace MathUtils
      *
      * @ret     4-vector (w, x, y, z).
      */
-    inline Matrix<4, 1> makeVector4 (const Real_t w, const Real_t x,
-                                     const Real_t y, const Real_t z)
+    template <typename T_Scalar = Real_t>
+    inline Matrix<4, 1, T_Scalar> makeVector4 (
+        const typename NonDeduced<T_Scalar>::Type w,
+        const typename NonDeduced<T_Scalar>::Type x,
+        const typename NonDeduced<T_Scalar>::Type y,
+        const typename NonDeduced<T_Scalar>::Type z)
     {
-        Matrix<4, 1> mat;
+        Matrix<4, 1, T_Scalar> mat;
 
         mat.mData[0] = w;
         mat.mData[1] = x;
@@ -124,16 +162,39 @@ namespace MathUtils
     /**
      * Inverts a 2x2 matrix.
      *
-     * @param   kMat Matrix to invert.
+     * @param   kMat Matrix to invert. May be any 2x2 expression, e.g. a
+     *               SymmetricMatrix.
      *
      * @ret     Inverted matrix.
      */
-    inline Matrix<2, 2> invertMatrix2 (const Matrix<2, 2>& kMat)
+    template <typename T_Expr, typename T_Scalar>
+    inline Matrix<2, 2, T_Scalar> invertMatrix2 (
+        const MatrixExpression<T_Expr, 2, 2, T_Scalar>& kMat)
+    {
+        T_Scalar determinant = kMat (0, 0) * kMat (1, 1) -
+                               kMat (0, 1) * kMat (1, 0);
+        return makeMatrix2<T_Scalar> (
+             kMat (1, 1) / determinant, -kMat (0, 1) / determinant,
+            -kMat (1, 0) / determinant,  kMat (0, 0) / determinant);
+    }
+
+    /**
+     * Computes the cross product of two 3-vectors into a destination vector.
+     *
+     * WARNING: The destination must not be either operand.
+     *
+     * @param   kDst Destination vector.
+     * @param   kLhs LHS vector. May be any 3-vector expression, e.g. a view.
+     * @param   kRhs RHS vector.
+     */
+    template <typename T_Lhs, typename T_Rhs, typename T_Scalar>
+    inline void crossInto (Matrix<3, 1, T_Scalar>& kDst,
+                           const MatrixExpression<T_Lhs, 3, 1, T_Scalar>& kLhs,
+                           const MatrixExpression<T_Rhs, 3, 1, T_Scalar>& kRhs)
     {
-        Real_t determinant = kMat (0, 0) * kMat (1, 1) -
-                             kMat (0, 1) * kMat (1, 0);
-        return makeMatrix2 ( kMat (1, 1) / determinant, -kMat (0, 1) / determinant,
-                            -kMat (1, 0) / determinant,  kMat (0, 0) / determinant);
+        kDst[0] = kLhs (1, 0) * kRhs (2, 0) - kLhs (2, 0) * kRhs (1, 0);
+        kDst[1] = kLhs (2, 0) * kRhs (0, 0) - kLhs (0, 0) * kRhs (2, 0);
+        kDst[2] = kLhs (0, 0) * kRhs (1, 0) - kLhs (1, 0) * kRhs (0, 0);
     }
 
     /**
@@ -144,11 +205,41 @@ namespace MathUtils
      *
      * @ret     LHS cross RHS.
      */
-    inline Vector3_t cross (const Vector3_t& kLhs, const Vector3_t& kRhs)
+    template <typename T_Lhs, typename T_Rhs, typename T_Scalar>
+    inline Matrix<3, 1, T_Scalar> cross (
+        const MatrixExpression<T_Lhs, 3, 1, T_Scalar>& kLhs,
+        const MatrixExpression<T_Rhs, 3, 1, T_Scalar>& kRhs)
+    {
+        Matrix<3, 1, T_Scalar> vec;
+        crossInto (vec, kLhs, kRhs);
+        return vec;
+    }
+
+    /**
+     * Rotates a 3-vector by a quaternion into a destination vector.
+     *
+     * WARNING: Quaternion must be normalized for a correct answer.
+     *
+     * WARNING: The destination must not be the vector being rotated.
+     *
+     * @param   kDst  Destination vector.
+     * @param   kQuat Quaternion ordered <w, x, y, z>.
+     * @param   kVec  Vector to rotate. May be any 3-vector expression, e.g. a
+     *                view of an IMU reading.
+     */
+    template <typename T_Quat, typename T_Vec, typename T_Scalar>
+    inline void rotateVectorInto (
+        Matrix<3, 1, T_Scalar>& kDst,
+        const MatrixExpression<T_Quat, 4, 1, T_Scalar>& kQuat,
+        const MatrixExpression<T_Vec, 3, 1, T_Scalar>& kVec)
     {
-        return makeVector3 (kLhs[1] * kRhs[2] - kLhs[2] * kRhs[1],
-                            kLhs[2] * kRhs[0] - kLhs[0] * kRhs[2],
-                            kLhs[0] * kRhs[1] - kLhs[1] * kRhs[0]);
+        Matrix<3, 1, T_Scalar> q =
+            makeVector3<T_Scalar> (kQuat (1, 0), kQuat (2, 0), kQuat (3, 0));
+        Matrix<3, 1, T_Scalar> t;
+        crossInto (t, q, kVec);
+        t *= 2;
+        crossInto (kDst, q, t);
+        kDst = kVec + t * kQuat (0, 0) + kDst;
     }
 
     /**
@@ -161,14 +252,598 @@ namespace MathUtils
      *
      * @ret     Rotated vector.
      */
-    inline Vector3_t rotateVector (const Vector4_t& kQuat,
-                                   const Vector3_t& kVec)
+    template <typename T_Quat, typename T_Vec, typename T_Scalar>
+    inline Matrix<3, 1, T_Scalar> rotateVector (
+        const MatrixExpression<T_Quat, 4, 1, T_Scalar>& kQuat,
+        const MatrixExpression<T_Vec, 3, 1, T_Scalar>& kVec)
+    {
+        Matrix<3, 1, T_Scalar> vec;
+        rotateVectorInto (vec, kQuat, kVec);
+        return vec;
+    }
+
+    /**
+     * Type each rotation kernel operates on: a scalar, or a packet holding the
+     * same component of 4 consecutive float samples.
+     *
+     * PUBLIC FOR USE BY UTILITIES ONLY -- DO NOT USE OUTSIDE THIS FILE
+     */
+    template <typename T_Scalar, bool T_Packet>
+    struct RotationValue
+    {
+        typedef T_Scalar Type;
+    };
+
+#ifdef PHOTIC_SIMD
+    template <>
+    struct RotationValue<float, true>
+    {
+        typedef MatrixSimd::Packet_t Type;
+    };
+#endif
+
+    /**
+     * Rotation of one sample, or one packet of samples, by a quaternion,
+     * shared by the single-axis and batch rotations below.
+     *
+     * Performs the same operations in the same order as rotateVectorInto, so
+     * every rotation path gives bit-for-bit identical results.
+     *
+     * PUBLIC FOR USE BY UTILITIES ONLY -- DO NOT USE OUTSIDE THIS FILE
+     */
+    template <typename T_Scalar, bool T_Packet = false>
+    struct RotationKernel
+    {
+        typedef typename RotationValue<T_Scalar, T_Packet>::Type Value_t;
+
+        /**
+         * Computes t = 2 (q x v), where q is the quaternion's vector part.
+         *
+         * @param   kQuat Quaternion components <w, x, y, z>.
+         * @param   kVec  Vector components.
+         */
+        RotationKernel (const Value_t (&kQuat)[4], const Value_t (&kVec)[3])
+        {
+            for (Dim_t i = 0; i < 4; i++)
+            {
+                mQuat[i] = kQuat[i];
+            }
+            for (Dim_t i = 0; i < 3; i++)
+            {
+                mVec[i] = kVec[i];
+            }
+            for (Dim_t a = 0; a < 3; a++)
+            {
+                const Dim_t b = (a + 1) % 3;
+                const Dim_t c = (a + 2) % 3;
+                const Value_t t = ExpressionSubtractOp::apply (
+                    ExpressionMultiplyOp::apply (mQuat[b + 1], mVec[c]),
+                    ExpressionMultiplyOp::apply (mQuat[c + 1], mVec[b]));
+                mT[a] = ExpressionAddOp::apply (t, t);
+            }
+        }
+
+        /**
+         * Computes one component of the rotated vector, v + w t + q x t.
+         *
+         * @param   kAxis Component index, 0 to 2.
+         *
+         * @ret     Rotated component.
+         */
+        Value_t component (const Dim_t kAxis) const
+        {
+            const Dim_t b = (kAxis + 1) % 3;
+            const Dim_t c = (kAxis + 2) % 3;
+            const Value_t qxt = ExpressionSubtractOp::apply (
+                ExpressionMultiplyOp::apply (mQuat[b + 1], mT[c]),
+                ExpressionMultiplyOp::apply (mQuat[c + 1], mT[b]));
+            return ExpressionAddOp::apply (
+                ExpressionAddOp::apply (
+                    mVec[kAxis],
+                    ExpressionMultiplyOp::apply (mT[kAxis], mQuat[0])),
+                qxt);
+        }
+
+        Value_t mQuat[4];
+        Value_t mVec[3];
+        Value_t mT[3];
+    };
+
+    /**
+     * Computes one component of a 3-vector rotated by a quaternion, at about
+     * half the cost of rotating the whole vector.
+     *
+     * WARNING: Quaternion must be normalized for a correct answer.
+     *
+     * @param   kQuat Quaternion ordered <w, x, y, z>.
+     * @param   kVec  Vector to rotate.
+     * @param   kAxis Index of the component to compute, 0 to 2.
+     *
+     * @ret     kAxis component of the rotated vector.
+     */
+    template <typename T_Quat, typename T_Vec, typename T_Scalar>
+    inline T_Scalar rotateVectorComponent (
+        const MatrixExpression<T_Quat, 4, 1, T_Scalar>& kQuat,
+        const MatrixExpression<T_Vec, 3, 1, T_Scalar>& kVec,
+        const Dim_t kAxis)
+    {
+        const T_Scalar quat[4] = {kQuat (0, 0), kQuat (1, 0), kQuat (2, 0),
+                                  kQuat (3, 0)};
+        const T_Scalar vec[3] = {kVec (0, 0), kVec (1, 0), kVec (2, 0)};
+        return RotationKernel<T_Scalar> (quat, vec).component (kAxis);
+    }
+
+    /**
+     * Loads sample kIdx of a structure-of-arrays batch into a rotation kernel.
+     *
+     * PUBLIC FOR USE BY UTILITIES ONLY -- DO NOT USE OUTSIDE THIS FILE
+     */
+    template <typename T_Scalar>
+    inline RotationKernel<T_Scalar> loadRotationSample (
+        const T_Scalar* const (&kQuat)[4], const T_Scalar* const (&kVec)[3],
+        const uint32_t kIdx)
+    {
+        const T_Scalar quat[4] = {kQuat[0][kIdx], kQuat[1][kIdx],
+                                  kQuat[2][kIdx], kQuat[3][kIdx]};
+        const T_Scalar vec[3] = {kVec[0][kIdx], kVec[1][kIdx], kVec[2][kIdx]};
+        return RotationKernel<T_Scalar> (quat, vec);
+    }
+
+    /**
+     * Rotates samples [kBegin, kEnd) of a batch one at a time. See
+     * rotateVectorBatch.
+     *
+     * PUBLIC FOR USE BY UTILITIES ONLY -- DO NOT USE OUTSIDE THIS FILE
+     */
+    template <typename T_Scalar>
+    inline void rotateVectorBatchScalar (const T_Scalar* const (&kQuat)[4],
+                                         const T_Scalar* const (&kVec)[3],
+                                         T_Scalar* const (&kDst)[3],
+                                         const uint32_t kBegin,
+                                         const uint32_t kEnd)
+    {
+        for (uint32_t i = kBegin; i < kEnd; i++)
+        {
+            const RotationKernel<T_Scalar> kernel =
+                loadRotationSample (kQuat, kVec, i);
+            kDst[0][i] = kernel.component (0);
+            kDst[1][i] = kernel.component (1);
+            kDst[2][i] = kernel.component (2);
+        }
+    }
+
+    /**
+     * Rotates samples [kBegin, kEnd) of a batch one at a time, computing one
+     * component. See rotateVectorComponentBatch.
+     *
+     * PUBLIC FOR USE BY UTILITIES ONLY -- DO NOT USE OUTSIDE THIS FILE
+     */
+    template <typename T_Scalar>
+    inline void rotateVectorComponentBatchScalar (
+        const T_Scalar* const (&kQuat)[4], const T_Scalar* const (&kVec)[3],
+        const Dim_t kAxis, T_Scalar* const kDst, const uint32_t kBegin,
+        const uint32_t kEnd)
+    {
+        for (uint32_t i = kBegin; i < kEnd; i++)
+        {
+            kDst[i] = loadRotationSample (kQuat, kVec, i).component (kAxis);
+        }
+    }
+
+    /**
+     * Rotates a batch of 3-vectors, each by its own quaternion, e.g. to move
+     * a buffer of accelerometer samples into the world frame. The batch is
+     * stored as a structure of arrays, one array per component.
+     *
+     * WARNING: Quaternions must be normalized for a correct answer.
+     *
+     * @param   kQuat  Arrays of the quaternion w, x, y and z components.
+     * @param   kVec   Arrays of the vector x, y and z components.
+     * @param   kDst   Arrays to store the rotated x, y and z components in.
+     *                 May be the arrays in kVec to rotate in place.
+     * @param   kCount Number of samples.
+     */
+    template <typename T_Scalar>
+    inline void rotateVectorBatch (const T_Scalar* const (&kQuat)[4],
+                                   const T_Scalar* const (&kVec)[3],
+                                   T_Scalar* const (&kDst)[3],
+                                   const uint32_t kCount)
+    {
+        rotateVectorBatchScalar (kQuat, kVec, kDst, 0, kCount);
+    }
+
+    /**
+     * Rotates a batch of 3-vectors, each by its own quaternion, computing only
+     * one component of each rotated vector, e.g. vertical acceleration.
+     *
+     * WARNING: Quaternions must be normalized for a correct answer.
+     *
+     * @param   kQuat  Arrays of the quaternion w, x, y and z components.
+     * @param   kVec   Arrays of the vector x, y and z components.
+     * @param   kAxis  Index of the component to compute, 0 to 2.
+     * @param   kDst   Array to store the rotated components in. May be one of
+     *                 the arrays in kVec.
+     * @param   kCount Number of samples.
+     */
+    template <typename T_Scalar>
+    inline void rotateVectorComponentBatch (const T_Scalar* const (&kQuat)[4],
+                                            const T_Scalar* const (&kVec)[3],
+                                            const Dim_t kAxis,
+                                            T_Scalar* const kDst,
+                                            const uint32_t kCount)
+    {
+        rotateVectorComponentBatchScalar (kQuat, kVec, kAxis, kDst, 0, kCount);
+    }
+
+#ifdef PHOTIC_SIMD
+    /**
+     * Loads samples [kIdx, kIdx + 4) of a float batch into a rotation kernel.
+     *
+     * PUBLIC FOR USE BY UTILITIES ONLY -- DO NOT USE OUTSIDE THIS FILE
+     */
+    inline RotationKernel<float, true> loadRotationPacket (
+        const float* const (&kQuat)[4], const float* const (&kVec)[3],
+        const uint32_t kIdx)
+    {
+        const MatrixSimd::Packet_t quat[4] = {
+            MatrixSimd::loadUnaligned (kQuat[0] + kIdx),
+            MatrixSimd::loadUnaligned (kQuat[1] + kIdx),
+            MatrixSimd::loadUnaligned (kQuat[2] + kIdx),
+            MatrixSimd::loadUnaligned (kQuat[3] + kIdx)};
+        const MatrixSimd::Packet_t vec[3] = {
+            MatrixSimd::loadUnaligned (kVec[0] + kIdx),
+            MatrixSimd::loadUnaligned (kVec[1] + kIdx),
+            MatrixSimd::loadUnaligned (kVec[2] + kIdx)};
+        return RotationKernel<float, true> (quat, vec);
+    }
+
+    /**
+     * Vectorized rotateVectorBatch for float batches. Rotates 4 samples at a
+     * time and the remainder one at a time.
+     */
+    inline void rotateVectorBatch (const float* const (&kQuat)[4],
+                                   const float* const (&kVec)[3],
+                                   float* const (&kDst)[3],
+                                   const uint32_t kCount)
     {
-        Vector3_t q = makeVector3 (kQuat[1], kQuat[2], kQuat[3]);
-        Vector3_t t = cross (q, kVec) * 2.0;
-        return kVec + t * kQuat[0] + cross (q, t);
+        const uint32_t packetEnd = kCount - kCount % MatrixSimd::width;
+        for (uint32_t i = 0; i < packetEnd; i += MatrixSimd::width)
+        {
+            const RotationKernel<float, true> kernel =
+                loadRotationPacket (kQuat, kVec, i);
+            MatrixSimd::storeUnaligned (kDst[0] + i, kernel.component (0));
+            MatrixSimd::storeUnaligned (kDst[1] + i, kernel.component (1));
+            MatrixSimd::storeUnaligned (kDst[2] + i, kernel.component (2));
+        }
+        rotateVectorBatchScalar (kQuat, kVec, kDst, packetEnd, kCount);
     }
 
+    /**
+     * Vectorized rotateVectorComponentBatch for float batches.
+     */
+    inline void rotateVectorComponentBatch (const float* const (&kQuat)[4],
+                                            const float* const (&kVec)[3],
+                                            const Dim_t kAxis,
+                                            float* const kDst,
+                                            const uint32_t kCount)
+    {
+        const uint32_t packetEnd = kCount - kCount % MatrixSimd::width;
+        for (uint32_t i = 0; i < packetEnd; i += MatrixSimd::width)
+        {
+            MatrixSimd::storeUnaligned (
+                kDst + i,
+                loadRotationPacket (kQuat, kVec, i).component (kAxis));
+        }
+        rotateVectorComponentBatchScalar (kQuat, kVec, kAxis, kDst, packetEnd,
+                                          kCount);
+    }
+#endif
+
+    /**
+     * Fast approximations of math functions, for code that can tolerate a
+     * small bounded error. Each documents its maximum error.
+     */
+    namespace Fast
+    {
+        /**
+         * Gets the bits of a float. __builtin_memcpy is used since Arduino
+         * does not have string.h.
+         *
+         * @param   kX Value.
+         *
+         * @ret     IEEE 754 bits of kX.
+         */
+        inline uint32_t toBits (const float kX)
+        {
+            uint32_t bits;
+            __builtin_memcpy (&bits, &kX, sizeof (bits));
+            return bits;
+        }
+
+        /**
+         * Gets the float with the given bits.
+         *
+         * @param   kBits IEEE 754 bits.
+         *
+         * @ret     Value.
+         */
+        inline float fromBits (const uint32_t kBits)
+        {
+            float x;
+            __builtin_memcpy (&x, &kBits, sizeof (x));
+            return x;
+        }
+
+        /**
+         * Computes 1 / sqrt (x). Element types other than float fall back to
+         * the exact computation.
+         *
+         * @param   kX Positive value.
+         *
+         * @ret     Inverse square root of kX.
+         */
+        template <typename T_Scalar>
+        inline T_Scalar invSqrt (const T_Scalar kX)
+        {
+            using ::sqrt;
+            return (T_Scalar) 1 / sqrt (kX);
+        }
+
+        /**
+         * Computes 1 / sqrt (x) for a float with an integer estimate refined
+         * by two Newton-Raphson iterations. Relative error is below 5e-6 for
+         * any positive normal kX.
+         *
+         * @param   kX Positive value.
+         *
+         * @ret     Inverse square root of kX.
+         */
+        inline float invSqrt (const float kX)
+        {
+            float y = fromBits (0x5f375a86 - (toBits (kX) >> 1));
+
+            const float halfX = 0.5f * kX;
+            y *= 1.5f - halfX * y * y;
+            y *= 1.5f - halfX * y * y;
+            return y;
+        }
+
+        /**
+         * Computes sqrt (x). Element types other than float fall back to the
+         * exact computation.
+         *
+         * @param   kX Non-negative value.
+         *
+         * @ret     Square root of kX.
+         */
+        template <typename T_Scalar>
+        inline T_Scalar sqrt (const T_Scalar kX)
+        {
+            using ::sqrt;
+            return sqrt (kX);
+        }
+
+        /**
+         * Computes sqrt (x) for a float as x / sqrt (x), using invSqrt.
+         * Relative error is below 5e-6 for zero or any positive normal kX.
+         *
+         * @param   kX Non-negative value.
+         *
+         * @ret     Square root of kX.
+         */
+        inline float sqrt (const float kX)
+        {
+            return kX * invSqrt (kX);
+        }
+
+        /**
+         * Computes atan2 (y, x). Element types other than float fall back to
+         * the exact computation.
+         *
+         * @param   kY Y coordinate.
+         * @param   kX X coordinate.
+         *
+         * @ret     Angle of (kX, kY) from the positive x axis in [-pi, pi].
+         */
+        template <typename T_Scalar>
+        inline T_Scalar atan2 (const T_Scalar kY, const T_Scalar kX)
+        {
+            using ::atan2;
+            return atan2 (kY, kX);
+        }
+
+        /**
+         * Computes atan2 (y, x) for floats. The octant is reduced so that a
+         * 9th order odd polynomial (Abramowitz and Stegun 4.4.49) only needs
+         * to cover atan over [0, 1]. Absolute error is below 1.5e-5 rad.
+         *
+         * @param   kY Y coordinate.
+         * @param   kX X coordinate.
+         *
+         * @ret     Angle of (kX, kY) from the positive x axis in [-pi, pi],
+         *          or 0 at the origin.
+         */
+        inline float atan2 (const float kY, const float kX)
+        {
+            const float absY = kY < 0 ? -kY : kY;
+            const float absX = kX < 0 ? -kX : kX;
+            if (absY == 0 && absX == 0)
+            {
+                return 0;
+            }
+
+            const bool steep = absY > absX;
+            const float r = steep ? absX / absY : absY / absX;
+            const float r2 = r * r;
+            float angle = r * (0.9998660f + r2 * (-0.3302995f + r2 *
+                          (0.1801410f + r2 * (-0.0851330f + r2 * 0.0208351f))));
+
+            angle = steep ? (float) M_PI_2 - angle : angle;
+            angle = kX < 0 ? (float) M_PI - angle : angle;
+            return kY < 0 ? -angle : angle;
+        }
+
+        /**
+         * Computes asin (x). Element types other than float fall back to the
+         * exact computation.
+         *
+         * @param   kX Value in [-1, 1].
+         *
+         * @ret     Arcsine of kX.
+         */
+        template <typename T_Scalar>
+        inline T_Scalar asin (const T_Scalar kX)
+        {
+            using ::asin;
+            return asin (kX);
+        }
+
+        /**
+         * Computes asin (x) for a float as pi/2 - sqrt (1 - x) p (x), with
+         * p a 7th order polynomial (Abramowitz and Stegun 4.4.46) and the
+         * square root from Fast::sqrt. Absolute error is below 1e-5 rad.
+         *
+         * @param   kX Value in [-1, 1]. Values outside are clamped.
+         *
+         * @ret     Arcsine of kX.
+         */
+        inline float asin (const float kX)
+        {
+            float absX = kX < 0 ? -kX : kX;
+            absX = absX > 1 ? 1 : absX;
+
+            const float poly = 1.5707963050f + absX * (-0.2145988016f +
+                absX * (0.0889789874f + absX * (-0.0501743046f +
+                absX * (0.0308918810f + absX * (-0.0170881256f +
+                absX * (0.0066700901f + absX * -0.0012624911f))))));
+            const float angle = (float) M_PI_2 - sqrt (1 - absX) * poly;
+            return kX < 0 ? -angle : angle;
+        }
+
+        /**
+         * Computes e^x. Element types other than float fall back to the exact
+         * computation.
+         *
+         * @param   kX Exponent.
+         *
+         * @ret     e raised to kX.
+         */
+        template <typename T_Scalar>
+        inline T_Scalar exp (const T_Scalar kX)
+        {
+            using ::exp;
+            return exp (kX);
+        }
+
+        /**
+         * Computes e^x for a float as 2^k e^r, with |r| <= ln (2) / 2. e^r is
+         * a 6th order Taylor polynomial and 2^k is built from its bits.
+         * Relative error is below 1e-6.
+         *
+         * @param   kX Exponent. Values outside [-87, 88] are clamped, so the
+         *             result is always a normal float.
+         *
+         * @ret     e raised to kX.
+         */
+        inline float exp (const float kX)
+        {
+            const float x = kX < -87 ? -87 : (kX > 88 ? 88 : kX);
+
+            // Round x / ln (2) to the nearest integer k. ln (2) is split in
+            // two so that k ln (2) is subtracted without rounding error.
+            const float kf = x * (float) M_LOG2E + (x < 0 ? -0.5f : 0.5f);
+            const int32_t k = (int32_t) kf;
+            const float r = (x - k * 0.693145751953125f) -
+                            k * 1.428606765330187e-6f;
+
+            const float poly = 1 + r * (1 + r * (1.0f / 2 + r * (1.0f / 6 +
+                r * (1.0f / 24 + r * (1.0f / 120 + r * (1.0f / 720))))));
+
+            return poly * fromBits ((uint32_t) (k + 127) << 23);
+        }
+
+        /**
+         * Computes ln (x). Element types other than float fall back to the
+         * exact computation.
+         *
+         * @param   kX Positive value.
+         *
+         * @ret     Natural logarithm of kX.
+         */
+        template <typename T_Scalar>
+        inline T_Scalar log (const T_Scalar kX)
+        {
+            using ::log;
+            return log (kX);
+        }
+
+        /**
+         * Computes ln (x) for a float as e ln (2) + ln (m), with the exponent
+         * e and the mantissa m in [sqrt (2) / 2, sqrt (2)] taken from its
+         * bits. ln (m) is an odd series in s = (m - 1) / (m + 1). Error is
+         * below 2e-7 max (1, |ln (x)|), i.e. within float rounding of the
+         * result.
+         *
+         * @param   kX Positive normal value.
+         *
+         * @ret     Natural logarithm of kX.
+         */
+        inline float log (const float kX)
+        {
+            const uint32_t bits = toBits (kX);
+            int32_t e = (int32_t) ((bits >> 23) & 0xff) - 127;
+            float m = fromBits ((bits & 0x007fffff) | 0x3f800000);
+            if (m > (float) M_SQRT2)
+            {
+                m *= 0.5f;
+                e++;
+            }
+
+            const float s = (m - 1) / (m + 1);
+            const float s2 = s * s;
+            const float lnM = 2 * s * (1 + s2 * (1.0f / 3 + s2 * (1.0f / 5 +
+                s2 * (1.0f / 7 + s2 * (1.0f / 9)))));
+            return e * 0.693145751953125f +
+                   (e * 1.428606765330187e-6f + lnM);
+        }
+
+        /**
+         * Computes x^y. Element types other than float fall back to the exact
+         * computation.
+         *
+         * @param   kBase     Base.
+         * @param   kExponent Exponent.
+         *
+         * @ret     kBase raised to kExponent.
+         */
+        template <typename T_Scalar>
+        inline T_Scalar pow (const T_Scalar kBase, const T_Scalar kExponent)
+        {
+            using ::pow;
+            return pow (kBase, kExponent);
+        }
+
+        /**
+         * Computes x^y for floats as e^(y ln (x)), using Fast::exp and
+         * Fast::log. Relative error is below 2e-6 when |y ln (x)| <= 10, e.g.
+         * for the barometric formula, and grows in proportion beyond that.
+         *
+         * @param   kBase     Non-negative base.
+         * @param   kExponent Exponent.
+         *
+         * @ret     kBase raised to kExponent, or 0 for a base of 0.
+         */
+        inline float pow (const float kBase, const float kExponent)
+        {
+            if (kBase == 0)
+            {
+                return 0;
+            }
+            return exp (kExponent * log (kBase));
+        }
+
+    } // namespace Fast
+
 } // namespace MathUtils
 
 } // namespace Photic
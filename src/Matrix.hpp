@@ -20,6 +20,16 @@
  *       plenty big for most applications.
  *
  *   (3) There is no index bounds checking in the interest of speed.
+ *
+ *   (4) Arithmetic operators (+, -, *, transpose) are lazy and defined in
+ *       MatrixExpression.hpp. Results are computed when assigned to a Matrix.
+ *
+ *   (5) Every kernel loop has a compile-time trip count and is fully unrolled
+ *       for small matrices (see MatrixLoop.hpp).
+ *
+ *   (6) The element type is a template parameter which defaults to Real_t,
+ *       e.g. Matrix<3, 3, double>. Arithmetic requires both operands to have
+ *       the same element type; use cast<T> () to convert between them.
  */
 
 #ifndef PHOTIC_MATRIX_HPP
@@ -29,6 +39,8 @@
     #include <cstring>
 #endif
 
+#include "MatrixExpression.hpp"
+#include "MatrixLoop.hpp"
 #include "Types.hpp"
 
 /**
@@ -50,8 +62,10 @@
 namespace Photic
 {
 
-template <Dim_t T_Rows, Dim_t T_Cols>
-class Matrix final
+template <Dim_t T_Rows, Dim_t T_Cols, typename T_Scalar = Real_t>
+class Matrix final :
+    public MatrixExpression<Matrix<T_Rows, T_Cols, T_Scalar>, T_Rows, T_Cols,
+                            T_Scalar>
 {
 public:
     /**
@@ -59,7 +73,7 @@ public:
      *
      * Matrix elements stored contiguously by row.
      */
-    Real_t mData[ELEM_COUNT];
+    PHOTIC_MATRIX_ALIGN T_Scalar mData[ELEM_COUNT];
 
     /**
      * Default constructor does nothing.
@@ -73,28 +87,80 @@ public:
      *
      * @param   kFill Fill value.
      */
-    Matrix (const Real_t kFill)
+    Matrix (const T_Scalar kFill)
     {
         this->fill (kFill);
     }
 
     /**
-     * Copy constructor.
+     * Copy constructor and assignment. These are trivial so that the compiler
+     * can copy matrices as plain memory and so that constant matrices can be
+     * constexpr.
      *
      * @param   kRhs RHS matrix.
      */
-    Matrix (const Matrix<T_Rows, T_Cols>& kRhs)
+    Matrix (const Matrix<T_Rows, T_Cols, T_Scalar>& kRhs) = default;
+    Matrix<T_Rows, T_Cols, T_Scalar>& operator= (
+        const Matrix<T_Rows, T_Cols, T_Scalar>& kRhs) = default;
+
+    /**
+     * Gets the zero matrix. Usable in constant expressions.
+     *
+     * @ret     Zero matrix.
+     */
+    static constexpr Matrix<T_Rows, T_Cols, T_Scalar> zero ()
     {
-    #ifndef ARDUINO
-        memcpy (mData, kRhs.mData, sizeof (mData));
-    #else
-        // Arduino has no memcpy unfortunately, so we must resort to a manual
-        // copy loop.
-        for (uint32_t i = 0; i < ELEM_COUNT; i++)
+        return Matrix<T_Rows, T_Cols, T_Scalar> (
+            typename MakeMatrixIndexSequence<ELEM_COUNT>::Type (), 0);
+    }
+
+    /**
+     * Gets the identity matrix, i.e. ones on the main diagonal and zeros
+     * elsewhere. Usable in constant expressions.
+     *
+     * @ret     Identity matrix.
+     */
+    static constexpr Matrix<T_Rows, T_Cols, T_Scalar> identity ()
+    {
+        return Matrix<T_Rows, T_Cols, T_Scalar> (
+            typename MakeMatrixIndexSequence<ELEM_COUNT>::Type (), 1);
+    }
+
+    /**
+     * Constructor that evaluates an expression into the matrix.
+     *
+     * @param   kExpr Expression.
+     */
+    template <typename T_Expr>
+    Matrix (const MatrixExpression<T_Expr, T_Rows, T_Cols, T_Scalar>& kExpr)
+    {
+        this->assign (kExpr.derived ());
+    }
+
+    /**
+     * Evaluates an expression into the matrix. If the expression reads this
+     * matrix in a way that would be corrupted by writing it in place, the
+     * expression is evaluated into a temporary first.
+     *
+     * @param   kExpr Expression.
+     *
+     * @ret     This matrix.
+     */
+    template <typename T_Expr>
+    Matrix<T_Rows, T_Cols, T_Scalar>& operator= (
+        const MatrixExpression<T_Expr, T_Rows, T_Cols, T_Scalar>& kExpr)
+    {
+        if (kExpr.derived ().aliases (mData, mData + ELEM_COUNT))
         {
-            mData[i] = kRhs.mData[i];
+            Matrix<T_Rows, T_Cols, T_Scalar> mat (kExpr);
+            *this = mat;
         }
-    #endif
+        else
+        {
+            this->assign (kExpr.derived ());
+        }
+
+        return *this;
     }
 
     /**
@@ -102,12 +168,12 @@ public:
      *
      * @param   kFill Fill value.
      */
-    void fill (const Real_t kFill)
+    void fill (const T_Scalar kFill)
     {
-        for (uint32_t i = 0; i < ELEM_COUNT; i++)
+        MatrixLoop<ELEM_COUNT>::run ([&] (const uint32_t i) PHOTIC_MATRIX_INLINE
         {
             mData[i] = kFill;
-        }
+        });
     }
 
     /**
@@ -118,7 +184,7 @@ public:
      *
      * @ret     Element at (kRow, kCol).
      */
-    Real_t operator() (const Dim_t kRow, const Dim_t kCol) const
+    constexpr T_Scalar operator() (const Dim_t kRow, const Dim_t kCol) const
     {
         return mData[ELEM_IDX (kRow, kCol)];
     }
@@ -131,7 +197,7 @@ public:
      *
      * @ret     Reference to element at (kRow, kCol).
      */
-    Real_t& operator() (const Dim_t kRow, const Dim_t kCol)
+    T_Scalar& operator() (const Dim_t kRow, const Dim_t kCol)
     {
         return mData[ELEM_IDX (kRow, kCol)];
     }
@@ -145,7 +211,7 @@ public:
      *
      * @ret     kIdxth element in vector.
      */
-    Real_t operator[] (const Dim_t kIdx) const
+    constexpr T_Scalar operator[] (const Dim_t kIdx) const
     {
         return mData[kIdx];
     }
@@ -159,102 +225,132 @@ public:
      *
      * @ret     Reference to kIdxth element in vector.
      */
-    Real_t& operator[] (const Dim_t kIdx)
+    T_Scalar& operator[] (const Dim_t kIdx)
     {
         return mData[kIdx];
     }
 
     /**
-     * Computes this matrix plus another. Enables equations like a = b + c.
+     * Adds an expression to this matrix in place. Enables equations like
+     * a += b.
      *
-     * @param   kRhs RHS matrix.
+     * @param   kExpr RHS expression.
      *
-     * @ret     This matrix plus the RHS.
+     * @ret     This matrix.
      */
-    Matrix<T_Rows, T_Cols> operator+ (const Matrix<T_Rows, T_Cols>& kRhs) const
+    template <typename T_Expr>
+    Matrix<T_Rows, T_Cols, T_Scalar>& operator+= (
+        const MatrixExpression<T_Expr, T_Rows, T_Cols, T_Scalar>& kExpr)
     {
-        Matrix<T_Rows, T_Cols> mat = *this;
-
-        for (uint32_t i = 0; i < ELEM_COUNT; i++)
-        {
-            mat.mData[i] += kRhs.mData[i];
-        }
-
-        return mat;
+        return this->update<MatrixAddStoreOp> (kExpr.derived ());
     }
 
     /**
-     * Computes this matrix minus another. Enables equations like a = b - c.
+     * Subtracts an expression from this matrix in place. Enables equations
+     * like a -= b.
      *
-     * @param   kRhs RHS matrix.
+     * @param   kExpr RHS expression.
      *
-     * @ret     This matrix minus the RHS.
+     * @ret     This matrix.
      */
-    Matrix<T_Rows, T_Cols> operator- (const Matrix<T_Rows, T_Cols>& kRhs) const
+    template <typename T_Expr>
+    Matrix<T_Rows, T_Cols, T_Scalar>& operator-= (
+        const MatrixExpression<T_Expr, T_Rows, T_Cols, T_Scalar>& kExpr)
     {
-        Matrix<T_Rows, T_Cols> mat = *this;
-
-        for (uint32_t i = 0; i < ELEM_COUNT; i++)
-        {
-            mat.mData[i] -= kRhs.mData[i];
-        }
-
-        return mat;
+        return this->update<MatrixSubtractStoreOp> (kExpr.derived ());
     }
 
     /**
-     * Computes the product of two matrices. Enables equations like a = b * c.
+     * Multiplies this matrix by a scalar in place.
      *
-     * NOTE: This uses the naive O(n^3) algorithm. The next best algorithm
-     * (Strassen's) only becomes advantageous around n=100 or so. This is
-     * technically within the bounds of Dim_t, but if you're multiplying 100x100
-     * matrices in flight, I'd really like to hear wtf you're doing.
+     * @param   kFactor Scalar factor.
      *
-     * @param   kRhs RHS matrix.
+     * @ret     This matrix.
+     */
+    template <typename T_Factor>
+    typename ExpressionEnableIf<!IsMatrixExpression<T_Factor>::value,
+                                Matrix<T_Rows, T_Cols, T_Scalar>&>::Type
+    operator*= (const T_Factor kFactor)
+    {
+        this->assign (*this * kFactor);
+        return *this;
+    }
+
+    /**
+     * Right-multiplies this matrix by a square expression in place, i.e.
+     * a = a * b. Only a single row of scratch space is used.
+     *
+     * @param   kExpr RHS expression.
      *
-     * @ret     This matrix times the RHS.
+     * @ret     This matrix.
      */
-    template <Dim_t T_RhsCols>
-    Matrix<T_Rows, T_RhsCols> operator* (const Matrix<T_Cols, T_RhsCols>& kRhs) const
+    template <typename T_Expr>
+    Matrix<T_Rows, T_Cols, T_Scalar>& operator*= (
+        const MatrixExpression<T_Expr, T_Cols, T_Cols, T_Scalar>& kExpr)
     {
-        Matrix<T_Rows, T_RhsCols> mat;
+        // The RHS must not change while rows of this matrix are overwritten.
+        if (kExpr.derived ().references (mData, mData + ELEM_COUNT))
+        {
+            const Matrix<T_Cols, T_Cols, T_Scalar> rhs (kExpr);
+            return *this *= rhs;
+        }
+
+        const typename ProductOperand<T_Expr, T_Cols, T_Cols>::Type rhs (
+            kExpr.derived ());
+        T_Scalar row[T_Cols];
 
-        for (Dim_t i = 0; i < T_Rows; i++)
+        MatrixLoop<T_Rows>::run ([&] (const uint32_t i) PHOTIC_MATRIX_INLINE
         {
-            for (Dim_t j = 0; j < T_RhsCols; j++)
+            MatrixLoop<T_Cols>::run ([&] (const uint32_t j) PHOTIC_MATRIX_INLINE
             {
-                Real_t elem = 0;
+                T_Scalar elem = 0;
 
-                for (Dim_t k = 0; k < T_Cols; k++)
+                MatrixLoop<T_Cols>::run ([&] (const uint32_t k) PHOTIC_MATRIX_INLINE
                 {
-                    elem += mData[ELEM_IDX (i, k)] * kRhs (k, j);
-                }
+                    elem += mData[ELEM_IDX (i, k)] * rhs.coeff (k, j);
+                });
 
-                mat (i, j) = elem;
-            }
-        }
+                row[j] = elem;
+            });
+
+            MatrixLoop<T_Cols>::run ([&] (const uint32_t j) PHOTIC_MATRIX_INLINE
+            {
+                mData[ELEM_IDX (i, j)] = row[j];
+            });
+        });
 
-        return mat;
+        return *this;
     }
 
     /**
-     * Computes this matrix times a scalar.
-     *
-     * @param   kScalar Scalar.
-     *
-     * @ret     Scaled matrix.
+     * Expression interface; see MatrixExpression.hpp.
      */
-    template <typename T_Scalar>
-    Matrix<T_Rows, T_Cols> operator* (const T_Scalar kScalar) const
+    static constexpr bool packetAccess =
+        ExpressionIsSame<T_Scalar, float>::value;
+
+#ifdef PHOTIC_SIMD
+    MatrixSimd::Packet_t packet (const uint32_t kIdx) const
+    {
+        return MatrixSimd::load (mData + kIdx);
+    }
+#endif
+
+    constexpr T_Scalar coeff (const Dim_t kRow, const Dim_t kCol) const
     {
-        Matrix<T_Rows, T_Cols> mat = *this;
+        return mData[ELEM_IDX (kRow, kCol)];
+    }
 
-        for (uint32_t i = 0; i < ELEM_COUNT; i++)
-        {
-            mat.mData[i] = (Real_t) (mat.mData[i] * kScalar);
-        }
+    bool references (const void* kPBegin, const void* kPEnd) const
+    {
+        return matrixStorageOverlaps (kPBegin, kPEnd, mData,
+                                      mData + ELEM_COUNT);
+    }
 
-        return mat;
+    bool aliases (const void*, const void*) const
+    {
+        // Each element is read only by the destination element it is
+        // written to.
+        return false;
     }
 
     /**
@@ -265,33 +361,188 @@ public:
      *
      * @ret     If this matrix and the RHS are equal.
      */
-    bool operator== (const Matrix<T_Cols, T_Rows>& kRhs) const
+    bool operator== (const Matrix<T_Rows, T_Cols, T_Scalar>& kRhs) const
     {
         // Types are the same, so can compare element buffers directly.
         return memcmp (mData, kRhs.mData, sizeof (mData)) == 0;
     }
 
+private:
     /**
-     * Gets the transpose of this matrix.
+     * Constant expression constructor used by zero and identity. Elements on
+     * the main diagonal are set to kDiagonal and all others to 0.
      *
-     * @ret     Transpose.
+     * @param   kDiagonal Diagonal value.
      */
-    Matrix<T_Cols, T_Rows> transpose () const
+    template <uint32_t... T_Idxs>
+    constexpr Matrix (MatrixIndexSequence<T_Idxs...>,
+                      const T_Scalar kDiagonal) :
+        mData {(T_Idxs / T_Cols == T_Idxs % T_Cols ? kDiagonal : 0)...} {}
+
+    /**
+     * Evaluates an expression element-by-element into the matrix without any
+     * alias checking.
+     *
+     * @param   kExpr Expression.
+     */
+    template <typename T_Expr>
+    void assign (const T_Expr& kExpr)
     {
-        Matrix<T_Cols, T_Rows> mat;
+        MatrixEvaluator<MatrixStoreOp, T_Expr, T_Rows, T_Cols>::run (mData,
+                                                                     kExpr);
+    }
 
-        for (Dim_t i = 0; i < T_Rows; i++)
+    /**
+     * Combines an expression into the matrix element-by-element with some
+     * store operation, e.g. for +=.
+     *
+     * @param   kExpr Expression.
+     *
+     * @ret     This matrix.
+     */
+    template <typename T_StoreOp, typename T_Expr>
+    Matrix<T_Rows, T_Cols, T_Scalar>& update (const T_Expr& kExpr)
+    {
+        if (kExpr.aliases (mData, mData + ELEM_COUNT))
         {
-            for (Dim_t j = 0; j < T_Cols; j++)
-            {
-                mat (j, i) = mData[ELEM_IDX (i, j)];
-            }
+            const Matrix<T_Rows, T_Cols, T_Scalar> rhs (kExpr);
+            return this->update<T_StoreOp> (rhs);
         }
 
-        return mat;
+        MatrixEvaluator<T_StoreOp, T_Expr, T_Rows, T_Cols>::run (mData, kExpr);
+
+        return *this;
     }
 };
 
+/**
+ * Destination-passing multiplication kernels. These write a product straight
+ * into caller storage rather than returning a new matrix, and can accumulate
+ * into the destination instead of overwriting it. Operands may be any
+ * expression, e.g. a StructuredMatrix whose known zeros are skipped.
+ *
+ * WARNING: The destination must not be either operand.
+ */
+
+/**
+ * Evaluates lhs * rhs, or lhs * rhs^T if T_RhsTransposed, into the destination
+ * with T_StoreOp.
+ *
+ * @param   kDst Destination matrix.
+ * @param   kLhs LHS expression.
+ * @param   kRhs RHS expression, untransposed.
+ */
+template <typename T_StoreOp, typename T_Lhs, typename T_Rhs, Dim_t T_Rows,
+          Dim_t T_Inner, Dim_t T_Cols, typename T_Scalar>
+void multiplyKernel (
+    Matrix<T_Rows, T_Cols, T_Scalar>& kDst,
+    const MatrixExpression<T_Lhs, T_Rows, T_Inner, T_Scalar>& kLhs,
+    const MatrixExpression<T_Rhs, T_Inner, T_Cols, T_Scalar>& kRhs)
+{
+    typedef MatrixProduct<T_Lhs, T_Rhs, T_Rows, T_Inner, T_Cols> Product_t;
+    MatrixEvaluator<T_StoreOp, Product_t, T_Rows, T_Cols>::run (
+        kDst.mData, Product_t (kLhs.derived (), kRhs.derived ()));
+}
+
+template <typename T_StoreOp, typename T_Lhs, typename T_Rhs, Dim_t T_Rows,
+          Dim_t T_Inner, Dim_t T_Cols, typename T_Scalar>
+void multiplyTransposedKernel (
+    Matrix<T_Rows, T_Cols, T_Scalar>& kDst,
+    const MatrixExpression<T_Lhs, T_Rows, T_Inner, T_Scalar>& kLhs,
+    const MatrixExpression<T_Rhs, T_Cols, T_Inner, T_Scalar>& kRhs)
+{
+    typedef MatrixTranspose<T_Rhs, T_Inner, T_Cols> Transpose_t;
+    typedef MatrixProduct<T_Lhs, Transpose_t, T_Rows, T_Inner, T_Cols>
+        Product_t;
+    MatrixEvaluator<T_StoreOp, Product_t, T_Rows, T_Cols>::run (
+        kDst.mData, Product_t (kLhs.derived (), Transpose_t (kRhs.derived ())));
+}
+
+/**
+ * Computes dst = lhs * rhs.
+ *
+ * @param   kDst Destination matrix.
+ * @param   kLhs LHS expression.
+ * @param   kRhs RHS expression.
+ */
+template <typename T_Lhs, typename T_Rhs, Dim_t T_Rows, Dim_t T_Inner,
+          Dim_t T_Cols, typename T_Scalar>
+void multiplyInto (
+    Matrix<T_Rows, T_Cols, T_Scalar>& kDst,
+    const MatrixExpression<T_Lhs, T_Rows, T_Inner, T_Scalar>& kLhs,
+    const MatrixExpression<T_Rhs, T_Inner, T_Cols, T_Scalar>& kRhs)
+{
+    multiplyKernel<MatrixStoreOp> (kDst, kLhs, kRhs);
+}
+
+/**
+ * Computes dst += lhs * rhs.
+ *
+ * @param   kDst Destination matrix.
+ * @param   kLhs LHS expression.
+ * @param   kRhs RHS expression.
+ */
+template <typename T_Lhs, typename T_Rhs, Dim_t T_Rows, Dim_t T_Inner,
+          Dim_t T_Cols, typename T_Scalar>
+void multiplyAddInto (
+    Matrix<T_Rows, T_Cols, T_Scalar>& kDst,
+    const MatrixExpression<T_Lhs, T_Rows, T_Inner, T_Scalar>& kLhs,
+    const MatrixExpression<T_Rhs, T_Inner, T_Cols, T_Scalar>& kRhs)
+{
+    multiplyKernel<MatrixAddStoreOp> (kDst, kLhs, kRhs);
+}
+
+/**
+ * Computes dst -= lhs * rhs.
+ *
+ * @param   kDst Destination matrix.
+ * @param   kLhs LHS expression.
+ * @param   kRhs RHS expression.
+ */
+template <typename T_Lhs, typename T_Rhs, Dim_t T_Rows, Dim_t T_Inner,
+          Dim_t T_Cols, typename T_Scalar>
+void multiplySubtractInto (
+    Matrix<T_Rows, T_Cols, T_Scalar>& kDst,
+    const MatrixExpression<T_Lhs, T_Rows, T_Inner, T_Scalar>& kLhs,
+    const MatrixExpression<T_Rhs, T_Inner, T_Cols, T_Scalar>& kRhs)
+{
+    multiplyKernel<MatrixSubtractStoreOp> (kDst, kLhs, kRhs);
+}
+
+/**
+ * Computes dst = lhs * rhs^T without forming the transpose.
+ *
+ * @param   kDst Destination matrix.
+ * @param   kLhs LHS expression.
+ * @param   kRhs RHS expression (untransposed).
+ */
+template <typename T_Lhs, typename T_Rhs, Dim_t T_Rows, Dim_t T_Inner,
+          Dim_t T_Cols, typename T_Scalar>
+void multiplyTransposedInto (
+    Matrix<T_Rows, T_Cols, T_Scalar>& kDst,
+    const MatrixExpression<T_Lhs, T_Rows, T_Inner, T_Scalar>& kLhs,
+    const MatrixExpression<T_Rhs, T_Cols, T_Inner, T_Scalar>& kRhs)
+{
+    multiplyTransposedKernel<MatrixStoreOp> (kDst, kLhs, kRhs);
+}
+
+/**
+ * Computes dst += lhs * rhs^T without forming the transpose.
+ *
+ * @param   kDst Destination matrix.
+ * @param   kLhs LHS expression.
+ * @param   kRhs RHS expression (untransposed).
+ */
+template <typename T_Lhs, typename T_Rhs, Dim_t T_Rows, Dim_t T_Inner,
+          Dim_t T_Cols, typename T_Scalar>
+void multiplyTransposedAddInto (
+    Matrix<T_Rows, T_Cols, T_Scalar>& kDst,
+    const MatrixExpression<T_Lhs, T_Rows, T_Inner, T_Scalar>& kLhs,
+    const MatrixExpression<T_Rhs, T_Cols, T_Inner, T_Scalar>& kRhs)
+{
+    multiplyTransposedKernel<MatrixAddStoreOp> (kDst, kLhs, kRhs);
+}
+
 /**
  * Typedefs for common vector sizes.
  */
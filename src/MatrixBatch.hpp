@@ -0,0 +1,366 @@
+/**
+ *                                 [PHOTIC]
+ *                                  v3.2.0
+ *
+ * This file is part of Photic, a collection of utilities for writing high-power
+ * rocket flight computer software. Developed in Austin, TX by the Longhorn
+ * Rocketry Association at the University of Texas at Austin.
+ *
+ *                            ---- THIS FILE ----
+ *
+ * Batches of matrices in structure-of-arrays layout, for running many
+ * independent instances of the same computation in lockstep, e.g. thousands of
+ * filters in a dispersion study. A MatrixBatch<R, C, N> holds N R x C matrices
+ * with element (i, j) of every instance stored contiguously, so each matrix
+ * operation becomes a loop across instances that vectorizes at SIMD width.
+ *
+ * A MatrixBatch is a Matrix whose element type is a BatchScalar, a vector of N
+ * lanes with element-wise arithmetic. Every Matrix operation, expression and
+ * kernel therefore works on batches unchanged, with each scalar operation done
+ * across all lanes.
+ *
+ *                              ---- USAGE ----
+ *
+ *   (1) Gather the instances into a batch.
+ *
+ *         Photic::Matrix<3, 3> a[8];
+ *         Photic::Matrix<3, 3> p[8];
+ *         ...
+ *         Photic::MatrixBatch<3, 3, 8> aBatch;
+ *         Photic::MatrixBatch<3, 3, 8> pBatch;
+ *         Photic::batchGather (aBatch, a);
+ *         Photic::batchGather (pBatch, p);
+ *
+ *   (2) Compute with the batches exactly as with single matrices.
+ *
+ *         Photic::MatrixBatch<3, 3, 8> ap;
+ *         Photic::multiplyInto (ap, aBatch, pBatch);
+ *         pBatch = ap * aBatch.transpose () + pBatch * 0.5;
+ *
+ *   (3) Scatter the results back out, or read a single lane.
+ *
+ *         Photic::batchScatter (pBatch, p);
+ *         Photic::Matrix<3, 3> p3 = Photic::batchLane (pBatch, 3);
+ *
+ *                              ---- NOTES ----
+ *
+ *   (1) Lane arithmetic is vectorized when a vectorized backend is active (see
+ *       MatrixSimd.hpp), the element type is float and the number of lanes is
+ *       a multiple of the packet width. Otherwise lanes are processed by an
+ *       ordinary loop, which is unrolled for up to 16 lanes.
+ *
+ *   (2) Lanes hold independent instances, so there is no meaningful
+ *       comparison of two BatchScalars. Routines that branch on element values
+ *       (e.g. the factorizations, which check for singularity) cannot be used
+ *       on batches.
+ *
+ *   (3) Each lane's results are bit-for-bit identical to the same computation
+ *       on a single Matrix, except that a scalar factor is converted to the
+ *       element type before multiplying, e.g. batch * 0.1 multiplies floats
+ *       by 0.1f where a float Matrix would multiply in double.
+ */
+
+#ifndef PHOTIC_MATRIX_BATCH_HPP
+#define PHOTIC_MATRIX_BATCH_HPP
+
+#include <math.h>
+
+#include "Matrix.hpp"
+#include "MatrixExpression.hpp"
+#include "MatrixLoop.hpp"
+#include "MatrixSimd.hpp"
+#include "Types.hpp"
+
+namespace Photic
+{
+
+/**
+ * Applies a binary operation lane-wise, e.g. dst[l] = lhs[l] + rhs[l]. Uses
+ * the vectorized backend for whole packets of floats.
+ */
+template <typename T_Op, uint32_t T_Lanes, typename T_Scalar,
+          typename T_Enable = void>
+struct BatchKernel
+{
+    static void run (T_Scalar* const kPDst, const T_Scalar* const kPLhs,
+                     const T_Scalar* const kPRhs)
+    {
+        MatrixLoop<T_Lanes>::run ([&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+        {
+            kPDst[i] = T_Op::apply (kPLhs[i], kPRhs[i]);
+        });
+    }
+};
+
+#ifdef PHOTIC_SIMD
+
+template <typename T_Op, uint32_t T_Lanes>
+struct BatchKernel<T_Op, T_Lanes, float,
+                   typename ExpressionEnableIf<
+                       T_Lanes % MatrixSimd::width == 0, void>::Type>
+{
+    static void run (float* const kPDst, const float* const kPLhs,
+                     const float* const kPRhs)
+    {
+        MatrixLoop<T_Lanes / MatrixSimd::width>::run (
+            [&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+        {
+            const uint32_t idx = i * MatrixSimd::width;
+            MatrixSimd::store (kPDst + idx,
+                               T_Op::apply (MatrixSimd::load (kPLhs + idx),
+                                            MatrixSimd::load (kPRhs + idx)));
+        });
+    }
+};
+
+#endif
+
+/**
+ * @param   T_Lanes  Number of lanes, i.e. instances in the batch.
+ * @param   T_Scalar Element type of each lane.
+ */
+template <uint32_t T_Lanes, typename T_Scalar = Real_t>
+class BatchScalar final
+{
+public:
+    static_assert (T_Lanes > 0, "BatchScalar must have at least one lane");
+
+    /**
+     * PUBLIC FOR USE BY UTILITIES ONLY -- DO NOT USE OUTSIDE THIS FILE
+     *
+     * Lane values.
+     */
+    PHOTIC_MATRIX_ALIGN T_Scalar mLanes[T_Lanes];
+
+    /**
+     * Default constructor does nothing, like the built-in arithmetic types.
+     */
+    BatchScalar () = default;
+
+    /**
+     * Sets every lane to the same value. Implicit so that scalars can be used
+     * wherever a BatchScalar is expected, e.g. batch * 0.5.
+     *
+     * @param   kValue Lane value.
+     */
+    BatchScalar (const T_Scalar kValue)
+    {
+        MatrixLoop<T_Lanes>::run ([&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+        {
+            mLanes[i] = kValue;
+        });
+    }
+
+    /**
+     * Lane access operators.
+     *
+     * @param   kLane Lane index.
+     *
+     * @ret     Value in lane kLane.
+     */
+    T_Scalar operator[] (const uint32_t kLane) const
+    {
+        return mLanes[kLane];
+    }
+
+    T_Scalar& operator[] (const uint32_t kLane)
+    {
+        return mLanes[kLane];
+    }
+
+    /**
+     * Lane-wise arithmetic operators. See note (1).
+     */
+    BatchScalar operator- () const
+    {
+        BatchScalar res;
+        MatrixLoop<T_Lanes>::run ([&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+        {
+            res.mLanes[i] = -mLanes[i];
+        });
+        return res;
+    }
+
+    friend BatchScalar operator+ (const BatchScalar& kLhs,
+                                  const BatchScalar& kRhs)
+    {
+        return BatchScalar::combine<ExpressionAddOp> (kLhs, kRhs);
+    }
+
+    friend BatchScalar operator- (const BatchScalar& kLhs,
+                                  const BatchScalar& kRhs)
+    {
+        return BatchScalar::combine<ExpressionSubtractOp> (kLhs, kRhs);
+    }
+
+    friend BatchScalar operator* (const BatchScalar& kLhs,
+                                  const BatchScalar& kRhs)
+    {
+        return BatchScalar::combine<ExpressionMultiplyOp> (kLhs, kRhs);
+    }
+
+    friend BatchScalar operator/ (const BatchScalar& kLhs,
+                                  const BatchScalar& kRhs)
+    {
+        BatchScalar res;
+        MatrixLoop<T_Lanes>::run ([&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+        {
+            res.mLanes[i] = kLhs.mLanes[i] / kRhs.mLanes[i];
+        });
+        return res;
+    }
+
+    BatchScalar& operator+= (const BatchScalar& kRhs)
+    {
+        BatchKernel<ExpressionAddOp, T_Lanes, T_Scalar>::run (
+            mLanes, mLanes, kRhs.mLanes);
+        return *this;
+    }
+
+    BatchScalar& operator-= (const BatchScalar& kRhs)
+    {
+        BatchKernel<ExpressionSubtractOp, T_Lanes, T_Scalar>::run (
+            mLanes, mLanes, kRhs.mLanes);
+        return *this;
+    }
+
+    BatchScalar& operator*= (const BatchScalar& kRhs)
+    {
+        BatchKernel<ExpressionMultiplyOp, T_Lanes, T_Scalar>::run (
+            mLanes, mLanes, kRhs.mLanes);
+        return *this;
+    }
+
+    BatchScalar& operator/= (const BatchScalar& kRhs)
+    {
+        *this = *this / kRhs;
+        return *this;
+    }
+
+    /**
+     * Lane-wise math functions.
+     */
+    friend BatchScalar fabs (const BatchScalar& kValue)
+    {
+        BatchScalar res;
+        MatrixLoop<T_Lanes>::run ([&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+        {
+            res.mLanes[i] = fabs (kValue.mLanes[i]);
+        });
+        return res;
+    }
+
+    friend BatchScalar sqrt (const BatchScalar& kValue)
+    {
+        BatchScalar res;
+        MatrixLoop<T_Lanes>::run ([&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+        {
+            res.mLanes[i] = sqrt (kValue.mLanes[i]);
+        });
+        return res;
+    }
+
+private:
+    /**
+     * Applies a binary operation lane-wise.
+     *
+     * @param   kLhs LHS operand.
+     * @param   kRhs RHS operand.
+     *
+     * @ret     Result.
+     */
+    template <typename T_Op>
+    static BatchScalar combine (const BatchScalar& kLhs,
+                                const BatchScalar& kRhs)
+    {
+        BatchScalar res;
+        BatchKernel<T_Op, T_Lanes, T_Scalar>::run (res.mLanes, kLhs.mLanes,
+                                                   kRhs.mLanes);
+        return res;
+    }
+};
+
+/**
+ * Batch of T_Lanes T_Rows x T_Cols matrices in structure-of-arrays layout.
+ */
+template <Dim_t T_Rows, Dim_t T_Cols, uint32_t T_Lanes,
+          typename T_Scalar = Real_t>
+using MatrixBatch = Matrix<T_Rows, T_Cols, BatchScalar<T_Lanes, T_Scalar>>;
+
+/**
+ * Gets a single instance from a batch.
+ *
+ * @param   kBatch Batch.
+ * @param   kLane  Lane index of the instance.
+ *
+ * @ret     Instance in lane kLane.
+ */
+template <Dim_t T_Rows, Dim_t T_Cols, uint32_t T_Lanes, typename T_Scalar>
+Matrix<T_Rows, T_Cols, T_Scalar> batchLane (
+    const MatrixBatch<T_Rows, T_Cols, T_Lanes, T_Scalar>& kBatch,
+    const uint32_t kLane)
+{
+    Matrix<T_Rows, T_Cols, T_Scalar> mat;
+    MatrixLoop<T_Rows * T_Cols>::run ([&] (const uint32_t i)
+                                      PHOTIC_MATRIX_INLINE
+    {
+        mat.mData[i] = kBatch.mData[i].mLanes[kLane];
+    });
+    return mat;
+}
+
+/**
+ * Sets a single instance of a batch.
+ *
+ * @param   kBatch Batch.
+ * @param   kLane  Lane index of the instance.
+ * @param   kMat   New instance.
+ */
+template <Dim_t T_Rows, Dim_t T_Cols, uint32_t T_Lanes, typename T_Scalar>
+void setBatchLane (MatrixBatch<T_Rows, T_Cols, T_Lanes, T_Scalar>& kBatch,
+                   const uint32_t kLane,
+                   const Matrix<T_Rows, T_Cols, T_Scalar>& kMat)
+{
+    MatrixLoop<T_Rows * T_Cols>::run ([&] (const uint32_t i)
+                                      PHOTIC_MATRIX_INLINE
+    {
+        kBatch.mData[i].mLanes[kLane] = kMat.mData[i];
+    });
+}
+
+/**
+ * Gathers an array of matrices into a batch, one per lane.
+ *
+ * @param   kBatch Destination batch.
+ * @param   kMats  Source matrices.
+ */
+template <Dim_t T_Rows, Dim_t T_Cols, uint32_t T_Lanes, typename T_Scalar>
+void batchGather (MatrixBatch<T_Rows, T_Cols, T_Lanes, T_Scalar>& kBatch,
+                  const Matrix<T_Rows, T_Cols, T_Scalar> (&kMats)[T_Lanes])
+{
+    for (uint32_t lane = 0; lane < T_Lanes; lane++)
+    {
+        setBatchLane (kBatch, lane, kMats[lane]);
+    }
+}
+
+/**
+ * Scatters a batch into an array of matrices, one per lane.
+ *
+ * @param   kBatch Source batch.
+ * @param   kMats  Destination matrices.
+ */
+template <Dim_t T_Rows, Dim_t T_Cols, uint32_t T_Lanes, typename T_Scalar>
+void batchScatter (
+    const MatrixBatch<T_Rows, T_Cols, T_Lanes, T_Scalar>& kBatch,
+    Matrix<T_Rows, T_Cols, T_Scalar> (&kMats)[T_Lanes])
+{
+    for (uint32_t lane = 0; lane < T_Lanes; lane++)
+    {
+        kMats[lane] = batchLane (kBatch, lane);
+    }
+}
+
+} // namespace Photic
+
+#endif
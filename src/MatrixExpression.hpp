@@ -0,0 +1,947 @@
+/**
+ *                                 [PHOTIC]
+ *                                  v3.2.0
+ *
+ * This file is part of Photic, a collection of utilities for writing high-power
+ * rocket flight computer software. Developed in Austin, TX by the Longhorn
+ * Rocketry Association at the University of Texas at Austin.
+ *
+ *                            ---- THIS FILE ----
+ *
+ * Lazy expression templates for Matrix arithmetic. Matrix operators do not
+ * compute their results immediately. Instead they return lightweight expression
+ * objects which describe the computation, and the whole expression is evaluated
+ * in a single pass when it is assigned to a Matrix. For example,
+ *
+ *   Matrix<3, 3> p = a * p * a.transpose () + q;
+ *
+ * evaluates the transpose and the sum inside the final product loop rather
+ * than materializing a transposed copy of a and a sum temporary.
+ *
+ *                              ---- NOTES ----
+ *
+ *   (1) Expressions hold references to the Matrix objects they were built from.
+ *       They are meant to live only as long as the statement that creates
+ *       them. Do not store an expression with auto; assign it to a Matrix.
+ *
+ *   (2) Element-wise operations (add, subtract, scale) and transposes are
+ *       always evaluated lazily. Operands of a product which are not a plain
+ *       Matrix or the transpose of one are evaluated into a temporary owned by
+ *       the product, since each of their elements is read many times. This
+ *       bounds the number of temporaries in an expression to the number of
+ *       nested products, e.g. 1 for a * p * a.transpose () + q.
+ *
+ *   (3) Assigning an expression to a Matrix it reads from is safe. If the
+ *       destination is read through a product or transpose (e.g. p = a * p),
+ *       the expression is evaluated into a temporary first. Purely element-wise
+ *       expressions (e.g. p = p + q) are evaluated in place.
+ */
+
+#ifndef PHOTIC_MATRIX_EXPRESSION_HPP
+#define PHOTIC_MATRIX_EXPRESSION_HPP
+
+#include "MatrixLoop.hpp"
+#include "MatrixSimd.hpp"
+#include "Types.hpp"
+
+namespace Photic
+{
+
+template <Dim_t T_Rows, Dim_t T_Cols, typename T_Scalar>
+class Matrix;
+
+template <typename T_Expr, Dim_t T_Rows, Dim_t T_Cols>
+class MatrixTranspose;
+
+template <typename T_Expr, typename T_To, Dim_t T_Rows, Dim_t T_Cols>
+class MatrixCast;
+
+/**
+ * Untemplated base of all matrix expressions. Used only to detect whether a
+ * type is an expression.
+ */
+class MatrixExpressionBase {};
+
+/**
+ * Base of all matrix expressions. T_Derived is the concrete expression type
+ * and T_Scalar is the type of its elements. T_Derived must provide the
+ * following:
+ *
+ *   T_Scalar coeff (Dim_t, Dim_t) const
+ *       Computes the element at some row and column.
+ *
+ *   bool references (const void* begin, const void* end) const
+ *       Gets if any storage read by the expression overlaps the element
+ *       range [begin, end).
+ *
+ *   bool aliases (const void* begin, const void* end) const
+ *       Gets if writing the expression element-by-element into the element
+ *       range [begin, end) could change elements that are yet to be read.
+ *
+ *   static constexpr bool packetAccess
+ *       If the expression is element-wise over matrices and can be read in
+ *       row-major packets. Such expressions must also provide, when
+ *       PHOTIC_SIMD is defined,
+ *
+ *         MatrixSimd::Packet_t packet (uint32_t) const
+ *             Computes the packet starting at some row-major element index.
+ */
+template <typename T_Derived, Dim_t T_Rows, Dim_t T_Cols, typename T_Scalar>
+class MatrixExpression : public MatrixExpressionBase
+{
+public:
+    /**
+     * Element type.
+     */
+    typedef T_Scalar Scalar_t;
+
+    /**
+     * Gets the concrete expression.
+     *
+     * @ret     Concrete expression.
+     */
+    const T_Derived& derived () const
+    {
+        return static_cast<const T_Derived&> (*this);
+    }
+
+    /**
+     * Computes an element of the expression.
+     *
+     * @param   kRow Row index.
+     * @param   kCol Column index.
+     *
+     * @ret     Element at (kRow, kCol).
+     */
+    T_Scalar operator() (const Dim_t kRow, const Dim_t kCol) const
+    {
+        return this->derived ().coeff (kRow, kCol);
+    }
+
+    /**
+     * Gets the transpose of this expression.
+     *
+     * @ret     Transpose expression.
+     */
+    MatrixTranspose<T_Derived, T_Cols, T_Rows> transpose () const;
+
+    /**
+     * Gets this expression with its elements converted to another scalar type,
+     * e.g. to assign a float expression to a double matrix.
+     *
+     * @ret     Cast expression.
+     */
+    template <typename T_To>
+    MatrixCast<T_Derived, T_To, T_Rows, T_Cols> cast () const;
+};
+
+/**
+ * Minimal enable_if, is_same and expression detection for SFINAE. Arduino
+ * lacks <type_traits>.
+ */
+template <bool T_Cond, typename T_Type>
+struct ExpressionEnableIf {};
+
+template <typename T_Type>
+struct ExpressionEnableIf<true, T_Type>
+{
+    typedef T_Type Type;
+};
+
+template <typename T_Lhs, typename T_Rhs>
+struct ExpressionIsSame
+{
+    static constexpr bool value = false;
+};
+
+template <typename T_Type>
+struct ExpressionIsSame<T_Type, T_Type>
+{
+    static constexpr bool value = true;
+};
+
+template <typename T_Type>
+struct IsMatrixExpression
+{
+    static char test (const MatrixExpressionBase*);
+    static long test (...);
+    static constexpr bool value =
+        sizeof (test (static_cast<T_Type*> (nullptr))) == sizeof (char);
+};
+
+template <typename T_Type>
+struct ExpressionRemoveConst
+{
+    typedef T_Type Type;
+};
+
+template <typename T_Type>
+struct ExpressionRemoveConst<const T_Type>
+{
+    typedef T_Type Type;
+};
+
+/**
+ * Gets if two element ranges [begin, end) share any storage. Leaf expressions
+ * use this to implement references and aliases.
+ *
+ * @param   kPBegin     Start of first range.
+ * @param   kPEnd       End of first range.
+ * @param   kPDataBegin Start of second range.
+ * @param   kPDataEnd   End of second range.
+ *
+ * @ret     If the ranges overlap.
+ */
+inline bool matrixStorageOverlaps (const void* const kPBegin,
+                                   const void* const kPEnd,
+                                   const void* const kPDataBegin,
+                                   const void* const kPDataEnd)
+{
+    return static_cast<const char*> (kPBegin) <
+               static_cast<const char*> (kPDataEnd) &&
+           static_cast<const char*> (kPDataBegin) <
+               static_cast<const char*> (kPEnd);
+}
+
+/**
+ * Maps an expression type to the type used to hold it inside another
+ * expression. Matrices are held by reference and expressions by value.
+ */
+template <typename T_Expr>
+struct ExpressionNest
+{
+    typedef const T_Expr Type;
+};
+
+template <Dim_t T_Rows, Dim_t T_Cols, typename T_Scalar>
+struct ExpressionNest<Matrix<T_Rows, T_Cols, T_Scalar>>
+{
+    typedef const Matrix<T_Rows, T_Cols, T_Scalar>& Type;
+};
+
+/**
+ * Element-wise binary operations.
+ */
+struct ExpressionAddOp
+{
+    template <typename T_Scalar>
+    static T_Scalar apply (const T_Scalar kLhs, const T_Scalar kRhs)
+    {
+        return kLhs + kRhs;
+    }
+
+#ifdef PHOTIC_SIMD
+    static MatrixSimd::Packet_t apply (const MatrixSimd::Packet_t kLhs,
+                                       const MatrixSimd::Packet_t kRhs)
+    {
+        return MatrixSimd::add (kLhs, kRhs);
+    }
+#endif
+};
+
+struct ExpressionSubtractOp
+{
+    template <typename T_Scalar>
+    static T_Scalar apply (const T_Scalar kLhs, const T_Scalar kRhs)
+    {
+        return kLhs - kRhs;
+    }
+
+#ifdef PHOTIC_SIMD
+    static MatrixSimd::Packet_t apply (const MatrixSimd::Packet_t kLhs,
+                                       const MatrixSimd::Packet_t kRhs)
+    {
+        return MatrixSimd::subtract (kLhs, kRhs);
+    }
+#endif
+};
+
+struct ExpressionMultiplyOp
+{
+    template <typename T_Scalar>
+    static T_Scalar apply (const T_Scalar kLhs, const T_Scalar kRhs)
+    {
+        return kLhs * kRhs;
+    }
+
+#ifdef PHOTIC_SIMD
+    static MatrixSimd::Packet_t apply (const MatrixSimd::Packet_t kLhs,
+                                       const MatrixSimd::Packet_t kRhs)
+    {
+        return MatrixSimd::multiply (kLhs, kRhs);
+    }
+#endif
+};
+
+/**
+ * Element-wise combination of two same-sized expressions, e.g. a + b.
+ */
+template <typename T_Lhs, typename T_Rhs, typename T_Op, Dim_t T_Rows,
+          Dim_t T_Cols>
+class MatrixElementwise final :
+    public MatrixExpression<MatrixElementwise<T_Lhs, T_Rhs, T_Op, T_Rows,
+                                              T_Cols>,
+                            T_Rows, T_Cols, typename T_Lhs::Scalar_t>
+{
+public:
+    typedef typename T_Lhs::Scalar_t Scalar_t;
+
+    static constexpr bool packetAccess =
+        T_Lhs::packetAccess && T_Rhs::packetAccess;
+
+    MatrixElementwise (const T_Lhs& kLhs, const T_Rhs& kRhs) :
+        mLhs (kLhs), mRhs (kRhs) {}
+
+    Scalar_t coeff (const Dim_t kRow, const Dim_t kCol) const
+    {
+        return T_Op::apply (mLhs.coeff (kRow, kCol), mRhs.coeff (kRow, kCol));
+    }
+
+#ifdef PHOTIC_SIMD
+    MatrixSimd::Packet_t packet (const uint32_t kIdx) const
+    {
+        return T_Op::apply (mLhs.packet (kIdx), mRhs.packet (kIdx));
+    }
+#endif
+
+    bool references (const void* kPBegin, const void* kPEnd) const
+    {
+        return mLhs.references (kPBegin, kPEnd) ||
+               mRhs.references (kPBegin, kPEnd);
+    }
+
+    bool aliases (const void* kPBegin, const void* kPEnd) const
+    {
+        return mLhs.aliases (kPBegin, kPEnd) || mRhs.aliases (kPBegin, kPEnd);
+    }
+
+private:
+    typename ExpressionNest<T_Lhs>::Type mLhs;
+    typename ExpressionNest<T_Rhs>::Type mRhs;
+};
+
+/**
+ * An expression times a scalar factor, e.g. a * 2. The product of each element
+ * and the factor is computed in the type of their natural promotion and then
+ * narrowed to the element type.
+ */
+template <typename T_Expr, typename T_Factor, Dim_t T_Rows, Dim_t T_Cols>
+class MatrixScale final :
+    public MatrixExpression<MatrixScale<T_Expr, T_Factor, T_Rows, T_Cols>,
+                            T_Rows, T_Cols, typename T_Expr::Scalar_t>
+{
+public:
+    typedef typename T_Expr::Scalar_t Scalar_t;
+
+    // Vectorizing is only exact if the product is naturally computed in
+    // the element type, e.g. not for a double factor of a float matrix.
+    static constexpr bool packetAccess =
+        T_Expr::packetAccess &&
+        sizeof (decltype (Scalar_t () * T_Factor ())) == sizeof (Scalar_t);
+
+    MatrixScale (const T_Expr& kExpr, const T_Factor kFactor) :
+        mExpr (kExpr), mFactor (kFactor) {}
+
+    Scalar_t coeff (const Dim_t kRow, const Dim_t kCol) const
+    {
+        return (Scalar_t) (mExpr.coeff (kRow, kCol) * mFactor);
+    }
+
+#ifdef PHOTIC_SIMD
+    MatrixSimd::Packet_t packet (const uint32_t kIdx) const
+    {
+        return MatrixSimd::multiply (mExpr.packet (kIdx),
+                                     MatrixSimd::broadcast ((float) mFactor));
+    }
+#endif
+
+    bool references (const void* kPBegin, const void* kPEnd) const
+    {
+        return mExpr.references (kPBegin, kPEnd);
+    }
+
+    bool aliases (const void* kPBegin, const void* kPEnd) const
+    {
+        return mExpr.aliases (kPBegin, kPEnd);
+    }
+
+private:
+    typename ExpressionNest<T_Expr>::Type mExpr;
+    const T_Factor mFactor;
+};
+
+/**
+ * Transpose of an expression. T_Rows and T_Cols are the dimensions of the
+ * transpose, not of the transposed expression.
+ */
+template <typename T_Expr, Dim_t T_Rows, Dim_t T_Cols>
+class MatrixTranspose final :
+    public MatrixExpression<MatrixTranspose<T_Expr, T_Rows, T_Cols>,
+                            T_Rows, T_Cols, typename T_Expr::Scalar_t>
+{
+public:
+    typedef typename T_Expr::Scalar_t Scalar_t;
+
+    static constexpr bool packetAccess = false;
+
+    MatrixTranspose (const T_Expr& kExpr) : mExpr (kExpr) {}
+
+    /**
+     * Gets the transposed expression.
+     */
+    typename ExpressionNest<T_Expr>::Type& nested () const
+    {
+        return mExpr;
+    }
+
+    Scalar_t coeff (const Dim_t kRow, const Dim_t kCol) const
+    {
+        return mExpr.coeff (kCol, kRow);
+    }
+
+    bool references (const void* kPBegin, const void* kPEnd) const
+    {
+        return mExpr.references (kPBegin, kPEnd);
+    }
+
+    bool aliases (const void* kPBegin, const void* kPEnd) const
+    {
+        // Element (i, j) of the destination is written before element (j, i)
+        // of the source is read.
+        return mExpr.references (kPBegin, kPEnd);
+    }
+
+private:
+    typename ExpressionNest<T_Expr>::Type mExpr;
+};
+
+template <typename T_Derived, Dim_t T_Rows, Dim_t T_Cols, typename T_Scalar>
+MatrixTranspose<T_Derived, T_Cols, T_Rows>
+MatrixExpression<T_Derived, T_Rows, T_Cols, T_Scalar>::transpose () const
+{
+    return MatrixTranspose<T_Derived, T_Cols, T_Rows> (this->derived ());
+}
+
+/**
+ * An expression with its elements converted to another scalar type.
+ */
+template <typename T_Expr, typename T_To, Dim_t T_Rows, Dim_t T_Cols>
+class MatrixCast final :
+    public MatrixExpression<MatrixCast<T_Expr, T_To, T_Rows, T_Cols>,
+                            T_Rows, T_Cols, T_To>
+{
+public:
+    static constexpr bool packetAccess = false;
+
+    MatrixCast (const T_Expr& kExpr) : mExpr (kExpr) {}
+
+    T_To coeff (const Dim_t kRow, const Dim_t kCol) const
+    {
+        return (T_To) mExpr.coeff (kRow, kCol);
+    }
+
+    bool references (const void* kPBegin, const void* kPEnd) const
+    {
+        return mExpr.references (kPBegin, kPEnd);
+    }
+
+    bool aliases (const void* kPBegin, const void* kPEnd) const
+    {
+        return mExpr.aliases (kPBegin, kPEnd);
+    }
+
+private:
+    typename ExpressionNest<T_Expr>::Type mExpr;
+};
+
+template <typename T_Derived, Dim_t T_Rows, Dim_t T_Cols, typename T_Scalar>
+template <typename T_To>
+MatrixCast<T_Derived, T_To, T_Rows, T_Cols>
+MatrixExpression<T_Derived, T_Rows, T_Cols, T_Scalar>::cast () const
+{
+    return MatrixCast<T_Derived, T_To, T_Rows, T_Cols> (this->derived ());
+}
+
+/**
+ * Maps a product operand type to the type used to hold it inside the product.
+ * Matrices and transposed matrices are cheap to index and are held as-is. Any
+ * other expression is evaluated into a temporary Matrix when the product is
+ * built, since a product reads each of its operand elements many times.
+ */
+template <typename T_Expr, Dim_t T_Rows, Dim_t T_Cols>
+struct ProductOperand
+{
+    typedef const Matrix<T_Rows, T_Cols, typename T_Expr::Scalar_t> Type;
+};
+
+template <Dim_t T_Rows, Dim_t T_Cols, typename T_Scalar>
+struct ProductOperand<Matrix<T_Rows, T_Cols, T_Scalar>, T_Rows, T_Cols>
+{
+    typedef const Matrix<T_Rows, T_Cols, T_Scalar>& Type;
+};
+
+template <Dim_t T_Rows, Dim_t T_Cols, typename T_Scalar>
+struct ProductOperand<
+    MatrixTranspose<Matrix<T_Cols, T_Rows, T_Scalar>, T_Rows, T_Cols>,
+    T_Rows, T_Cols>
+{
+    typedef const MatrixTranspose<Matrix<T_Cols, T_Rows, T_Scalar>, T_Rows,
+                                  T_Cols> Type;
+};
+
+/**
+ * Compile-time structure of an expression's elements. An element that is a
+ * structural zero is 0 in every instance of the type, and a structural unit is
+ * always 1. Products skip terms with a structural zero factor and skip the
+ * multiply for a structural unit factor. Expressions are dense by default; see
+ * StructuredMatrix.hpp.
+ */
+template <typename T_Expr>
+struct MatrixStructure
+{
+    static constexpr bool zero (const Dim_t, const Dim_t)
+    {
+        return false;
+    }
+
+    static constexpr bool unit (const Dim_t, const Dim_t)
+    {
+        return false;
+    }
+};
+
+template <typename T_Expr, Dim_t T_Rows, Dim_t T_Cols>
+struct MatrixStructure<MatrixTranspose<T_Expr, T_Rows, T_Cols>>
+{
+    static constexpr bool zero (const Dim_t kRow, const Dim_t kCol)
+    {
+        return MatrixStructure<T_Expr>::zero (kCol, kRow);
+    }
+
+    static constexpr bool unit (const Dim_t kRow, const Dim_t kCol)
+    {
+        return MatrixStructure<T_Expr>::unit (kCol, kRow);
+    }
+};
+
+/**
+ * Accumulates a single product term lhs(i, k) * rhs(k, j), using the structure
+ * of the operand types T_Lhs and T_Rhs. Skipped terms and multiplies are exact,
+ * so results match the dense product except where a dense product would
+ * multiply a structural zero by an infinity or NaN. The term is computed in
+ * the accumulator type.
+ */
+template <typename T_Lhs, typename T_Rhs>
+struct ProductTerm
+{
+    /**
+     * @param   kAcc    Accumulator.
+     * @param   kLhs    LHS operand, as held.
+     * @param   kLhsRow LHS row index.
+     * @param   kLhsCol LHS column index.
+     * @param   kRhs    RHS operand, as held.
+     * @param   kRhsRow RHS row index.
+     * @param   kRhsCol RHS column index.
+     */
+    template <typename T_Accum, typename T_LhsHeld, typename T_RhsHeld>
+    PHOTIC_MATRIX_INLINE static void accumulate (T_Accum& kAcc,
+                                                 const T_LhsHeld& kLhs,
+                                                 const Dim_t kLhsRow,
+                                                 const Dim_t kLhsCol,
+                                                 const T_RhsHeld& kRhs,
+                                                 const Dim_t kRhsRow,
+                                                 const Dim_t kRhsCol)
+    {
+        if (MatrixStructure<T_Lhs>::zero (kLhsRow, kLhsCol) ||
+            MatrixStructure<T_Rhs>::zero (kRhsRow, kRhsCol))
+        {
+            return;
+        }
+
+        if (MatrixStructure<T_Lhs>::unit (kLhsRow, kLhsCol))
+        {
+            kAcc += (T_Accum) kRhs.coeff (kRhsRow, kRhsCol);
+        }
+        else if (MatrixStructure<T_Rhs>::unit (kRhsRow, kRhsCol))
+        {
+            kAcc += (T_Accum) kLhs.coeff (kLhsRow, kLhsCol);
+        }
+        else
+        {
+            kAcc += (T_Accum) kLhs.coeff (kLhsRow, kLhsCol) *
+                    (T_Accum) kRhs.coeff (kRhsRow, kRhsCol);
+        }
+    }
+};
+
+/**
+ * Product of two expressions, e.g. a * b.
+ *
+ * NOTE: This uses the naive O(n^3) algorithm. The next best algorithm
+ * (Strassen's) only becomes advantageous around n=100 or so. This is
+ * technically within the bounds of Dim_t, but if you're multiplying 100x100
+ * matrices in flight, I'd really like to hear wtf you're doing.
+ *
+ * Elements are accumulated in T_Accum, which is the element type unless a
+ * wider type is requested with product<T_Accum> (a, b).
+ */
+template <typename T_Lhs, typename T_Rhs, Dim_t T_Rows, Dim_t T_Inner,
+          Dim_t T_Cols, typename T_Accum = typename T_Lhs::Scalar_t>
+class MatrixProduct final :
+    public MatrixExpression<MatrixProduct<T_Lhs, T_Rhs, T_Rows, T_Inner,
+                                          T_Cols, T_Accum>,
+                            T_Rows, T_Cols, typename T_Lhs::Scalar_t>
+{
+public:
+    typedef typename T_Lhs::Scalar_t Scalar_t;
+
+    static constexpr bool packetAccess = false;
+
+    MatrixProduct (const T_Lhs& kLhs, const T_Rhs& kRhs) :
+        mLhs (kLhs), mRhs (kRhs) {}
+
+    /**
+     * Gets the operands as held by the product.
+     */
+    typename ProductOperand<T_Lhs, T_Rows, T_Inner>::Type& lhs () const
+    {
+        return mLhs;
+    }
+
+    typename ProductOperand<T_Rhs, T_Inner, T_Cols>::Type& rhs () const
+    {
+        return mRhs;
+    }
+
+    Scalar_t coeff (const Dim_t kRow, const Dim_t kCol) const
+    {
+        T_Accum elem = 0;
+
+        MatrixLoop<T_Inner>::run ([&] (const uint32_t k) PHOTIC_MATRIX_INLINE
+        {
+            ProductTerm<T_Lhs, T_Rhs>::accumulate (elem, mLhs, kRow, k, mRhs, k,
+                                                   kCol);
+        });
+
+        return (Scalar_t) elem;
+    }
+
+    bool references (const void* kPBegin, const void* kPEnd) const
+    {
+        return mLhs.references (kPBegin, kPEnd) ||
+               mRhs.references (kPBegin, kPEnd);
+    }
+
+    bool aliases (const void* kPBegin, const void* kPEnd) const
+    {
+        // Every operand element is read by several destination elements.
+        return this->references (kPBegin, kPEnd);
+    }
+
+private:
+    typename ProductOperand<T_Lhs, T_Rows, T_Inner>::Type mLhs;
+    typename ProductOperand<T_Rhs, T_Inner, T_Cols>::Type mRhs;
+};
+
+/**
+ * Operations for storing an evaluated element into its destination.
+ */
+struct MatrixStoreOp
+{
+    template <typename T_Scalar>
+    static void apply (T_Scalar& kDst, const T_Scalar kVal)
+    {
+        kDst = kVal;
+    }
+
+#ifdef PHOTIC_SIMD
+    static MatrixSimd::Packet_t apply (const MatrixSimd::Packet_t,
+                                       const MatrixSimd::Packet_t kVal)
+    {
+        return kVal;
+    }
+#endif
+};
+
+struct MatrixAddStoreOp
+{
+    template <typename T_Scalar>
+    static void apply (T_Scalar& kDst, const T_Scalar kVal)
+    {
+        kDst += kVal;
+    }
+
+#ifdef PHOTIC_SIMD
+    static MatrixSimd::Packet_t apply (const MatrixSimd::Packet_t kDst,
+                                       const MatrixSimd::Packet_t kVal)
+    {
+        return MatrixSimd::add (kDst, kVal);
+    }
+#endif
+};
+
+struct MatrixSubtractStoreOp
+{
+    template <typename T_Scalar>
+    static void apply (T_Scalar& kDst, const T_Scalar kVal)
+    {
+        kDst -= kVal;
+    }
+
+#ifdef PHOTIC_SIMD
+    static MatrixSimd::Packet_t apply (const MatrixSimd::Packet_t kDst,
+                                       const MatrixSimd::Packet_t kVal)
+    {
+        return MatrixSimd::subtract (kDst, kVal);
+    }
+#endif
+};
+
+/**
+ * Evaluates an expression into a row-major element buffer, storing each
+ * element with T_StoreOp. Performs no alias checking.
+ *
+ * The general case computes each element with coeff. With a vectorized
+ * backend, specializations below handle float element-wise expressions,
+ * products with a float Matrix RHS, and 4x4 float transposes.
+ */
+template <typename T_StoreOp, typename T_Expr, Dim_t T_Rows, Dim_t T_Cols,
+          typename T_Enable = void>
+struct MatrixEvaluator
+{
+    static void run (typename T_Expr::Scalar_t* const kPDst,
+                     const T_Expr& kExpr)
+    {
+        MatrixLoop2D<T_Rows, T_Cols>::run (
+            [&] (const Dim_t i, const Dim_t j) PHOTIC_MATRIX_INLINE
+        {
+            T_StoreOp::apply (kPDst[T_Cols * i + j], kExpr.coeff (i, j));
+        });
+    }
+};
+
+#ifdef PHOTIC_SIMD
+
+/**
+ * Element-wise expressions are evaluated a packet at a time, with any
+ * remaining elements done individually.
+ */
+template <typename T_StoreOp, typename T_Expr, Dim_t T_Rows, Dim_t T_Cols>
+struct MatrixEvaluator<T_StoreOp, T_Expr, T_Rows, T_Cols,
+                       typename ExpressionEnableIf<T_Expr::packetAccess,
+                                                   void>::Type>
+{
+    static void run (float* const kPDst, const T_Expr& kExpr)
+    {
+        static constexpr uint32_t elems = T_Rows * T_Cols;
+        static constexpr uint32_t packets = elems / MatrixSimd::width;
+
+        MatrixLoop<packets>::run ([&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+        {
+            float* const pDst = kPDst + i * MatrixSimd::width;
+            MatrixSimd::store (pDst,
+                               T_StoreOp::apply (MatrixSimd::load (pDst),
+                                                 kExpr.packet (
+                                                     i * MatrixSimd::width)));
+        });
+
+        MatrixLoop<elems % MatrixSimd::width>::run (
+            [&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+        {
+            const uint32_t idx = packets * MatrixSimd::width + i;
+            T_StoreOp::apply (kPDst[idx],
+                              kExpr.coeff (idx / T_Cols, idx % T_Cols));
+        });
+    }
+};
+
+/**
+ * Products whose RHS rows are contiguous and a whole number of packets wide
+ * are evaluated a row packet at a time. Each destination packet accumulates
+ * LHS element (i, k) times RHS row packet k, in increasing k, which is the
+ * same operation order as the scalar kernel.
+ */
+template <typename T_RhsHeld>
+struct ProductRowAccess
+{
+    static constexpr bool value = false;
+};
+
+template <Dim_t T_Rows, Dim_t T_Cols>
+struct ProductRowAccess<const Matrix<T_Rows, T_Cols, float>>
+{
+    static constexpr bool value = true;
+};
+
+template <Dim_t T_Rows, Dim_t T_Cols>
+struct ProductRowAccess<const Matrix<T_Rows, T_Cols, float>&>
+{
+    static constexpr bool value = true;
+};
+
+template <typename T_StoreOp, typename T_Lhs, typename T_Rhs, Dim_t T_Rows,
+          Dim_t T_Inner, Dim_t T_Cols, typename T_Accum>
+struct MatrixEvaluator<
+    T_StoreOp, MatrixProduct<T_Lhs, T_Rhs, T_Rows, T_Inner, T_Cols, T_Accum>,
+    T_Rows, T_Cols,
+    typename ExpressionEnableIf<
+        T_Cols % MatrixSimd::width == 0 &&
+        ExpressionIsSame<T_Accum, float>::value &&
+        ProductRowAccess<typename ProductOperand<T_Rhs, T_Inner,
+                                                 T_Cols>::Type>::value,
+        void>::Type>
+{
+    static void run (
+        float* const kPDst,
+        const MatrixProduct<T_Lhs, T_Rhs, T_Rows, T_Inner, T_Cols, T_Accum>&
+            kExpr)
+    {
+        static constexpr uint32_t packets = T_Cols / MatrixSimd::width;
+        const float* const pRhs = kExpr.rhs ().mData;
+
+        MatrixLoop2D<T_Rows, packets>::run (
+            [&] (const Dim_t i, const Dim_t p) PHOTIC_MATRIX_INLINE
+        {
+            const uint32_t col = p * MatrixSimd::width;
+            MatrixSimd::Packet_t elem = MatrixSimd::broadcast (0);
+
+            MatrixLoop<T_Inner>::run ([&] (const uint32_t k)
+                                      PHOTIC_MATRIX_INLINE
+            {
+                if (MatrixStructure<T_Lhs>::zero (i, k))
+                {
+                    return;
+                }
+
+                const MatrixSimd::Packet_t row =
+                    MatrixSimd::load (pRhs + T_Cols * k + col);
+                elem = MatrixSimd::add (
+                    elem,
+                    MatrixStructure<T_Lhs>::unit (i, k) ? row :
+                        MatrixSimd::multiply (
+                            MatrixSimd::broadcast (kExpr.lhs ().coeff (i, k)),
+                            row));
+            });
+
+            float* const pDst = kPDst + T_Cols * i + col;
+            MatrixSimd::store (pDst, T_StoreOp::apply (MatrixSimd::load (pDst),
+                                                       elem));
+        });
+    }
+};
+
+/**
+ * 4x4 float matrix transposes use the backend's register transpose.
+ */
+template <Dim_t T_Dim>
+struct MatrixEvaluator<
+    MatrixStoreOp, MatrixTranspose<Matrix<T_Dim, T_Dim, float>, T_Dim, T_Dim>,
+    T_Dim, T_Dim, typename ExpressionEnableIf<T_Dim == 4, void>::Type>
+{
+    static void run (
+        float* const kPDst,
+        const MatrixTranspose<Matrix<T_Dim, T_Dim, float>, T_Dim, T_Dim>& kExpr)
+    {
+        MatrixSimd::transpose4x4 (kPDst, kExpr.nested ().mData);
+    }
+};
+
+#endif
+
+/**
+ * Computes the sum of two expressions. Enables equations like a = b + c.
+ *
+ * @param   kLhs LHS expression.
+ * @param   kRhs RHS expression.
+ *
+ * @ret     Sum expression.
+ */
+template <typename T_Lhs, typename T_Rhs, Dim_t T_Rows, Dim_t T_Cols,
+          typename T_Scalar>
+MatrixElementwise<T_Lhs, T_Rhs, ExpressionAddOp, T_Rows, T_Cols>
+operator+ (const MatrixExpression<T_Lhs, T_Rows, T_Cols, T_Scalar>& kLhs,
+           const MatrixExpression<T_Rhs, T_Rows, T_Cols, T_Scalar>& kRhs)
+{
+    return MatrixElementwise<T_Lhs, T_Rhs, ExpressionAddOp, T_Rows, T_Cols> (
+        kLhs.derived (), kRhs.derived ());
+}
+
+/**
+ * Computes the difference of two expressions. Enables equations like
+ * a = b - c.
+ *
+ * @param   kLhs LHS expression.
+ * @param   kRhs RHS expression.
+ *
+ * @ret     Difference expression.
+ */
+template <typename T_Lhs, typename T_Rhs, Dim_t T_Rows, Dim_t T_Cols,
+          typename T_Scalar>
+MatrixElementwise<T_Lhs, T_Rhs, ExpressionSubtractOp, T_Rows, T_Cols>
+operator- (const MatrixExpression<T_Lhs, T_Rows, T_Cols, T_Scalar>& kLhs,
+           const MatrixExpression<T_Rhs, T_Rows, T_Cols, T_Scalar>& kRhs)
+{
+    return MatrixElementwise<T_Lhs, T_Rhs, ExpressionSubtractOp, T_Rows,
+                             T_Cols> (kLhs.derived (), kRhs.derived ());
+}
+
+/**
+ * Computes the product of two expressions. Enables equations like a = b * c.
+ *
+ * @param   kLhs LHS expression.
+ * @param   kRhs RHS expression.
+ *
+ * @ret     Product expression.
+ */
+template <typename T_Lhs, typename T_Rhs, Dim_t T_Rows, Dim_t T_Inner,
+          Dim_t T_Cols, typename T_Scalar>
+MatrixProduct<T_Lhs, T_Rhs, T_Rows, T_Inner, T_Cols>
+operator* (const MatrixExpression<T_Lhs, T_Rows, T_Inner, T_Scalar>& kLhs,
+           const MatrixExpression<T_Rhs, T_Inner, T_Cols, T_Scalar>& kRhs)
+{
+    return MatrixProduct<T_Lhs, T_Rhs, T_Rows, T_Inner, T_Cols> (
+        kLhs.derived (), kRhs.derived ());
+}
+
+/**
+ * Computes the product of two expressions, accumulating each element in a
+ * wider type than the element type. Enables equations like
+ * a = product<double> (b, c) for float matrices.
+ *
+ * @param   kLhs LHS expression.
+ * @param   kRhs RHS expression.
+ *
+ * @ret     Product expression.
+ */
+template <typename T_Accum, typename T_Lhs, typename T_Rhs, Dim_t T_Rows,
+          Dim_t T_Inner, Dim_t T_Cols, typename T_Scalar>
+MatrixProduct<T_Lhs, T_Rhs, T_Rows, T_Inner, T_Cols, T_Accum>
+product (const MatrixExpression<T_Lhs, T_Rows, T_Inner, T_Scalar>& kLhs,
+         const MatrixExpression<T_Rhs, T_Inner, T_Cols, T_Scalar>& kRhs)
+{
+    return MatrixProduct<T_Lhs, T_Rhs, T_Rows, T_Inner, T_Cols, T_Accum> (
+        kLhs.derived (), kRhs.derived ());
+}
+
+/**
+ * Computes an expression times a scalar.
+ *
+ * @param   kExpr   Expression.
+ * @param   kFactor Scalar factor.
+ *
+ * @ret     Scaled expression.
+ */
+template <typename T_Expr, Dim_t T_Rows, Dim_t T_Cols, typename T_Scalar,
+          typename T_Factor>
+typename ExpressionEnableIf<!IsMatrixExpression<T_Factor>::value,
+                            MatrixScale<T_Expr, T_Factor, T_Rows, T_Cols>>::Type
+operator* (const MatrixExpression<T_Expr, T_Rows, T_Cols, T_Scalar>& kExpr,
+           const T_Factor kFactor)
+{
+    return MatrixScale<T_Expr, T_Factor, T_Rows, T_Cols> (kExpr.derived (),
+                                                          kFactor);
+}
+
+} // namespace Photic
+
+#endif
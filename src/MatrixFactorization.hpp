@@ -0,0 +1,548 @@
+/**
+ *                                 [PHOTIC]
+ *                                  v3.2.0
+ *
+ * This file is part of Photic, a collection of utilities for writing high-power
+ * rocket flight computer software. Developed in Austin, TX by the Longhorn
+ * Rocketry Association at the University of Texas at Austin.
+ *
+ *                            ---- THIS FILE ----
+ *
+ * In-place factorizations of small square matrices and the solves that use
+ * them. Solving A X = B with a factorization is cheaper and more accurate than
+ * forming A^-1 and multiplying by it.
+ *
+ *   luDecompose / luSolve             General A, LU with partial pivoting
+ *   choleskyDecompose / choleskySolve Symmetric positive definite A = L L^T
+ *   ldltDecompose / ldltSolve         Symmetric A = L D L^T, no square roots
+ *   ldltSolveRight                    X A = B for symmetric A, e.g. a Kalman
+ *                                     gain K S = P H^T
+ *
+ * None of the routines allocate. Loops are fully unrolled for matrices up to
+ * 4x4 (see MatrixLoop.hpp) and are ordinary loops for larger matrices.
+ *
+ *                              ---- USAGE ----
+ *
+ *   Matrix<3, 3> a = ...;
+ *   Matrix<3, 1> b = ...;
+ *   Dim_t pivots[3];
+ *   if (luDecompose (a, pivots))
+ *   {
+ *       luSolve (a, pivots, b); // b now holds x such that A x = b.
+ *   }
+ *
+ *                              ---- NOTES ----
+ *
+ *   (1) Each decomposition returns false if the matrix is singular (or, for
+ *       Cholesky, not positive definite). The matrix is then only partially
+ *       factored and must not be passed to a solve.
+ *
+ *   (2) The Cholesky and LDL^T decompositions read only the lower triangle of
+ *       the matrix and leave the strict upper triangle unchanged. The factor is
+ *       stored in the lower triangle: L for Cholesky, and the strict lower part
+ *       of the unit lower triangular L with D on the diagonal for LDL^T.
+ *
+ *   (3) LDL^T does not pivot, so it is intended for symmetric positive definite
+ *       matrices such as covariances.
+ */
+
+#ifndef PHOTIC_MATRIX_FACTORIZATION_HPP
+#define PHOTIC_MATRIX_FACTORIZATION_HPP
+
+#include <math.h>
+
+#include "Matrix.hpp"
+#include "Types.hpp"
+
+namespace Photic
+{
+
+/**
+ * Loop over the rows or columns of a factored matrix. The loop nests of a
+ * factorization cover the whole matrix, so they are unrolled when the matrix
+ * is within the unroll limit.
+ */
+template <Dim_t T_Dim>
+struct FactorizationLoop :
+    MatrixLoop<T_Dim, T_Dim * T_Dim <= PHOTIC_MATRIX_UNROLL_LIMIT> {};
+
+/**
+ * Gets the magnitude of a scalar without converting it to double.
+ *
+ * @param   kVal Value.
+ *
+ * @ret     |kVal|.
+ */
+template <typename T_Scalar>
+inline T_Scalar factorizationAbs (const T_Scalar kVal)
+{
+    return kVal < 0 ? -kVal : kVal;
+}
+
+/**
+ * Factors a matrix into P A = L U in place, where P is a row permutation, L is
+ * unit lower triangular and U is upper triangular. See note (1).
+ *
+ * @param   kA      Matrix to factor. Overwritten with U in the upper triangle
+ *                  and the strict lower triangle of L below it.
+ * @param   kPivots Set to the row swapped with row k at step k.
+ *
+ * @ret     If the matrix is nonsingular.
+ */
+template <Dim_t T_Dim, typename T_Scalar>
+bool luDecompose (Matrix<T_Dim, T_Dim, T_Scalar>& kA, Dim_t (&kPivots)[T_Dim])
+{
+    bool nonsingular = true;
+
+    FactorizationLoop<T_Dim>::run ([&] (const uint32_t k) PHOTIC_MATRIX_INLINE
+    {
+        if (!nonsingular)
+        {
+            return;
+        }
+
+        // Pivot on the largest remaining element in column k.
+        Dim_t pivot = k;
+        T_Scalar pivotAbs = factorizationAbs (kA (k, k));
+        FactorizationLoop<T_Dim>::run (
+            [&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+        {
+            if (i > k && factorizationAbs (kA (i, k)) > pivotAbs)
+            {
+                pivot = i;
+                pivotAbs = factorizationAbs (kA (i, k));
+            }
+        });
+
+        kPivots[k] = pivot;
+        if (pivotAbs == 0)
+        {
+            nonsingular = false;
+            return;
+        }
+
+        if (pivot != k)
+        {
+            FactorizationLoop<T_Dim>::run (
+                [&] (const uint32_t j) PHOTIC_MATRIX_INLINE
+            {
+                const T_Scalar tmp = kA (k, j);
+                kA (k, j) = kA (pivot, j);
+                kA (pivot, j) = tmp;
+            });
+        }
+
+        // Eliminate column k below the diagonal.
+        const T_Scalar pivotInv = (T_Scalar) 1 / kA (k, k);
+        FactorizationLoop<T_Dim>::run (
+            [&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+        {
+            if (i <= k)
+            {
+                return;
+            }
+
+            kA (i, k) *= pivotInv;
+            FactorizationLoop<T_Dim>::run (
+                [&] (const uint32_t j) PHOTIC_MATRIX_INLINE
+            {
+                if (j > k)
+                {
+                    kA (i, j) -= kA (i, k) * kA (k, j);
+                }
+            });
+        });
+    });
+
+    return nonsingular;
+}
+
+/**
+ * Solves A X = B in place with an LU factorization of A.
+ *
+ * @param   kLu     LU factorization from luDecompose.
+ * @param   kPivots Pivots from luDecompose.
+ * @param   kB      Right-hand sides. Overwritten with the solutions.
+ */
+template <Dim_t T_Dim, Dim_t T_Cols, typename T_Scalar>
+void luSolve (const Matrix<T_Dim, T_Dim, T_Scalar>& kLu,
+              const Dim_t (&kPivots)[T_Dim],
+              Matrix<T_Dim, T_Cols, T_Scalar>& kB)
+{
+    // Apply the row swaps in the order they were made.
+    FactorizationLoop<T_Dim>::run ([&] (const uint32_t k) PHOTIC_MATRIX_INLINE
+    {
+        const Dim_t pivot = kPivots[k];
+        if (pivot == k)
+        {
+            return;
+        }
+
+        MatrixLoop<T_Cols>::run ([&] (const uint32_t j) PHOTIC_MATRIX_INLINE
+        {
+            const T_Scalar tmp = kB (k, j);
+            kB (k, j) = kB (pivot, j);
+            kB (pivot, j) = tmp;
+        });
+    });
+
+    // Forward substitution with unit lower triangular L.
+    FactorizationLoop<T_Dim>::run ([&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+    {
+        FactorizationLoop<T_Dim>::run (
+            [&] (const uint32_t k) PHOTIC_MATRIX_INLINE
+        {
+            if (k >= i)
+            {
+                return;
+            }
+
+            MatrixLoop<T_Cols>::run (
+                [&] (const uint32_t j) PHOTIC_MATRIX_INLINE
+            {
+                kB (i, j) -= kLu (i, k) * kB (k, j);
+            });
+        });
+    });
+
+    // Back substitution with upper triangular U, from the last row up.
+    FactorizationLoop<T_Dim>::run ([&] (const uint32_t r) PHOTIC_MATRIX_INLINE
+    {
+        const Dim_t i = T_Dim - 1 - r;
+        FactorizationLoop<T_Dim>::run (
+            [&] (const uint32_t k) PHOTIC_MATRIX_INLINE
+        {
+            if (k <= i)
+            {
+                return;
+            }
+
+            MatrixLoop<T_Cols>::run (
+                [&] (const uint32_t j) PHOTIC_MATRIX_INLINE
+            {
+                kB (i, j) -= kLu (i, k) * kB (k, j);
+            });
+        });
+
+        const T_Scalar diagInv = (T_Scalar) 1 / kLu (i, i);
+        MatrixLoop<T_Cols>::run ([&] (const uint32_t j) PHOTIC_MATRIX_INLINE
+        {
+            kB (i, j) *= diagInv;
+        });
+    });
+}
+
+/**
+ * Factors a symmetric positive definite matrix into A = L L^T in place. See
+ * notes (1) and (2).
+ *
+ * @param   kA Matrix to factor. Lower triangle is overwritten with L.
+ *
+ * @ret     If the matrix is positive definite.
+ */
+template <Dim_t T_Dim, typename T_Scalar>
+bool choleskyDecompose (Matrix<T_Dim, T_Dim, T_Scalar>& kA)
+{
+    bool positiveDefinite = true;
+
+    // Column by column, so each column's diagonal is known before the elements
+    // below it are divided by it.
+    FactorizationLoop<T_Dim>::run ([&] (const uint32_t j) PHOTIC_MATRIX_INLINE
+    {
+        if (!positiveDefinite)
+        {
+            return;
+        }
+
+        T_Scalar diag = kA (j, j);
+        FactorizationLoop<T_Dim>::run (
+            [&] (const uint32_t k) PHOTIC_MATRIX_INLINE
+        {
+            if (k < j)
+            {
+                diag -= kA (j, k) * kA (j, k);
+            }
+        });
+
+        if (!(diag > 0))
+        {
+            positiveDefinite = false;
+            return;
+        }
+
+        kA (j, j) = sqrt (diag);
+        const T_Scalar diagInv = (T_Scalar) 1 / kA (j, j);
+
+        FactorizationLoop<T_Dim>::run (
+            [&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+        {
+            if (i <= j)
+            {
+                return;
+            }
+
+            T_Scalar elem = kA (i, j);
+            FactorizationLoop<T_Dim>::run (
+                [&] (const uint32_t k) PHOTIC_MATRIX_INLINE
+            {
+                if (k < j)
+                {
+                    elem -= kA (i, k) * kA (j, k);
+                }
+            });
+            kA (i, j) = elem * diagInv;
+        });
+    });
+
+    return positiveDefinite;
+}
+
+/**
+ * Solves A X = B in place with a Cholesky factorization of A.
+ *
+ * @param   kL Cholesky factorization from choleskyDecompose.
+ * @param   kB Right-hand sides. Overwritten with the solutions.
+ */
+template <Dim_t T_Dim, Dim_t T_Cols, typename T_Scalar>
+void choleskySolve (const Matrix<T_Dim, T_Dim, T_Scalar>& kL,
+                    Matrix<T_Dim, T_Cols, T_Scalar>& kB)
+{
+    // Forward substitution with L.
+    FactorizationLoop<T_Dim>::run ([&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+    {
+        FactorizationLoop<T_Dim>::run (
+            [&] (const uint32_t k) PHOTIC_MATRIX_INLINE
+        {
+            if (k >= i)
+            {
+                return;
+            }
+
+            MatrixLoop<T_Cols>::run (
+                [&] (const uint32_t j) PHOTIC_MATRIX_INLINE
+            {
+                kB (i, j) -= kL (i, k) * kB (k, j);
+            });
+        });
+
+        const T_Scalar diagInv = (T_Scalar) 1 / kL (i, i);
+        MatrixLoop<T_Cols>::run ([&] (const uint32_t j) PHOTIC_MATRIX_INLINE
+        {
+            kB (i, j) *= diagInv;
+        });
+    });
+
+    // Back substitution with L^T, from the last row up.
+    FactorizationLoop<T_Dim>::run ([&] (const uint32_t r) PHOTIC_MATRIX_INLINE
+    {
+        const Dim_t i = T_Dim - 1 - r;
+        FactorizationLoop<T_Dim>::run (
+            [&] (const uint32_t k) PHOTIC_MATRIX_INLINE
+        {
+            if (k <= i)
+            {
+                return;
+            }
+
+            MatrixLoop<T_Cols>::run (
+                [&] (const uint32_t j) PHOTIC_MATRIX_INLINE
+            {
+                kB (i, j) -= kL (k, i) * kB (k, j);
+            });
+        });
+
+        const T_Scalar diagInv = (T_Scalar) 1 / kL (i, i);
+        MatrixLoop<T_Cols>::run ([&] (const uint32_t j) PHOTIC_MATRIX_INLINE
+        {
+            kB (i, j) *= diagInv;
+        });
+    });
+}
+
+/**
+ * Factors a symmetric matrix into A = L D L^T in place, where L is unit lower
+ * triangular and D is diagonal. See notes (1)-(3).
+ *
+ * @param   kA Matrix to factor. Lower triangle is overwritten with L and D.
+ *
+ * @ret     If the matrix is nonsingular.
+ */
+template <Dim_t T_Dim, typename T_Scalar>
+bool ldltDecompose (Matrix<T_Dim, T_Dim, T_Scalar>& kA)
+{
+    bool nonsingular = true;
+
+    FactorizationLoop<T_Dim>::run ([&] (const uint32_t j) PHOTIC_MATRIX_INLINE
+    {
+        if (!nonsingular)
+        {
+            return;
+        }
+
+        // L(j, k) D(k), shared by the diagonal and every element below it.
+        T_Scalar ld[T_Dim];
+        T_Scalar diag = kA (j, j);
+        FactorizationLoop<T_Dim>::run (
+            [&] (const uint32_t k) PHOTIC_MATRIX_INLINE
+        {
+            if (k < j)
+            {
+                ld[k] = kA (j, k) * kA (k, k);
+                diag -= kA (j, k) * ld[k];
+            }
+        });
+
+        if (diag == 0)
+        {
+            nonsingular = false;
+            return;
+        }
+
+        kA (j, j) = diag;
+        const T_Scalar diagInv = (T_Scalar) 1 / diag;
+
+        FactorizationLoop<T_Dim>::run (
+            [&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+        {
+            if (i <= j)
+            {
+                return;
+            }
+
+            T_Scalar elem = kA (i, j);
+            FactorizationLoop<T_Dim>::run (
+                [&] (const uint32_t k) PHOTIC_MATRIX_INLINE
+            {
+                if (k < j)
+                {
+                    elem -= kA (i, k) * ld[k];
+                }
+            });
+            kA (i, j) = elem * diagInv;
+        });
+    });
+
+    return nonsingular;
+}
+
+/**
+ * Solves A X = B in place with an LDL^T factorization of A.
+ *
+ * @param   kLdl LDL^T factorization from ldltDecompose.
+ * @param   kB   Right-hand sides. Overwritten with the solutions.
+ */
+template <Dim_t T_Dim, Dim_t T_Cols, typename T_Scalar>
+void ldltSolve (const Matrix<T_Dim, T_Dim, T_Scalar>& kLdl,
+                Matrix<T_Dim, T_Cols, T_Scalar>& kB)
+{
+    // Forward substitution with unit lower triangular L, then scaling by D^-1.
+    FactorizationLoop<T_Dim>::run ([&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+    {
+        FactorizationLoop<T_Dim>::run (
+            [&] (const uint32_t k) PHOTIC_MATRIX_INLINE
+        {
+            if (k >= i)
+            {
+                return;
+            }
+
+            MatrixLoop<T_Cols>::run (
+                [&] (const uint32_t j) PHOTIC_MATRIX_INLINE
+            {
+                kB (i, j) -= kLdl (i, k) * kB (k, j);
+            });
+        });
+    });
+
+    FactorizationLoop<T_Dim>::run ([&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+    {
+        const T_Scalar diagInv = (T_Scalar) 1 / kLdl (i, i);
+        MatrixLoop<T_Cols>::run ([&] (const uint32_t j) PHOTIC_MATRIX_INLINE
+        {
+            kB (i, j) *= diagInv;
+        });
+    });
+
+    // Back substitution with L^T, from the last row up.
+    FactorizationLoop<T_Dim>::run ([&] (const uint32_t r) PHOTIC_MATRIX_INLINE
+    {
+        const Dim_t i = T_Dim - 1 - r;
+        FactorizationLoop<T_Dim>::run (
+            [&] (const uint32_t k) PHOTIC_MATRIX_INLINE
+        {
+            if (k <= i)
+            {
+                return;
+            }
+
+            MatrixLoop<T_Cols>::run (
+                [&] (const uint32_t j) PHOTIC_MATRIX_INLINE
+            {
+                kB (i, j) -= kLdl (k, i) * kB (k, j);
+            });
+        });
+    });
+}
+
+/**
+ * Solves X A = B in place with an LDL^T factorization of symmetric A. Each row
+ * of X is the solution of A x^T = b^T for the same row b of B.
+ *
+ * @param   kLdl LDL^T factorization from ldltDecompose.
+ * @param   kB   Right-hand sides, one per row. Overwritten with the solutions.
+ */
+template <Dim_t T_Dim, Dim_t T_Rows, typename T_Scalar>
+void ldltSolveRight (const Matrix<T_Dim, T_Dim, T_Scalar>& kLdl,
+                     Matrix<T_Rows, T_Dim, T_Scalar>& kB)
+{
+    // Same steps as ldltSolve with the roles of rows and columns of B swapped.
+    FactorizationLoop<T_Dim>::run ([&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+    {
+        FactorizationLoop<T_Dim>::run (
+            [&] (const uint32_t k) PHOTIC_MATRIX_INLINE
+        {
+            if (k >= i)
+            {
+                return;
+            }
+
+            MatrixLoop<T_Rows>::run (
+                [&] (const uint32_t j) PHOTIC_MATRIX_INLINE
+            {
+                kB (j, i) -= kLdl (i, k) * kB (j, k);
+            });
+        });
+    });
+
+    FactorizationLoop<T_Dim>::run ([&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+    {
+        const T_Scalar diagInv = (T_Scalar) 1 / kLdl (i, i);
+        MatrixLoop<T_Rows>::run ([&] (const uint32_t j) PHOTIC_MATRIX_INLINE
+        {
+            kB (j, i) *= diagInv;
+        });
+    });
+
+    FactorizationLoop<T_Dim>::run ([&] (const uint32_t r) PHOTIC_MATRIX_INLINE
+    {
+        const Dim_t i = T_Dim - 1 - r;
+        FactorizationLoop<T_Dim>::run (
+            [&] (const uint32_t k) PHOTIC_MATRIX_INLINE
+        {
+            if (k <= i)
+            {
+                return;
+            }
+
+            MatrixLoop<T_Rows>::run (
+                [&] (const uint32_t j) PHOTIC_MATRIX_INLINE
+            {
+                kB (j, i) -= kLdl (k, i) * kB (j, k);
+            });
+        });
+    });
+}
+
+} // namespace Photic
+
+#endif
@@ -0,0 +1,179 @@
+/**
+ *                                 [PHOTIC]
+ *                                  v3.2.0
+ *
+ * This file is part of Photic, a collection of utilities for writing high-power
+ * rocket flight computer software. Developed in Austin, TX by the Longhorn
+ * Rocketry Association at the University of Texas at Austin.
+ *
+ *                            ---- THIS FILE ----
+ *
+ * Compile-time loop utilities used by the Matrix kernels. Every loop in the
+ * Matrix kernels has a trip count known at compile time. Loops at or under
+ * PHOTIC_MATRIX_UNROLL_LIMIT iterations are fully unrolled through template
+ * recursion so that each element access compiles to a fixed offset. This
+ * covers every matrix up to 4x4, which is every matrix Photic itself uses.
+ * Larger loops fall back to ordinary runtime loops to bound code size.
+ *
+ * The unrolling does not rely on the optimizer, so it also applies to
+ * size-optimized (-Os) embedded builds which otherwise rarely unroll.
+ *
+ *                              ---- USAGE ----
+ *
+ *   Loop bodies are callables taking the loop index, e.g.
+ *
+ *     Real_t sum = 0;
+ *     MatrixLoop<3>::run ([&] (const uint32_t k) PHOTIC_MATRIX_INLINE
+ *     {
+ *         sum += a[k] * b[k];
+ *     });
+ *
+ *   MatrixLoop2D walks a row-major grid and passes (row, column).
+ */
+
+#ifndef PHOTIC_MATRIX_LOOP_HPP
+#define PHOTIC_MATRIX_LOOP_HPP
+
+#include "Types.hpp"
+
+/**
+ * Largest loop trip count that is fully unrolled. May be defined by the user
+ * before including Photic to trade code size for speed.
+ */
+#ifndef PHOTIC_MATRIX_UNROLL_LIMIT
+    #define PHOTIC_MATRIX_UNROLL_LIMIT 16
+#endif
+
+/**
+ * Forces inlining of loop bodies. Without this, size-optimized builds emit each
+ * unrolled iteration as a function call.
+ */
+#if defined (__GNUC__)
+    #define PHOTIC_MATRIX_INLINE __attribute__ ((always_inline))
+#else
+    #define PHOTIC_MATRIX_INLINE
+#endif
+
+namespace Photic
+{
+
+/**
+ * Unrolled loop over [T_Idx, T_Count).
+ */
+template <uint32_t T_Idx, uint32_t T_Count>
+struct MatrixUnroll
+{
+    template <typename T_Body>
+    PHOTIC_MATRIX_INLINE static void run (const T_Body& kBody)
+    {
+        kBody (T_Idx);
+        MatrixUnroll<T_Idx + 1, T_Count>::run (kBody);
+    }
+};
+
+template <uint32_t T_Count>
+struct MatrixUnroll<T_Count, T_Count>
+{
+    template <typename T_Body>
+    static void run (const T_Body&) {}
+};
+
+/**
+ * Unrolled loop over the flattened row-major grid indices [T_Idx, T_Count) of
+ * a grid T_Cols wide.
+ */
+template <uint32_t T_Idx, uint32_t T_Count, Dim_t T_Cols>
+struct MatrixUnroll2D
+{
+    template <typename T_Body>
+    PHOTIC_MATRIX_INLINE static void run (const T_Body& kBody)
+    {
+        kBody (T_Idx / T_Cols, T_Idx % T_Cols);
+        MatrixUnroll2D<T_Idx + 1, T_Count, T_Cols>::run (kBody);
+    }
+};
+
+template <uint32_t T_Count, Dim_t T_Cols>
+struct MatrixUnroll2D<T_Count, T_Count, T_Cols>
+{
+    template <typename T_Body>
+    static void run (const T_Body&) {}
+};
+
+/**
+ * Loop over [0, T_Count).
+ */
+template <uint32_t T_Count,
+          bool T_Unroll = (T_Count <= PHOTIC_MATRIX_UNROLL_LIMIT)>
+struct MatrixLoop
+{
+    template <typename T_Body>
+    PHOTIC_MATRIX_INLINE static void run (const T_Body& kBody)
+    {
+        for (uint32_t i = 0; i < T_Count; i++)
+        {
+            kBody (i);
+        }
+    }
+};
+
+template <uint32_t T_Count>
+struct MatrixLoop<T_Count, true>
+{
+    template <typename T_Body>
+    PHOTIC_MATRIX_INLINE static void run (const T_Body& kBody)
+    {
+        MatrixUnroll<0, T_Count>::run (kBody);
+    }
+};
+
+/**
+ * Loop over every (row, column) of a T_Rows x T_Cols grid in row-major order.
+ */
+template <Dim_t T_Rows, Dim_t T_Cols,
+          bool T_Unroll = (T_Rows * T_Cols <= PHOTIC_MATRIX_UNROLL_LIMIT)>
+struct MatrixLoop2D
+{
+    template <typename T_Body>
+    PHOTIC_MATRIX_INLINE static void run (const T_Body& kBody)
+    {
+        for (Dim_t i = 0; i < T_Rows; i++)
+        {
+            for (Dim_t j = 0; j < T_Cols; j++)
+            {
+                kBody (i, j);
+            }
+        }
+    }
+};
+
+template <Dim_t T_Rows, Dim_t T_Cols>
+struct MatrixLoop2D<T_Rows, T_Cols, true>
+{
+    template <typename T_Body>
+    PHOTIC_MATRIX_INLINE static void run (const T_Body& kBody)
+    {
+        MatrixUnroll2D<0, T_Rows * T_Cols, T_Cols>::run (kBody);
+    }
+};
+
+/**
+ * Compile-time sequence of element indices, used to build constexpr matrices.
+ * MakeMatrixIndexSequence<N>::Type is MatrixIndexSequence<0, 1, ..., N - 1>.
+ */
+template <uint32_t... T_Idxs>
+struct MatrixIndexSequence {};
+
+template <uint32_t T_Count, uint32_t... T_Idxs>
+struct MakeMatrixIndexSequence :
+    MakeMatrixIndexSequence<T_Count - 1, T_Count - 1, T_Idxs...> {};
+
+template <uint32_t... T_Idxs>
+struct MakeMatrixIndexSequence<0, T_Idxs...>
+{
+    typedef MatrixIndexSequence<T_Idxs...> Type;
+};
+
+} // namespace Photic
+
+#endif
@@ -0,0 +1,204 @@
+/**
+ *                                 [PHOTIC]
+ *                                  v3.2.0
+ *
+ * This file is part of Photic, a collection of utilities for writing high-power
+ * rocket flight computer software. Developed in Austin, TX by the Longhorn
+ * Rocketry Association at the University of Texas at Austin.
+ *
+ *                            ---- THIS FILE ----
+ *
+ * Optional vectorized backend for the Matrix kernels on host builds. The
+ * backend is selected at compile time:
+ *
+ *   - Arduino builds, or any build defining PHOTIC_NO_SIMD, use the scalar
+ *     kernels.
+ *   - x86 builds with SSE (every x86-64 build) use 4-wide SSE. AVX builds use
+ *     the same 128-bit path, since no Photic matrix has rows wide enough to
+ *     fill an 8-wide register.
+ *   - ARM builds with NEON use 4-wide NEON.
+ *
+ * PHOTIC_SIMD is defined when a vectorized backend is active. Matrix storage is
+ * then aligned to the vector width.
+ *
+ *                              ---- NOTES ----
+ *
+ *   (1) The vectorized kernels perform exactly the same floating point
+ *       operations in exactly the same order as the scalar kernels, so results
+ *       are bit-for-bit identical. The one exception is a compiler that
+ *       contracts the scalar kernels' multiply-adds into fused multiply-adds
+ *       (e.g. GCC with -mfma and the default -ffp-contract=fast). The scalar
+ *       results then differ from the vectorized results by at most 1 ulp per
+ *       accumulated term.
+ *
+ *   (2) Vectorized paths exist for element-wise expressions (sums,
+ *       differences and scaling by a non-double scalar of matrices), products
+ *       whose RHS is a Matrix with a multiple of 4 columns, and 4x4 transposes.
+ *       Everything else uses the scalar kernels.
+ */
+
+#ifndef PHOTIC_MATRIX_SIMD_HPP
+#define PHOTIC_MATRIX_SIMD_HPP
+
+#include "Types.hpp"
+
+#if !defined (ARDUINO) && !defined (PHOTIC_NO_SIMD)
+    #if defined (__SSE__)
+        #include <xmmintrin.h>
+        #define PHOTIC_SIMD
+        #define PHOTIC_SIMD_SSE
+    #elif defined (__ARM_NEON)
+        #include <arm_neon.h>
+        #define PHOTIC_SIMD
+        #define PHOTIC_SIMD_NEON
+    #endif
+#endif
+
+/**
+ * Alignment of Matrix storage.
+ */
+#ifdef PHOTIC_SIMD
+    #define PHOTIC_MATRIX_ALIGN alignas (16)
+#else
+    #define PHOTIC_MATRIX_ALIGN
+#endif
+
+#ifdef PHOTIC_SIMD
+
+namespace Photic
+{
+
+/**
+ * 4-wide float vector operations. Matrices of any other scalar type use the
+ * scalar kernels.
+ */
+struct MatrixSimd
+{
+    /**
+     * Number of floats in a packet.
+     */
+    static constexpr uint32_t width = 4;
+
+#ifdef PHOTIC_SIMD_SSE
+    typedef __m128 Packet_t;
+
+    static Packet_t load (const float* const kPSrc)
+    {
+        return _mm_load_ps (kPSrc);
+    }
+
+    static Packet_t loadUnaligned (const float* const kPSrc)
+    {
+        return _mm_loadu_ps (kPSrc);
+    }
+
+    static void store (float* const kPDst, const Packet_t kPacket)
+    {
+        _mm_store_ps (kPDst, kPacket);
+    }
+
+    static void storeUnaligned (float* const kPDst, const Packet_t kPacket)
+    {
+        _mm_storeu_ps (kPDst, kPacket);
+    }
+
+    static Packet_t broadcast (const float kVal)
+    {
+        return _mm_set1_ps (kVal);
+    }
+
+    static Packet_t add (const Packet_t kLhs, const Packet_t kRhs)
+    {
+        return _mm_add_ps (kLhs, kRhs);
+    }
+
+    static Packet_t subtract (const Packet_t kLhs, const Packet_t kRhs)
+    {
+        return _mm_sub_ps (kLhs, kRhs);
+    }
+
+    static Packet_t multiply (const Packet_t kLhs, const Packet_t kRhs)
+    {
+        return _mm_mul_ps (kLhs, kRhs);
+    }
+
+    /**
+     * Transposes a row-major 4x4 block.
+     *
+     * @param   kPDst Destination block, 16-byte aligned.
+     * @param   kPSrc Source block, 16-byte aligned.
+     */
+    static void transpose4x4 (float* const kPDst, const float* const kPSrc)
+    {
+        __m128 row0 = _mm_load_ps (kPSrc);
+        __m128 row1 = _mm_load_ps (kPSrc + 4);
+        __m128 row2 = _mm_load_ps (kPSrc + 8);
+        __m128 row3 = _mm_load_ps (kPSrc + 12);
+        _MM_TRANSPOSE4_PS (row0, row1, row2, row3);
+        _mm_store_ps (kPDst, row0);
+        _mm_store_ps (kPDst + 4, row1);
+        _mm_store_ps (kPDst + 8, row2);
+        _mm_store_ps (kPDst + 12, row3);
+    }
+#endif
+
+#ifdef PHOTIC_SIMD_NEON
+    typedef float32x4_t Packet_t;
+
+    static Packet_t load (const float* const kPSrc)
+    {
+        return vld1q_f32 (kPSrc);
+    }
+
+    static Packet_t loadUnaligned (const float* const kPSrc)
+    {
+        return vld1q_f32 (kPSrc);
+    }
+
+    static void store (float* const kPDst, const Packet_t kPacket)
+    {
+        vst1q_f32 (kPDst, kPacket);
+    }
+
+    static void storeUnaligned (float* const kPDst, const Packet_t kPacket)
+    {
+        vst1q_f32 (kPDst, kPacket);
+    }
+
+    static Packet_t broadcast (const float kVal)
+    {
+        return vdupq_n_f32 (kVal);
+    }
+
+    static Packet_t add (const Packet_t kLhs, const Packet_t kRhs)
+    {
+        return vaddq_f32 (kLhs, kRhs);
+    }
+
+    static Packet_t subtract (const Packet_t kLhs, const Packet_t kRhs)
+    {
+        return vsubq_f32 (kLhs, kRhs);
+    }
+
+    static Packet_t multiply (const Packet_t kLhs, const Packet_t kRhs)
+    {
+        return vmulq_f32 (kLhs, kRhs);
+    }
+
+    static void transpose4x4 (float* const kPDst, const float* const kPSrc)
+    {
+        // De-interleaving load puts each source column in its own register.
+        const float32x4x4_t cols = vld4q_f32 (kPSrc);
+        vst1q_f32 (kPDst, cols.val[0]);
+        vst1q_f32 (kPDst + 4, cols.val[1]);
+        vst1q_f32 (kPDst + 8, cols.val[2]);
+        vst1q_f32 (kPDst + 12, cols.val[3]);
+    }
+#endif
+};
+
+} // namespace Photic
+
+#endif
+
+#endif
@@ -0,0 +1,553 @@
+/**
+ *                                 [PHOTIC]
+ *                                  v3.2.0
+ *
+ * This file is part of Photic, a collection of utilities for writing high-power
+ * rocket flight computer software. Developed in Austin, TX by the Longhorn
+ * Rocketry Association at the University of Texas at Austin.
+ *
+ *                            ---- THIS FILE ----
+ *
+ * Non-owning views of matrix storage. A MatrixView reads and writes elements
+ * of some other storage in place, e.g. a block, row or column of a Matrix or a
+ * raw sensor buffer, without copying them. Strides between rows and columns
+ * are template parameters, so element addressing compiles to constant offsets.
+ *
+ *                              ---- USAGE ----
+ *
+ *   (1) Take a view of part of a Matrix. Offsets and sizes are template
+ *       parameters and are bounds checked at compile time.
+ *
+ *         Photic::Matrix<6, 6> p;
+ *         auto pos = Photic::blockView<0, 0, 3, 3> (p);
+ *         auto row = Photic::rowView<2> (p);
+ *         auto col = Photic::columnView<4> (p);
+ *
+ *   (2) Or view a raw buffer, e.g. an IMU reading.
+ *
+ *         Photic::MatrixView<3, 1, const Real_t> accel (
+ *             imu->getAccelerationVectorPtr ());
+ *
+ *   (3) Use the view anywhere a Matrix can be read or written.
+ *
+ *         pos = pos * 2;
+ *         row += col.transpose ();
+ *         Photic::multiplyInto (pos, a, b);
+ *         Photic::Vector3_t world = MathUtils::rotateVector (quat, accel);
+ *
+ *                              ---- NOTES ----
+ *
+ *   (1) A view does not own its storage. The storage must outlive the view.
+ *
+ *   (2) Copying a view copies the pointer, so views are passed by value.
+ *       Assigning to a view writes its elements.
+ *
+ *   (3) A view with a const element type, e.g. MatrixView<3, 1, const Real_t>,
+ *       is read-only.
+ *
+ *   (4) Writes into a view are alias checked against everything the
+ *       expression reads, since a view and an operand may share storage with
+ *       different layouts. Overlapping expressions are evaluated into a
+ *       temporary Matrix first.
+ *
+ *   (5) A SymmetricMatrix is packed and cannot be viewed. Views of its
+ *       expansion into a Matrix can be.
+ */
+
+#ifndef PHOTIC_MATRIX_VIEW_HPP
+#define PHOTIC_MATRIX_VIEW_HPP
+
+#include "Matrix.hpp"
+#include "Types.hpp"
+
+namespace Photic
+{
+
+/**
+ * @param   T_Scalar    Element type. Const for a read-only view.
+ * @param   T_RowStride Elements between the starts of consecutive rows.
+ * @param   T_ColStride Elements between consecutive elements of a row.
+ */
+template <Dim_t T_Rows, Dim_t T_Cols, typename T_Scalar = Real_t,
+          uint32_t T_RowStride = T_Cols, uint32_t T_ColStride = 1>
+class MatrixView final :
+    public MatrixExpression<
+        MatrixView<T_Rows, T_Cols, T_Scalar, T_RowStride, T_ColStride>,
+        T_Rows, T_Cols, typename ExpressionRemoveConst<T_Scalar>::Type>
+{
+public:
+    typedef typename ExpressionRemoveConst<T_Scalar>::Type Scalar_t;
+
+    /**
+     * Number of elements from the first viewed element to one past the last.
+     */
+    static constexpr uint32_t span =
+        (T_Rows - 1) * T_RowStride + (T_Cols - 1) * T_ColStride + 1;
+
+    /**
+     * Constructor.
+     *
+     * @param   kPData Pointer to element (0, 0).
+     */
+    explicit MatrixView (T_Scalar* const kPData) : mPData (kPData) {}
+
+    /**
+     * Copy constructor copies the view, not the elements. See note (2).
+     *
+     * @param   kRhs RHS view.
+     */
+    MatrixView (const MatrixView<T_Rows, T_Cols, T_Scalar, T_RowStride,
+                                 T_ColStride>& kRhs) = default;
+
+    /**
+     * Copies the elements of another view of the same type into this one.
+     *
+     * @param   kRhs RHS view.
+     *
+     * @ret     This view.
+     */
+    MatrixView<T_Rows, T_Cols, T_Scalar, T_RowStride, T_ColStride>& operator= (
+        const MatrixView<T_Rows, T_Cols, T_Scalar, T_RowStride,
+                         T_ColStride>& kRhs)
+    {
+        return this->update<MatrixStoreOp> (kRhs);
+    }
+
+    /**
+     * Evaluates an expression into the viewed elements. See note (4).
+     *
+     * @param   kExpr Expression.
+     *
+     * @ret     This view.
+     */
+    template <typename T_Expr>
+    MatrixView<T_Rows, T_Cols, T_Scalar, T_RowStride, T_ColStride>& operator= (
+        const MatrixExpression<T_Expr, T_Rows, T_Cols, Scalar_t>& kExpr)
+    {
+        return this->update<MatrixStoreOp> (kExpr.derived ());
+    }
+
+    /**
+     * Adds an expression to the viewed elements in place.
+     *
+     * @param   kExpr RHS expression.
+     *
+     * @ret     This view.
+     */
+    template <typename T_Expr>
+    MatrixView<T_Rows, T_Cols, T_Scalar, T_RowStride, T_ColStride>&
+    operator+= (const MatrixExpression<T_Expr, T_Rows, T_Cols, Scalar_t>& kExpr)
+    {
+        return this->update<MatrixAddStoreOp> (kExpr.derived ());
+    }
+
+    /**
+     * Subtracts an expression from the viewed elements in place.
+     *
+     * @param   kExpr RHS expression.
+     *
+     * @ret     This view.
+     */
+    template <typename T_Expr>
+    MatrixView<T_Rows, T_Cols, T_Scalar, T_RowStride, T_ColStride>&
+    operator-= (const MatrixExpression<T_Expr, T_Rows, T_Cols, Scalar_t>& kExpr)
+    {
+        return this->update<MatrixSubtractStoreOp> (kExpr.derived ());
+    }
+
+    /**
+     * Multiplies the viewed elements by a scalar in place.
+     *
+     * @param   kFactor Scalar factor.
+     *
+     * @ret     This view.
+     */
+    template <typename T_Factor>
+    typename ExpressionEnableIf<
+        !IsMatrixExpression<T_Factor>::value,
+        MatrixView<T_Rows, T_Cols, T_Scalar, T_RowStride, T_ColStride>&>::Type
+    operator*= (const T_Factor kFactor)
+    {
+        // Each element is read only by the element it is written to.
+        this->store<MatrixStoreOp> (*this * kFactor);
+        return *this;
+    }
+
+    /**
+     * Fills the viewed elements with some value.
+     *
+     * @param   kFill Fill value.
+     */
+    void fill (const Scalar_t kFill)
+    {
+        MatrixLoop2D<T_Rows, T_Cols>::run (
+            [&] (const Dim_t i, const Dim_t j) PHOTIC_MATRIX_INLINE
+        {
+            mPData[T_RowStride * i + T_ColStride * j] = kFill;
+        });
+    }
+
+    /**
+     * Element access operator.
+     *
+     * @param   kRow Row index.
+     * @param   kCol Column index.
+     *
+     * @ret     Reference to element at (kRow, kCol).
+     */
+    T_Scalar& operator() (const Dim_t kRow, const Dim_t kCol) const
+    {
+        return mPData[T_RowStride * kRow + T_ColStride * kCol];
+    }
+
+    /**
+     * Vector element access operator.
+     *
+     * NOTE: Intended only for use with 1-row or 1-column views.
+     *
+     * @param   kIdx Element index.
+     *
+     * @ret     Reference to kIdxth element in vector.
+     */
+    T_Scalar& operator[] (const Dim_t kIdx) const
+    {
+        return mPData[(T_Cols == 1 ? T_RowStride : T_ColStride) * kIdx];
+    }
+
+    /**
+     * Gets a pointer to element (0, 0).
+     *
+     * @ret     Viewed storage.
+     */
+    T_Scalar* data () const
+    {
+        return mPData;
+    }
+
+    /**
+     * Expression interface; see MatrixExpression.hpp. Only views of
+     * contiguous rows can be read in packets.
+     */
+    static constexpr bool packetAccess =
+        ExpressionIsSame<Scalar_t, float>::value &&
+        T_RowStride == T_Cols && T_ColStride == 1;
+
+#ifdef PHOTIC_SIMD
+    MatrixSimd::Packet_t packet (const uint32_t kIdx) const
+    {
+        return MatrixSimd::loadUnaligned (mPData + kIdx);
+    }
+#endif
+
+    Scalar_t coeff (const Dim_t kRow, const Dim_t kCol) const
+    {
+        return mPData[T_RowStride * kRow + T_ColStride * kCol];
+    }
+
+    bool references (const void* kPBegin, const void* kPEnd) const
+    {
+        return matrixStorageOverlaps (kPBegin, kPEnd, mPData, mPData + span);
+    }
+
+    bool aliases (const void* kPBegin, const void* kPEnd) const
+    {
+        // The destination's layout may differ from the view's, so any overlap
+        // could write an element before it is read.
+        return this->references (kPBegin, kPEnd);
+    }
+
+    /**
+     * PUBLIC FOR USE BY UTILITIES ONLY -- DO NOT USE OUTSIDE THIS FILE
+     *
+     * Combines an expression into the viewed elements element-by-element with
+     * some store operation, without any alias checking.
+     *
+     * @param   kExpr Expression.
+     */
+    template <typename T_StoreOp, typename T_Expr>
+    void store (const T_Expr& kExpr) const
+    {
+        MatrixLoop2D<T_Rows, T_Cols>::run (
+            [&] (const Dim_t i, const Dim_t j) PHOTIC_MATRIX_INLINE
+        {
+            T_StoreOp::apply (mPData[T_RowStride * i + T_ColStride * j],
+                              kExpr.coeff (i, j));
+        });
+    }
+
+private:
+    T_Scalar* mPData; /* Element (0, 0). */
+
+    /**
+     * Combines an expression into the viewed elements with some store
+     * operation, evaluating it into a temporary first if it overlaps the
+     * view. See note (4).
+     *
+     * @param   kExpr Expression.
+     *
+     * @ret     This view.
+     */
+    template <typename T_StoreOp, typename T_Expr>
+    MatrixView<T_Rows, T_Cols, T_Scalar, T_RowStride, T_ColStride>& update (
+        const T_Expr& kExpr)
+    {
+        if (kExpr.references (mPData, mPData + span))
+        {
+            const Matrix<T_Rows, T_Cols, Scalar_t> rhs (kExpr);
+            this->store<T_StoreOp> (rhs);
+        }
+        else
+        {
+            this->store<T_StoreOp> (kExpr);
+        }
+
+        return *this;
+    }
+};
+
+/**
+ * View of a T_Rows x T_Cols block of a row-major matrix with T_ParentCols
+ * columns.
+ */
+template <Dim_t T_Rows, Dim_t T_Cols, Dim_t T_ParentCols,
+          typename T_Scalar = Real_t>
+using BlockView = MatrixView<T_Rows, T_Cols, T_Scalar, T_ParentCols, 1>;
+
+/**
+ * Gets a view of the T_Rows x T_Cols block of a matrix whose top left element
+ * is (T_Row, T_Col).
+ *
+ * @param   kMat Viewed matrix.
+ *
+ * @ret     Block view.
+ */
+template <Dim_t T_Row, Dim_t T_Col, Dim_t T_Rows, Dim_t T_Cols,
+          Dim_t T_ParentRows, Dim_t T_ParentCols, typename T_Scalar>
+BlockView<T_Rows, T_Cols, T_ParentCols, T_Scalar> blockView (
+    Matrix<T_ParentRows, T_ParentCols, T_Scalar>& kMat)
+{
+    static_assert (T_Row + T_Rows <= T_ParentRows &&
+                   T_Col + T_Cols <= T_ParentCols,
+                   "block out of range");
+
+    return BlockView<T_Rows, T_Cols, T_ParentCols, T_Scalar> (
+        kMat.mData + T_ParentCols * T_Row + T_Col);
+}
+
+template <Dim_t T_Row, Dim_t T_Col, Dim_t T_Rows, Dim_t T_Cols,
+          Dim_t T_ParentRows, Dim_t T_ParentCols, typename T_Scalar>
+BlockView<T_Rows, T_Cols, T_ParentCols, const T_Scalar> blockView (
+    const Matrix<T_ParentRows, T_ParentCols, T_Scalar>& kMat)
+{
+    static_assert (T_Row + T_Rows <= T_ParentRows &&
+                   T_Col + T_Cols <= T_ParentCols,
+                   "block out of range");
+
+    return BlockView<T_Rows, T_Cols, T_ParentCols, const T_Scalar> (
+        kMat.mData + T_ParentCols * T_Row + T_Col);
+}
+
+/**
+ * Gets a 1 x N view of row T_Row of a matrix.
+ *
+ * @param   kMat Viewed matrix.
+ *
+ * @ret     Row view.
+ */
+template <Dim_t T_Row, Dim_t T_Rows, Dim_t T_Cols, typename T_Scalar>
+BlockView<1, T_Cols, T_Cols, T_Scalar> rowView (
+    Matrix<T_Rows, T_Cols, T_Scalar>& kMat)
+{
+    return blockView<T_Row, 0, 1, T_Cols> (kMat);
+}
+
+template <Dim_t T_Row, Dim_t T_Rows, Dim_t T_Cols, typename T_Scalar>
+BlockView<1, T_Cols, T_Cols, const T_Scalar> rowView (
+    const Matrix<T_Rows, T_Cols, T_Scalar>& kMat)
+{
+    return blockView<T_Row, 0, 1, T_Cols> (kMat);
+}
+
+/**
+ * Gets an N x 1 view of column T_Col of a matrix.
+ *
+ * @param   kMat Viewed matrix.
+ *
+ * @ret     Column view.
+ */
+template <Dim_t T_Col, Dim_t T_Rows, Dim_t T_Cols, typename T_Scalar>
+BlockView<T_Rows, 1, T_Cols, T_Scalar> columnView (
+    Matrix<T_Rows, T_Cols, T_Scalar>& kMat)
+{
+    return blockView<0, T_Col, T_Rows, 1> (kMat);
+}
+
+template <Dim_t T_Col, Dim_t T_Rows, Dim_t T_Cols, typename T_Scalar>
+BlockView<T_Rows, 1, T_Cols, const T_Scalar> columnView (
+    const Matrix<T_Rows, T_Cols, T_Scalar>& kMat)
+{
+    return blockView<0, T_Col, T_Rows, 1> (kMat);
+}
+
+/**
+ * Views and their transposes are cheap to index and are held by value in
+ * products.
+ */
+template <Dim_t T_Rows, Dim_t T_Cols, typename T_Scalar, uint32_t T_RowStride,
+          uint32_t T_ColStride>
+struct ProductOperand<
+    MatrixView<T_Rows, T_Cols, T_Scalar, T_RowStride, T_ColStride>, T_Rows,
+    T_Cols>
+{
+    typedef const MatrixView<T_Rows, T_Cols, T_Scalar, T_RowStride,
+                             T_ColStride> Type;
+};
+
+template <Dim_t T_Rows, Dim_t T_Cols, typename T_Scalar, uint32_t T_RowStride,
+          uint32_t T_ColStride>
+struct ProductOperand<
+    MatrixTranspose<
+        MatrixView<T_Cols, T_Rows, T_Scalar, T_RowStride, T_ColStride>, T_Rows,
+        T_Cols>,
+    T_Rows, T_Cols>
+{
+    typedef const MatrixTranspose<
+        MatrixView<T_Cols, T_Rows, T_Scalar, T_RowStride, T_ColStride>, T_Rows,
+        T_Cols> Type;
+};
+
+/**
+ * Destination-passing multiplication kernels with a view destination. See
+ * Matrix.hpp.
+ *
+ * WARNING: The destination must not overlap either operand.
+ */
+
+/**
+ * Evaluates lhs * rhs, or lhs * rhs^T if T_RhsTransposed, into the destination
+ * view with T_StoreOp.
+ *
+ * @param   kDst Destination view.
+ * @param   kLhs LHS expression.
+ * @param   kRhs RHS expression, untransposed.
+ */
+template <typename T_StoreOp, typename T_Lhs, typename T_Rhs, Dim_t T_Rows,
+          Dim_t T_Inner, Dim_t T_Cols, typename T_Scalar, uint32_t T_RowStride,
+          uint32_t T_ColStride>
+void multiplyKernel (
+    const MatrixView<T_Rows, T_Cols, T_Scalar, T_RowStride, T_ColStride> kDst,
+    const MatrixExpression<T_Lhs, T_Rows, T_Inner, T_Scalar>& kLhs,
+    const MatrixExpression<T_Rhs, T_Inner, T_Cols, T_Scalar>& kRhs)
+{
+    kDst.template store<T_StoreOp> (
+        MatrixProduct<T_Lhs, T_Rhs, T_Rows, T_Inner, T_Cols> (
+            kLhs.derived (), kRhs.derived ()));
+}
+
+template <typename T_StoreOp, typename T_Lhs, typename T_Rhs, Dim_t T_Rows,
+          Dim_t T_Inner, Dim_t T_Cols, typename T_Scalar, uint32_t T_RowStride,
+          uint32_t T_ColStride>
+void multiplyTransposedKernel (
+    const MatrixView<T_Rows, T_Cols, T_Scalar, T_RowStride, T_ColStride> kDst,
+    const MatrixExpression<T_Lhs, T_Rows, T_Inner, T_Scalar>& kLhs,
+    const MatrixExpression<T_Rhs, T_Cols, T_Inner, T_Scalar>& kRhs)
+{
+    typedef MatrixTranspose<T_Rhs, T_Inner, T_Cols> Transpose_t;
+    kDst.template store<T_StoreOp> (
+        MatrixProduct<T_Lhs, Transpose_t, T_Rows, T_Inner, T_Cols> (
+            kLhs.derived (), Transpose_t (kRhs.derived ())));
+}
+
+/**
+ * Computes dst = lhs * rhs.
+ *
+ * @param   kDst Destination view.
+ * @param   kLhs LHS expression.
+ * @param   kRhs RHS expression.
+ */
+template <typename T_Lhs, typename T_Rhs, Dim_t T_Rows, Dim_t T_Inner,
+          Dim_t T_Cols, typename T_Scalar, uint32_t T_RowStride,
+          uint32_t T_ColStride>
+void multiplyInto (
+    const MatrixView<T_Rows, T_Cols, T_Scalar, T_RowStride, T_ColStride> kDst,
+    const MatrixExpression<T_Lhs, T_Rows, T_Inner, T_Scalar>& kLhs,
+    const MatrixExpression<T_Rhs, T_Inner, T_Cols, T_Scalar>& kRhs)
+{
+    multiplyKernel<MatrixStoreOp> (kDst, kLhs, kRhs);
+}
+
+/**
+ * Computes dst += lhs * rhs.
+ *
+ * @param   kDst Destination view.
+ * @param   kLhs LHS expression.
+ * @param   kRhs RHS expression.
+ */
+template <typename T_Lhs, typename T_Rhs, Dim_t T_Rows, Dim_t T_Inner,
+          Dim_t T_Cols, typename T_Scalar, uint32_t T_RowStride,
+          uint32_t T_ColStride>
+void multiplyAddInto (
+    const MatrixView<T_Rows, T_Cols, T_Scalar, T_RowStride, T_ColStride> kDst,
+    const MatrixExpression<T_Lhs, T_Rows, T_Inner, T_Scalar>& kLhs,
+    const MatrixExpression<T_Rhs, T_Inner, T_Cols, T_Scalar>& kRhs)
+{
+    multiplyKernel<MatrixAddStoreOp> (kDst, kLhs, kRhs);
+}
+
+/**
+ * Computes dst -= lhs * rhs.
+ *
+ * @param   kDst Destination view.
+ * @param   kLhs LHS expression.
+ * @param   kRhs RHS expression.
+ */
+template <typename T_Lhs, typename T_Rhs, Dim_t T_Rows, Dim_t T_Inner,
+          Dim_t T_Cols, typename T_Scalar, uint32_t T_RowStride,
+          uint32_t T_ColStride>
+void multiplySubtractInto (
+    const MatrixView<T_Rows, T_Cols, T_Scalar, T_RowStride, T_ColStride> kDst,
+    const MatrixExpression<T_Lhs, T_Rows, T_Inner, T_Scalar>& kLhs,
+    const MatrixExpression<T_Rhs, T_Inner, T_Cols, T_Scalar>& kRhs)
+{
+    multiplyKernel<MatrixSubtractStoreOp> (kDst, kLhs, kRhs);
+}
+
+/**
+ * Computes dst = lhs * rhs^T without forming the transpose.
+ *
+ * @param   kDst Destination view.
+ * @param   kLhs LHS expression.
+ * @param   kRhs RHS expression (untransposed).
+ */
+template <typename T_Lhs, typename T_Rhs, Dim_t T_Rows, Dim_t T_Inner,
+          Dim_t T_Cols, typename T_Scalar, uint32_t T_RowStride,
+          uint32_t T_ColStride>
+void multiplyTransposedInto (
+    const MatrixView<T_Rows, T_Cols, T_Scalar, T_RowStride, T_ColStride> kDst,
+    const MatrixExpression<T_Lhs, T_Rows, T_Inner, T_Scalar>& kLhs,
+    const MatrixExpression<T_Rhs, T_Cols, T_Inner, T_Scalar>& kRhs)
+{
+    multiplyTransposedKernel<MatrixStoreOp> (kDst, kLhs, kRhs);
+}
+
+/**
+ * Computes dst += lhs * rhs^T without forming the transpose.
+ *
+ * @param   kDst Destination view.
+ * @param   kLhs LHS expression.
+ * @param   kRhs RHS expression (untransposed).
+ */
+template <typename T_Lhs, typename T_Rhs, Dim_t T_Rows, Dim_t T_Inner,
+          Dim_t T_Cols, typename T_Scalar, uint32_t T_RowStride,
+          uint32_t T_ColStride>
+void multiplyTransposedAddInto (
+    const MatrixView<T_Rows, T_Cols, T_Scalar, T_RowStride, T_ColStride> kDst,
+    const MatrixExpression<T_Lhs, T_Rows, T_Inner, T_Scalar>& kLhs,
+    const MatrixExpression<T_Rhs, T_Cols, T_Inner, T_Scalar>& kRhs)
+{
+    multiplyTransposedKernel<MatrixAddStoreOp> (kDst, kLhs, kRhs);
+}
+
+} // namespace Photic
+
+#endif
@@ -0,0 +1,358 @@
+/**
+ *                                 [PHOTIC]
+ *                                  v3.2.0
+ *
+ * This file is part of Photic, a collection of utilities for writing high-power
+ * rocket flight computer software. Developed in Austin, TX by the Longhorn
+ * Rocketry Association at the University of Texas at Austin.
+ *
+ *                            ---- THIS FILE ----
+ *
+ * A MedianHistory works like a History and also answers median and percentile
+ * queries over its elements. Medians are robust to outliers that ruin means,
+ * e.g. the pressure spikes seen at liftoff.
+ *
+ *                              ---- USAGE ----
+ *
+ *   (1) Create a MedianHistory. The template parameters are the same as
+ *       History.
+ *
+ *         Photic::MedianHistory<25> pressureHist;
+ *
+ *   (2) Add elements and query order statistics.
+ *
+ *         pressureHist.add (baro.getPressure ());
+ *         Real_t median = pressureHist.getMedian ();
+ *         Real_t p95 = pressureHist.getPercentile (95);
+ *
+ *                              ---- NOTES ----
+ *
+ *   (1) The elements are kept in order by a treap, a binary search tree
+ *       balanced by random node priorities, in which each node also stores
+ *       its subtree size. Node i is the element in ring buffer slot i, so
+ *       replacing the oldest element is one deletion and one insertion of the
+ *       same node. add and every query cost expected O(log T_Dim).
+ *
+ *   (2) The tree lives in fixed arrays of child links, subtree sizes and
+ *       priorities, so a MedianHistory takes T_Dim (3 sizeof (HistoryDim_t) +
+ *       2) bytes more than a History of the same capacity, e.g. 8 KB more for
+ *       T_Dim = 1000, and never allocates. Tree operations recurse to the
+ *       depth of the tree, which is expected O(log T_Dim).
+ *
+ *   (3) Percentiles interpolate linearly between the two closest ranks, so
+ *       the 50th percentile of an even number of elements is the mean of the
+ *       middle two. The median and percentiles of an empty history are
+ *       undefined.
+ *
+ *   (4) Only the History getters are public. add and clear must keep the tree
+ *       in step, so the History base is protected and cannot be used to
+ *       bypass them.
+ *
+ *   (5) NaN elements, e.g. from a sensor glitch, order after every number, so
+ *       they only reach the top percentiles. Any other placement would leave
+ *       the tree without a consistent order to search by.
+ */
+
+#ifndef PHOTIC_MEDIAN_HISTORY_HPP
+#define PHOTIC_MEDIAN_HISTORY_HPP
+
+#include "History.hpp"
+#include "Types.hpp"
+
+namespace Photic
+{
+
+template <HistoryDim_t T_Dim, typename T_Scalar = Real_t,
+          typename T_Accum = T_Scalar,
+          typename T_Storage = HistoryStorage<T_Scalar>>
+class MedianHistory : protected History<T_Dim, T_Scalar, T_Accum, T_Storage>
+{
+protected:
+    /**
+     * Link value for no node.
+     */
+    static constexpr HistoryDim_t NIL = T_Dim;
+
+    HistoryDim_t mLeft[T_Dim];     /* Left child of each node. */
+    HistoryDim_t mRight[T_Dim];    /* Right child of each node. */
+    HistoryDim_t mSize[T_Dim];     /* Size of each node's subtree. */
+    uint16_t     mPriority[T_Dim]; /* Heap priority of each node. */
+    HistoryDim_t mRoot;            /* Root node. */
+    uint16_t     mRandState;       /* Priority generator state. */
+
+    /**
+     * Gets if a node orders before another. Equal elements are ordered by
+     * slot so that every node has a unique key. See note (5).
+     *
+     * @param   kLhs LHS node.
+     * @param   kRhs RHS node.
+     *
+     * @ret     If kLhs orders before kRhs.
+     */
+    bool before (const HistoryDim_t kLhs, const HistoryDim_t kRhs) const
+    {
+        // Storage policies preserve order, so stored elements compare the same
+        // as the elements.
+        const typename History<T_Dim, T_Scalar, T_Accum, T_Storage>::Stored_t
+            lhs = this->mData[kLhs];
+        const typename History<T_Dim, T_Scalar, T_Accum, T_Storage>::Stored_t
+            rhs = this->mData[kRhs];
+        const bool lhsNan = lhs != lhs;
+        const bool rhsNan = rhs != rhs;
+        if (lhsNan || rhsNan)
+        {
+            return lhsNan == rhsNan ? kLhs < kRhs : rhsNan;
+        }
+        return lhs < rhs || (!(rhs < lhs) && kLhs < kRhs);
+    }
+
+    /**
+     * Gets the size of a subtree.
+     *
+     * @param   kNode Subtree root, possibly NIL.
+     *
+     * @ret     Number of nodes in subtree.
+     */
+    HistoryDim_t size (const HistoryDim_t kNode) const
+    {
+        return kNode == NIL ? 0 : mSize[kNode];
+    }
+
+    /**
+     * Recomputes a node's subtree size from its children.
+     *
+     * @param   kNode Node.
+     */
+    void update (const HistoryDim_t kNode)
+    {
+        mSize[kNode] = size (mLeft[kNode]) + size (mRight[kNode]) + 1;
+    }
+
+    /**
+     * Splits a subtree into the nodes ordering before a key node and the rest.
+     *
+     * @param   kTree  Subtree root.
+     * @param   kKey   Key node, not in the subtree.
+     * @param   kLower Set to the root of the nodes before kKey.
+     * @param   kUpper Set to the root of the nodes after kKey.
+     */
+    void split (const HistoryDim_t kTree, const HistoryDim_t kKey,
+                HistoryDim_t& kLower, HistoryDim_t& kUpper)
+    {
+        if (kTree == NIL)
+        {
+            kLower = NIL;
+            kUpper = NIL;
+        }
+        else if (this->before (kTree, kKey))
+        {
+            this->split (mRight[kTree], kKey, mRight[kTree], kUpper);
+            kLower = kTree;
+            this->update (kTree);
+        }
+        else
+        {
+            this->split (mLeft[kTree], kKey, kLower, mLeft[kTree]);
+            kUpper = kTree;
+            this->update (kTree);
+        }
+    }
+
+    /**
+     * Merges two subtrees where every node of the first orders before every
+     * node of the second.
+     *
+     * @param   kLower Lower subtree root.
+     * @param   kUpper Upper subtree root.
+     *
+     * @ret     Merged subtree root.
+     */
+    HistoryDim_t merge (const HistoryDim_t kLower, const HistoryDim_t kUpper)
+    {
+        if (kLower == NIL || kUpper == NIL)
+        {
+            return kLower == NIL ? kUpper : kLower;
+        }
+
+        if (mPriority[kLower] > mPriority[kUpper])
+        {
+            mRight[kLower] = this->merge (mRight[kLower], kUpper);
+            this->update (kLower);
+            return kLower;
+        }
+
+        mLeft[kUpper] = this->merge (kLower, mLeft[kUpper]);
+        this->update (kUpper);
+        return kUpper;
+    }
+
+    /**
+     * Inserts a node into a subtree.
+     *
+     * @param   kTree Subtree root.
+     * @param   kNode Node to insert, with its priority set.
+     *
+     * @ret     New subtree root.
+     */
+    HistoryDim_t insert (const HistoryDim_t kTree, const HistoryDim_t kNode)
+    {
+        if (kTree == NIL || mPriority[kNode] > mPriority[kTree])
+        {
+            this->split (kTree, kNode, mLeft[kNode], mRight[kNode]);
+            this->update (kNode);
+            return kNode;
+        }
+
+        if (this->before (kNode, kTree))
+        {
+            mLeft[kTree] = this->insert (mLeft[kTree], kNode);
+        }
+        else
+        {
+            mRight[kTree] = this->insert (mRight[kTree], kNode);
+        }
+        this->update (kTree);
+        return kTree;
+    }
+
+    /**
+     * Removes a node from a subtree.
+     *
+     * @param   kTree Subtree root.
+     * @param   kNode Node to remove, which must be in the subtree.
+     *
+     * @ret     New subtree root.
+     */
+    HistoryDim_t erase (const HistoryDim_t kTree, const HistoryDim_t kNode)
+    {
+        if (kTree == kNode)
+        {
+            return this->merge (mLeft[kNode], mRight[kNode]);
+        }
+
+        if (this->before (kNode, kTree))
+        {
+            mLeft[kTree] = this->erase (mLeft[kTree], kNode);
+        }
+        else
+        {
+            mRight[kTree] = this->erase (mRight[kTree], kNode);
+        }
+        this->update (kTree);
+        return kTree;
+    }
+
+    /**
+     * Gets the element with a given rank.
+     *
+     * @param   kRank Rank from 0, the smallest element.
+     *
+     * @ret     Element of rank kRank.
+     */
+    T_Scalar select (HistoryDim_t kRank) const
+    {
+        HistoryDim_t node = mRoot;
+        while (true)
+        {
+            const HistoryDim_t leftSize = this->size (mLeft[node]);
+            if (kRank < leftSize)
+            {
+                node = mLeft[node];
+            }
+            else if (kRank == leftSize)
+            {
+                return this->element (node);
+            }
+            else
+            {
+                kRank -= leftSize + 1;
+                node = mRight[node];
+            }
+        }
+    }
+
+public:
+    using History<T_Dim, T_Scalar, T_Accum, T_Storage>::getMean;
+    using History<T_Dim, T_Scalar, T_Accum, T_Storage>::getStdev;
+    using History<T_Dim, T_Scalar, T_Accum, T_Storage>::atCapacity;
+    using History<T_Dim, T_Scalar, T_Accum, T_Storage>::getSaturations;
+
+    /**
+     * Constructor.
+     *
+     * @param   kStorage Storage policy. See note (5) in History.hpp.
+     */
+    explicit MedianHistory (const T_Storage& kStorage = T_Storage ()) :
+        History<T_Dim, T_Scalar, T_Accum, T_Storage> (kStorage), mRoot (NIL),
+        mRandState (0xace1)
+    {}
+
+    /**
+     * Adds a new element to the history. If the history is at capacity, the
+     * oldest element is thrown out. See note (1).
+     *
+     * @param   kData New element.
+     */
+    void add (const T_Scalar kData)
+    {
+        const HistoryDim_t slot = this->mIdx;
+        if (this->atCapacity ())
+        {
+            mRoot = this->erase (mRoot, slot);
+        }
+
+        History<T_Dim, T_Scalar, T_Accum, T_Storage>::add (kData);
+
+        // 16-bit xorshift for the new node's priority.
+        mRandState ^= (uint16_t) (mRandState << 7);
+        mRandState ^= (uint16_t) (mRandState >> 9);
+        mRandState ^= (uint16_t) (mRandState << 8);
+        mPriority[slot] = mRandState;
+        mRoot = this->insert (mRoot, slot);
+    }
+
+    /**
+     * Gets a percentile of the elements in the history. See note (3).
+     *
+     * @param   kPercent Percentile in [0, 100].
+     *
+     * @ret     kPercent percentile.
+     */
+    T_Accum getPercentile (const T_Accum kPercent) const
+    {
+        const T_Accum pos = kPercent * (this->mCurrentSize - 1) / 100;
+        HistoryDim_t lower = (HistoryDim_t) pos;
+        lower = lower >= this->mCurrentSize ? this->mCurrentSize - 1 : lower;
+        const T_Accum frac = pos - lower;
+        const T_Accum lowerVal = this->select (lower);
+        if (frac > 0 && lower + 1 < this->mCurrentSize)
+        {
+            return lowerVal + frac * (this->select (lower + 1) - lowerVal);
+        }
+
+        return lowerVal;
+    }
+
+    /**
+     * Gets the median of the elements in the history. See note (3).
+     *
+     * @ret     History median.
+     */
+    T_Accum getMedian () const
+    {
+        return this->getPercentile (50);
+    }
+
+    /**
+     * Clears all elements from the history.
+     */
+    void clear ()
+    {
+        History<T_Dim, T_Scalar, T_Accum, T_Storage>::clear ();
+        mRoot = NIL;
+    }
+};
+
+} // namespace Photic
+
+#endif
@@ -0,0 +1,263 @@
+/**
+ *                                 [PHOTIC]
+ *                                  v3.2.0
+ *
+ * This file is part of Photic, a collection of utilities for writing high-power
+ * rocket flight computer software. Developed in Austin, TX by the Longhorn
+ * Rocketry Association at the University of Texas at Austin.
+ *
+ *                            ---- THIS FILE ----
+ *
+ * A MinMaxHistory works like a History and also tracks the minimum and
+ * maximum of its elements, e.g. the peak altitude over the last N samples for
+ * apogee detection or the lowest acceleration for burnout detection. Both are
+ * available in O(1) at any time for an amortized O(1) cost per add.
+ *
+ *                              ---- USAGE ----
+ *
+ *   (1) Create a MinMaxHistory. The template parameters are the same as
+ *       History.
+ *
+ *         Photic::MinMaxHistory<50> altHist;
+ *
+ *   (2) Add elements and query the window extrema alongside the mean and
+ *       standard deviation, e.g. wait until the altitude is clearly below its
+ *       recent peak.
+ *
+ *         altHist.add (baro.getAltitude ());
+ *         if (altHist.getMax () - altHist.getMean () > 10) { ... }
+ *
+ *                              ---- NOTES ----
+ *
+ *   (1) Each extremum is tracked with a monotonic deque of ring buffer slots:
+ *       the slots of the elements that could still become the extremum once
+ *       the older elements are evicted, ordered by age. The front of the deque
+ *       is the current extremum. An add evicts the front if its slot is being
+ *       overwritten, then pops every element the new one supersedes off the
+ *       back, so each element is pushed and popped at most once.
+ *
+ *   (2) The deques live in fixed arrays of T_Dim slot indices each, so a
+ *       MinMaxHistory takes 2 T_Dim sizeof (HistoryDim_t) bytes more than a
+ *       History of the same capacity and never allocates.
+ *
+ *   (3) The minimum and maximum of an empty history are undefined.
+ *
+ *   (4) The deques compare elements as stored. Storage policies preserve
+ *       order, so this is the same as comparing the elements.
+ *
+ *   (5) History is inherited protected, with its getters made public, since
+ *       its add and clear are not virtual: adding through a History reference
+ *       would skip the deques.
+ *
+ *   (6) NaN elements order after every number, as in MedianHistory, so a NaN
+ *       is the maximum while it is in the window and never the minimum unless
+ *       every element is NaN. Comparisons with NaN are otherwise all false,
+ *       which would let one NaN flush every older candidate from both deques.
+ */
+
+#ifndef PHOTIC_MIN_MAX_HISTORY_HPP
+#define PHOTIC_MIN_MAX_HISTORY_HPP
+
+#include "History.hpp"
+#include "Types.hpp"
+
+namespace Photic
+{
+
+/**
+ * Fixed-capacity deque of ring buffer slots whose elements are monotonic from
+ * front to back. The front holds the maximum when T_Max, else the minimum.
+ */
+template <HistoryDim_t T_Dim, bool T_Max>
+class HistoryMonotonicDeque
+{
+private:
+    HistoryDim_t mSlots[T_Dim]; /* Ring of slot indices, oldest first. */
+    HistoryDim_t mHead;         /* Index of front in mSlots. */
+    HistoryDim_t mCount;        /* Number of slots in deque. */
+
+    /**
+     * Gets if an element supersedes another as a candidate extremum.
+     *
+     * @param   kNew Newer element.
+     * @param   kOld Older element.
+     *
+     * @ret     If kOld can never be the extremum while kNew is in the window.
+     */
+    template <typename T_Scalar>
+    static bool supersedes (const T_Scalar kNew, const T_Scalar kOld)
+    {
+        return T_Max ? !orderedBefore (kNew, kOld) :
+                       !orderedBefore (kOld, kNew);
+    }
+
+    /**
+     * Gets if an element orders before another, with NaN after every number
+     * so that the order is total. See note (6) in MinMaxHistory.hpp.
+     *
+     * @param   kLhs LHS element.
+     * @param   kRhs RHS element.
+     *
+     * @ret     If kLhs orders before kRhs.
+     */
+    template <typename T_Scalar>
+    static bool orderedBefore (const T_Scalar kLhs, const T_Scalar kRhs)
+    {
+        return kLhs < kRhs || (kLhs == kLhs && kRhs != kRhs);
+    }
+
+    /**
+     * Gets the slot at a position in the deque.
+     *
+     * @param   kPos Position from the front.
+     *
+     * @ret     Slot index.
+     */
+    HistoryDim_t slot (const HistoryDim_t kPos) const
+    {
+        const uint32_t idx = (uint32_t) mHead + kPos;
+        return mSlots[idx >= T_Dim ? idx - T_Dim : idx];
+    }
+
+public:
+    /**
+     * Constructor.
+     */
+    HistoryMonotonicDeque () : mHead (0), mCount (0) {}
+
+    /**
+     * Adds the element just written to a slot.
+     *
+     * @param   kData Ring buffer the slot indexes, as stored.
+     * @param   kSlot Slot of the new element.
+     */
+    template <typename T_Scalar>
+    void push (const T_Scalar* const kData, const HistoryDim_t kSlot)
+    {
+        // Pop superseded elements off the back.
+        while (mCount > 0 &&
+               supersedes (kData[kSlot], kData[this->slot (mCount - 1)]))
+        {
+            mCount--;
+        }
+
+        const uint32_t back = (uint32_t) mHead + mCount;
+        mSlots[back >= T_Dim ? back - T_Dim : back] = kSlot;
+        mCount++;
+    }
+
+    /**
+     * Removes an element about to be overwritten, if it is still in the deque.
+     * Only the oldest element in the history is ever overwritten, so it can
+     * only be at the front.
+     *
+     * @param   kSlot Slot about to be overwritten.
+     */
+    void evict (const HistoryDim_t kSlot)
+    {
+        if (mCount > 0 && mSlots[mHead] == kSlot)
+        {
+            mHead = mHead + 1 >= T_Dim ? 0 : mHead + 1;
+            mCount--;
+        }
+    }
+
+    /**
+     * Gets the slot of the extremum.
+     *
+     * @ret     Slot of the front element.
+     */
+    HistoryDim_t front () const
+    {
+        return mSlots[mHead];
+    }
+
+    /**
+     * Empties the deque.
+     */
+    void clear ()
+    {
+        mHead = 0;
+        mCount = 0;
+    }
+};
+
+template <HistoryDim_t T_Dim, typename T_Scalar = Real_t,
+          typename T_Accum = T_Scalar,
+          typename T_Storage = HistoryStorage<T_Scalar>>
+class MinMaxHistory : protected History<T_Dim, T_Scalar, T_Accum, T_Storage>
+{
+protected:
+    HistoryMonotonicDeque<T_Dim, false> mMinDeque; /* Minimum candidates. */
+    HistoryMonotonicDeque<T_Dim, true>  mMaxDeque; /* Maximum candidates. */
+
+public:
+    using History<T_Dim, T_Scalar, T_Accum, T_Storage>::getMean;
+    using History<T_Dim, T_Scalar, T_Accum, T_Storage>::getStdev;
+    using History<T_Dim, T_Scalar, T_Accum, T_Storage>::atCapacity;
+    using History<T_Dim, T_Scalar, T_Accum, T_Storage>::getSaturations;
+
+    /**
+     * Constructor.
+     *
+     * @param   kStorage Storage policy. See note (5) in History.hpp.
+     */
+    explicit MinMaxHistory (const T_Storage& kStorage = T_Storage ()) :
+        History<T_Dim, T_Scalar, T_Accum, T_Storage> (kStorage)
+    {}
+
+    /**
+     * Adds a new element to the history. If the history is at capacity, the
+     * oldest element is thrown out. See note (1).
+     *
+     * @param   kData New element.
+     */
+    void add (const T_Scalar kData)
+    {
+        const HistoryDim_t slot = this->mIdx;
+        if (this->atCapacity ())
+        {
+            mMinDeque.evict (slot);
+            mMaxDeque.evict (slot);
+        }
+
+        History<T_Dim, T_Scalar, T_Accum, T_Storage>::add (kData);
+
+        mMinDeque.push (this->mData, slot);
+        mMaxDeque.push (this->mData, slot);
+    }
+
+    /**
+     * Gets the smallest element in the history. See note (3).
+     *
+     * @ret     History minimum.
+     */
+    T_Scalar getMin () const
+    {
+        return this->element (mMinDeque.front ());
+    }
+
+    /**
+     * Gets the largest element in the history. See note (3).
+     *
+     * @ret     History maximum.
+     */
+    T_Scalar getMax () const
+    {
+        return this->element (mMaxDeque.front ());
+    }
+
+    /**
+     * Clears all elements from the history.
+     */
+    void clear ()
+    {
+        History<T_Dim, T_Scalar, T_Accum, T_Storage>::clear ();
+        mMinDeque.clear ();
+        mMaxDeque.clear ();
+    }
+};
+
+} // namespace Photic
+
+#endif
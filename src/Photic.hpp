@@ -12,10 +12,29 @@
  */
 
 #include "BarometerInterface.hpp"
+#include "EwmaStats.hpp"
+#include "Fixed.hpp"
 #include "History.hpp"
 #include "IMUInterface.hpp"
 #include "KalmanFilter.hpp"
 #include "MathUtils.hpp"
 #include "Matrix.hpp"
+#include "MatrixBatch.hpp"
+#include "MatrixExpression.hpp"
+#include "MatrixFactorization.hpp"
+#include "MatrixLoop.hpp"
+#include "MatrixSimd.hpp"
+#include "MatrixView.hpp"
+#include "MedianHistory.hpp"
+#include "MinMaxHistory.hpp"
+#include "QuantileSketch.hpp"
+#include "Quaternion.hpp"
+#include "RegressionHistory.hpp"
 #include "RocketTracker.hpp"
-#include "Types.hpp"
\ No newline at end of file
+#include "SpscHistory.hpp"
+#include "StructuredMatrix.hpp"
+#include "SymmetricMatrix.hpp"
+#include "TieredHistory.hpp"
+#include "TimedHistory.hpp"
+#include "Types.hpp"
+#include "VectorHistory.hpp"
\ No newline at end of file
@@ -0,0 +1,363 @@
+/**
+ *                                 [PHOTIC]
+ *                                  v3.2.0
+ *
+ * This file is part of Photic, a collection of utilities for writing high-power
+ * rocket flight computer software. Developed in Austin, TX by the Longhorn
+ * Rocketry Association at the University of Texas at Austin.
+ *
+ *                            ---- THIS FILE ----
+ *
+ * A QuantileSketch estimates percentiles of an unbounded stream of elements in
+ * fixed memory, e.g. the p50, p95 and p99 of sensor noise over an hours-long
+ * pad wait. Sketches of separate streams merge into a sketch of the combined
+ * stream, e.g. to combine Monte Carlo threads.
+ *
+ *                              ---- USAGE ----
+ *
+ *   (1) Create a QuantileSketch. The template parameters are the number of
+ *       centroids and the number of elements buffered between compressions,
+ *       which together set the accuracy and memory, then the element type.
+ *
+ *         Photic::QuantileSketch<64> noiseSketch;
+ *
+ *   (2) Add elements.
+ *
+ *         noiseSketch.add (baro.getPressure () - pressureMean);
+ *
+ *   (3) Query percentiles.
+ *
+ *         Real_t p99 = noiseSketch.getPercentile (99);
+ *
+ *   (4) Merge sketches of other streams.
+ *
+ *         totalSketch.merge (threadSketch);
+ *
+ *                              ---- NOTES ----
+ *
+ *   (1) The sketch is a merging t-digest. It summarizes the elements as
+ *       centroids, each a mean and a count of consecutive elements in sorted
+ *       order. Centroids near the median cover many elements and centroids
+ *       near the extremes cover few, so tail percentiles are the most
+ *       accurate. The exact minimum and maximum are also kept.
+ *
+ *   (2) New elements are buffered as centroids of one element. When the
+ *       arrays are full, all centroids are heap sorted by mean in place and
+ *       adjacent centroids are combined while the combined centroid spans at
+ *       most 1 unit of the scale k (q) = delta asin (2 q - 1) / (2 pi), where
+ *       q is the fraction of elements before it. Any two adjacent centroids
+ *       then span more than 1 unit, so with delta = T_Centroids + T_Buffer - 3
+ *       at most T_Centroids + T_Buffer - 1 centroids remain. In practice about
+ *       half that remain, i.e. about T_Centroids with the default buffer, so
+ *       compression runs about once per T_Buffer adds and costs
+ *       O((T_Centroids + T_Buffer) log (T_Centroids + T_Buffer)).
+ *
+ *   (3) A sketch takes (T_Centroids + T_Buffer) (sizeof (T_Scalar) + 4)
+ *       bytes plus a few words, e.g. 1 KB for the defaults with float, and
+ *       never allocates. Counts are 32-bit.
+ *
+ *   (4) Percentiles interpolate linearly between centroid means, and between
+ *       the extreme centroids and the minimum and maximum. Percentiles of an
+ *       empty sketch are undefined.
+ */
+
+#ifndef PHOTIC_QUANTILE_SKETCH_HPP
+#define PHOTIC_QUANTILE_SKETCH_HPP
+
+#include <math.h>
+
+#include "Types.hpp"
+
+namespace Photic
+{
+
+template <uint16_t T_Centroids = 64, uint16_t T_Buffer = T_Centroids,
+          typename T_Scalar = Real_t>
+class QuantileSketch
+{
+    static_assert (T_Centroids >= 4, "Sketch needs at least 4 centroids");
+    static_assert (T_Buffer >= 1, "Sketch needs a buffer");
+
+protected:
+    /**
+     * Capacity of the centroid arrays, including the buffer.
+     */
+    static constexpr uint32_t CAPACITY = (uint32_t) T_Centroids + T_Buffer;
+
+    T_Scalar mMean[CAPACITY];   /* Centroid means. */
+    uint32_t mWeight[CAPACITY]; /* Centroid counts. */
+    uint32_t mSize;             /* Number of centroids in use. */
+    uint32_t mTotal;            /* Number of elements added. */
+    uint32_t mSorted;           /* Centroids known sorted and compressed. */
+    T_Scalar mMin;              /* Smallest element. */
+    T_Scalar mMax;              /* Largest element. */
+
+    /**
+     * Swaps two centroids.
+     *
+     * @param   kI First centroid.
+     * @param   kJ Second centroid.
+     */
+    void swap (const uint32_t kI, const uint32_t kJ)
+    {
+        const T_Scalar mean = mMean[kI];
+        const uint32_t weight = mWeight[kI];
+        mMean[kI] = mMean[kJ];
+        mWeight[kI] = mWeight[kJ];
+        mMean[kJ] = mean;
+        mWeight[kJ] = weight;
+    }
+
+    /**
+     * Restores the max-heap order of a subtree whose children are heaps.
+     *
+     * @param   kRoot Subtree root.
+     * @param   kEnd  Number of centroids in the heap.
+     */
+    void siftDown (uint32_t kRoot, const uint32_t kEnd)
+    {
+        while (2 * kRoot + 1 < kEnd)
+        {
+            uint32_t child = 2 * kRoot + 1;
+            if (child + 1 < kEnd && mMean[child] < mMean[child + 1])
+            {
+                child++;
+            }
+            if (!(mMean[kRoot] < mMean[child]))
+            {
+                return;
+            }
+            this->swap (kRoot, child);
+            kRoot = child;
+        }
+    }
+
+    /**
+     * Sorts and compresses the centroids. See note (2).
+     */
+    void compress ()
+    {
+        if (mSorted == mSize)
+        {
+            return;
+        }
+
+        // Heap sort by mean.
+        for (uint32_t i = mSize / 2; i-- > 0;)
+        {
+            this->siftDown (i, mSize);
+        }
+        for (uint32_t end = mSize; end-- > 1;)
+        {
+            this->swap (0, end);
+            this->siftDown (0, end);
+        }
+
+        // Combine adjacent centroids left to right, in place.
+        const T_Scalar total = mTotal;
+        const T_Scalar step = 2 * (T_Scalar) M_PI / (CAPACITY - 3);
+        uint32_t out = 0;
+        T_Scalar before = 0;
+        T_Scalar limit = this->weightLimit (0, step) * total;
+        for (uint32_t i = 1; i < mSize; i++)
+        {
+            const uint32_t combined = mWeight[out] + mWeight[i];
+            if (before + combined <= limit)
+            {
+                mMean[out] += (mMean[i] - mMean[out]) * mWeight[i] / combined;
+                mWeight[out] = combined;
+            }
+            else
+            {
+                before += mWeight[out];
+                limit = this->weightLimit (before / total, step) * total;
+                out++;
+                mMean[out] = mMean[i];
+                mWeight[out] = mWeight[i];
+            }
+        }
+        mSize = out + 1;
+        mSorted = mSize;
+    }
+
+    /**
+     * Gets the largest fraction of elements a centroid may end at.
+     *
+     * @param   kStart Fraction of elements before the centroid.
+     * @param   kStep  Change in asin (2 q - 1) per unit of scale.
+     *
+     * @ret     Fraction of elements.
+     */
+    static T_Scalar weightLimit (const T_Scalar kStart, const T_Scalar kStep)
+    {
+        const T_Scalar x = 2 * kStart - 1;
+        const T_Scalar angle = asin (x < -1 ? -1 : (x > 1 ? 1 : x)) + kStep;
+        return angle >= (T_Scalar) M_PI / 2 ? 1 : (sin (angle) + 1) / 2;
+    }
+
+    /**
+     * Adds a centroid, compressing first if the arrays are full.
+     *
+     * @param   kMean   Centroid mean.
+     * @param   kWeight Centroid count.
+     */
+    void append (const T_Scalar kMean, const uint32_t kWeight)
+    {
+        if (mSize == CAPACITY)
+        {
+            this->compress ();
+        }
+
+        mMean[mSize] = kMean;
+        mWeight[mSize] = kWeight;
+        mSize++;
+        mTotal += kWeight;
+    }
+
+public:
+    /**
+     * Constructor.
+     */
+    QuantileSketch () : mSize (0), mTotal (0), mSorted (0), mMin (0), mMax (0)
+    {}
+
+    /**
+     * Adds a new element to the sketch.
+     *
+     * @param   kData New element.
+     */
+    void add (const T_Scalar kData)
+    {
+        mMin = mTotal == 0 || kData < mMin ? kData : mMin;
+        mMax = mTotal == 0 || kData > mMax ? kData : mMax;
+        this->append (kData, 1);
+    }
+
+    /**
+     * Adds every element of another sketch to this one.
+     *
+     * @param   kOther Sketch to merge in.
+     */
+    void merge (const QuantileSketch& kOther)
+    {
+        if (kOther.mTotal == 0)
+        {
+            return;
+        }
+
+        mMin = mTotal == 0 || kOther.mMin < mMin ? kOther.mMin : mMin;
+        mMax = mTotal == 0 || kOther.mMax > mMax ? kOther.mMax : mMax;
+        for (uint32_t i = 0; i < kOther.mSize; i++)
+        {
+            this->append (kOther.mMean[i], kOther.mWeight[i]);
+        }
+    }
+
+    /**
+     * Gets a percentile of the elements. See note (4).
+     *
+     * @param   kPercent Percentile in [0, 100].
+     *
+     * @ret     Estimated kPercent percentile.
+     */
+    T_Scalar getPercentile (const T_Scalar kPercent)
+    {
+        this->compress ();
+
+        // The first and last elements are known exactly.
+        const T_Scalar total = mTotal;
+        const T_Scalar index = kPercent * total / 100;
+        if (index < 1)
+        {
+            return mMin;
+        }
+        if (index > total - 1)
+        {
+            return mMax;
+        }
+
+        // Between an extreme and the center of the extreme centroid.
+        const T_Scalar firstHalf = (T_Scalar) mWeight[0] / 2;
+        if (mWeight[0] > 2 && index < firstHalf)
+        {
+            return mMin + (index - 1) / (firstHalf - 1) * (mMean[0] - mMin);
+        }
+        const T_Scalar lastHalf = (T_Scalar) mWeight[mSize - 1] / 2;
+        if (mWeight[mSize - 1] > 2 && total - index < lastHalf)
+        {
+            return mMax - (total - index - 1) / (lastHalf - 1) *
+                          (mMax - mMean[mSize - 1]);
+        }
+
+        // Between the centers of adjacent centroids.
+        T_Scalar center = firstHalf;
+        for (uint32_t i = 0; i + 1 < mSize; i++)
+        {
+            const T_Scalar gap =
+                (T_Scalar) (mWeight[i] + mWeight[i + 1]) / 2;
+            if (center + gap > index)
+            {
+                const T_Scalar frac = index < center ?
+                    0 : (index - center) / gap;
+                return mMean[i] + frac * (mMean[i + 1] - mMean[i]);
+            }
+            center += gap;
+        }
+
+        return mMean[mSize - 1];
+    }
+
+    /**
+     * Gets the median of the elements. See note (4).
+     *
+     * @ret     Estimated median.
+     */
+    T_Scalar getMedian ()
+    {
+        return this->getPercentile (50);
+    }
+
+    /**
+     * Gets the smallest element.
+     *
+     * @ret     Minimum.
+     */
+    T_Scalar getMin () const
+    {
+        return mMin;
+    }
+
+    /**
+     * Gets the largest element.
+     *
+     * @ret     Maximum.
+     */
+    T_Scalar getMax () const
+    {
+        return mMax;
+    }
+
+    /**
+     * Gets the number of elements added, including merged sketches.
+     *
+     * @ret     Number of elements.
+     */
+    uint32_t getCount () const
+    {
+        return mTotal;
+    }
+
+    /**
+     * Clears all elements from the sketch.
+     */
+    void clear ()
+    {
+        mSize = 0;
+        mTotal = 0;
+        mSorted = 0;
+    }
+};
+
+} // namespace Photic
+
+#endif
@@ -0,0 +1,452 @@
+/**
+ *                                 [PHOTIC]
+ *                                  v3.2.0
+ *
+ * This file is part of Photic, a collection of utilities for writing high-power
+ * rocket flight computer software. Developed in Austin, TX by the Longhorn
+ * Rocketry Association at the University of Texas at Austin.
+ *
+ *                            ---- THIS FILE ----
+ *
+ * Attitude quaternion ordered <w, x, y, z>, stored as a Matrix<4, 1> so that
+ * it can be passed anywhere a quaternion vector is expected, e.g.
+ * MathUtils::rotateVector or IMUInterface readings.
+ *
+ *                              ---- USAGE ----
+ *
+ *   (1) Make a quaternion, e.g. from an IMU reading or Euler angles.
+ *
+ *         Photic::Quaternion q (imu.getQuaternionOrientation ());
+ *         Photic::Quaternion r = Photic::Quaternion::fromEuler (0, 0.1, 0);
+ *
+ *   (2) Compose, invert and propagate attitudes.
+ *
+ *         Photic::Quaternion qr = q * r;
+ *         Photic::Quaternion qInv = q.conjugate ();
+ *         q.integrateSecondOrder (gyroRates, dt);
+ *
+ *   (3) Rotate vectors from the body frame into the world frame. To rotate
+ *       many vectors by the same attitude, compute the rotation matrix once.
+ *
+ *         Photic::Vector3_t world = q.rotate (bodyVec);
+ *
+ *         const Photic::Matrix<3, 3> rot = q.toRotationMatrix ();
+ *         for (...)
+ *         {
+ *             world = rot * bodyVecs[i];
+ *         }
+ *
+ *                              ---- NOTES ----
+ *
+ *   (1) A quaternion represents the rotation from the body frame to the world
+ *       frame, the same convention as MathUtils::rotateVector. Rotations,
+ *       rotation matrices and Euler angles are only correct for unit
+ *       quaternions. normalize () uses MathUtils::Fast::invSqrt, so the
+ *       squared norm of a normalized quaternion is within 1e-5 of 1.
+ *
+ *   (2) Euler angles are <roll, pitch, yaw> in radians, applied in yaw, pitch,
+ *       roll order about the z, y and x axes, i.e. R = Rz (yaw) Ry (pitch)
+ *       Rx (roll).
+ *
+ *   (3) Body rates are in radians per second about the body x, y and z axes.
+ *       First-order integration is q * <1, w dt / 2>. Second-order integration
+ *       adds the second-order term of the exact rotation for a constant rate,
+ *       q * <1 - |w dt|^2 / 8, w dt / 2>, which is more accurate for large
+ *       rotations per step at the cost of a few multiplies. Both normalize the
+ *       result.
+ *
+ *   (4) Quaternion is over Real_t. BasicQuaternion can be instantiated over
+ *       another scalar type, e.g. BasicQuaternion<double>.
+ */
+
+#ifndef PHOTIC_QUATERNION_HPP
+#define PHOTIC_QUATERNION_HPP
+
+#include <math.h>
+
+#include "MathUtils.hpp"
+#include "Matrix.hpp"
+#include "Types.hpp"
+
+namespace Photic
+{
+
+template <typename T_Scalar>
+class BasicQuaternion final
+{
+public:
+    /**
+     * Default constructor does nothing.
+     *
+     * WARNING: Quaternion may be filled with garbage.
+     */
+    BasicQuaternion () {}
+
+    /**
+     * Constructor from components.
+     *
+     * @param   kW Scalar component.
+     * @param   kX X component.
+     * @param   kY Y component.
+     * @param   kZ Z component.
+     */
+    BasicQuaternion (const T_Scalar kW, const T_Scalar kX, const T_Scalar kY,
+                     const T_Scalar kZ) :
+        mVec (MathUtils::makeVector4<T_Scalar> (kW, kX, kY, kZ)) {}
+
+    /**
+     * Constructor from a vector ordered <w, x, y, z>.
+     *
+     * @param   kVec Quaternion vector.
+     */
+    explicit BasicQuaternion (const Matrix<4, 1, T_Scalar>& kVec) :
+        mVec (kVec) {}
+
+    /**
+     * Gets the identity rotation.
+     *
+     * @ret     Identity quaternion.
+     */
+    static BasicQuaternion<T_Scalar> identity ()
+    {
+        return BasicQuaternion<T_Scalar> (1, 0, 0, 0);
+    }
+
+    /**
+     * Makes a unit quaternion from a rotation matrix using Shepperd's method,
+     * which divides by the largest of the four possible denominators.
+     *
+     * @param   kRot Rotation matrix from the body frame to the world frame.
+     *
+     * @ret     Quaternion.
+     */
+    template <typename T_Expr>
+    static BasicQuaternion<T_Scalar> fromRotationMatrix (
+        const MatrixExpression<T_Expr, 3, 3, T_Scalar>& kRot)
+    {
+        const Matrix<3, 3, T_Scalar> r = kRot;
+        const T_Scalar trace = r (0, 0) + r (1, 1) + r (2, 2);
+
+        if (trace > 0)
+        {
+            const T_Scalar s = 2 * sqrt (trace + 1);
+            const T_Scalar sInv = (T_Scalar) 1 / s;
+            return BasicQuaternion<T_Scalar> (
+                (T_Scalar) 0.25 * s, (r (2, 1) - r (1, 2)) * sInv,
+                (r (0, 2) - r (2, 0)) * sInv, (r (1, 0) - r (0, 1)) * sInv);
+        }
+        else if (r (0, 0) > r (1, 1) && r (0, 0) > r (2, 2))
+        {
+            const T_Scalar s = 2 * sqrt (1 + r (0, 0) - r (1, 1) - r (2, 2));
+            const T_Scalar sInv = (T_Scalar) 1 / s;
+            return BasicQuaternion<T_Scalar> (
+                (r (2, 1) - r (1, 2)) * sInv, (T_Scalar) 0.25 * s,
+                (r (0, 1) + r (1, 0)) * sInv, (r (0, 2) + r (2, 0)) * sInv);
+        }
+        else if (r (1, 1) > r (2, 2))
+        {
+            const T_Scalar s = 2 * sqrt (1 + r (1, 1) - r (0, 0) - r (2, 2));
+            const T_Scalar sInv = (T_Scalar) 1 / s;
+            return BasicQuaternion<T_Scalar> (
+                (r (0, 2) - r (2, 0)) * sInv, (r (0, 1) + r (1, 0)) * sInv,
+                (T_Scalar) 0.25 * s, (r (1, 2) + r (2, 1)) * sInv);
+        }
+
+        const T_Scalar s = 2 * sqrt (1 + r (2, 2) - r (0, 0) - r (1, 1));
+        const T_Scalar sInv = (T_Scalar) 1 / s;
+        return BasicQuaternion<T_Scalar> (
+            (r (1, 0) - r (0, 1)) * sInv, (r (0, 2) + r (2, 0)) * sInv,
+            (r (1, 2) + r (2, 1)) * sInv, (T_Scalar) 0.25 * s);
+    }
+
+    /**
+     * Makes a unit quaternion from Euler angles. See note (2).
+     *
+     * @param   kRoll  Rotation about x.
+     * @param   kPitch Rotation about y.
+     * @param   kYaw   Rotation about z.
+     *
+     * @ret     Quaternion.
+     */
+    static BasicQuaternion<T_Scalar> fromEuler (const T_Scalar kRoll,
+                                                const T_Scalar kPitch,
+                                                const T_Scalar kYaw)
+    {
+        const T_Scalar cr = cos ((T_Scalar) 0.5 * kRoll);
+        const T_Scalar sr = sin ((T_Scalar) 0.5 * kRoll);
+        const T_Scalar cp = cos ((T_Scalar) 0.5 * kPitch);
+        const T_Scalar sp = sin ((T_Scalar) 0.5 * kPitch);
+        const T_Scalar cy = cos ((T_Scalar) 0.5 * kYaw);
+        const T_Scalar sy = sin ((T_Scalar) 0.5 * kYaw);
+
+        return BasicQuaternion<T_Scalar> (cr * cp * cy + sr * sp * sy,
+                                          sr * cp * cy - cr * sp * sy,
+                                          cr * sp * cy + sr * cp * sy,
+                                          cr * cp * sy - sr * sp * cy);
+    }
+
+    /**
+     * Component accessors.
+     *
+     * @ret     Component.
+     */
+    T_Scalar w () const
+    {
+        return mVec[0];
+    }
+
+    T_Scalar x () const
+    {
+        return mVec[1];
+    }
+
+    T_Scalar y () const
+    {
+        return mVec[2];
+    }
+
+    T_Scalar z () const
+    {
+        return mVec[3];
+    }
+
+    /**
+     * Gets the underlying vector ordered <w, x, y, z>.
+     *
+     * @ret     Quaternion vector.
+     */
+    const Matrix<4, 1, T_Scalar>& vector () const
+    {
+        return mVec;
+    }
+
+    /**
+     * Gets the squared norm.
+     *
+     * @ret     w^2 + x^2 + y^2 + z^2.
+     */
+    T_Scalar squaredNorm () const
+    {
+        return mVec[0] * mVec[0] + mVec[1] * mVec[1] + mVec[2] * mVec[2] +
+               mVec[3] * mVec[3];
+    }
+
+    /**
+     * Scales the quaternion to unit norm in place. See note (1).
+     *
+     * WARNING: The quaternion must not be zero.
+     */
+    void normalize ()
+    {
+        mVec *= MathUtils::Fast::invSqrt (this->squaredNorm ());
+    }
+
+    /**
+     * Gets the quaternion scaled to unit norm. See note (1).
+     *
+     * @ret     Normalized quaternion.
+     */
+    BasicQuaternion<T_Scalar> normalized () const
+    {
+        BasicQuaternion<T_Scalar> quat = *this;
+        quat.normalize ();
+        return quat;
+    }
+
+    /**
+     * Gets the conjugate, which is the inverse rotation of a unit quaternion.
+     *
+     * @ret     Conjugate quaternion.
+     */
+    BasicQuaternion<T_Scalar> conjugate () const
+    {
+        return BasicQuaternion<T_Scalar> (mVec[0], -mVec[1], -mVec[2],
+                                          -mVec[3]);
+    }
+
+    /**
+     * Computes the Hamilton product. The result rotates by the RHS and then
+     * by the LHS.
+     *
+     * @param   kRhs RHS quaternion.
+     *
+     * @ret     Product quaternion.
+     */
+    BasicQuaternion<T_Scalar> operator* (
+        const BasicQuaternion<T_Scalar>& kRhs) const
+    {
+        const T_Scalar pw = mVec[0];
+        const T_Scalar px = mVec[1];
+        const T_Scalar py = mVec[2];
+        const T_Scalar pz = mVec[3];
+        const T_Scalar qw = kRhs.mVec[0];
+        const T_Scalar qx = kRhs.mVec[1];
+        const T_Scalar qy = kRhs.mVec[2];
+        const T_Scalar qz = kRhs.mVec[3];
+
+        return BasicQuaternion<T_Scalar> (
+            pw * qw - px * qx - py * qy - pz * qz,
+            pw * qx + px * qw + py * qz - pz * qy,
+            pw * qy - px * qz + py * qw + pz * qx,
+            pw * qz + px * qy - py * qx + pz * qw);
+    }
+
+    /**
+     * Gets the rotation matrix from the body frame to the world frame. See
+     * note (1).
+     *
+     * @ret     Rotation matrix.
+     */
+    Matrix<3, 3, T_Scalar> toRotationMatrix () const
+    {
+        const T_Scalar w = mVec[0];
+        const T_Scalar x = mVec[1];
+        const T_Scalar y = mVec[2];
+        const T_Scalar z = mVec[3];
+        const T_Scalar xx = x * x;
+        const T_Scalar yy = y * y;
+        const T_Scalar zz = z * z;
+
+        return MathUtils::makeMatrix3<T_Scalar> (
+            1 - 2 * (yy + zz), 2 * (x * y - w * z), 2 * (x * z + w * y),
+            2 * (x * y + w * z), 1 - 2 * (xx + zz), 2 * (y * z - w * x),
+            2 * (x * z - w * y), 2 * (y * z + w * x), 1 - 2 * (xx + yy));
+    }
+
+    /**
+     * Gets the Euler angles of the rotation. See notes (1) and (2). Pitch is
+     * in [-pi/2, pi/2]; at exactly +/-pi/2 roll and yaw are not unique.
+     *
+     * @ret     Euler angles <roll, pitch, yaw>.
+     */
+    Matrix<3, 1, T_Scalar> toEuler () const
+    {
+        T_Scalar terms[5];
+        eulerTerms (terms);
+        return MathUtils::makeVector3<T_Scalar> (atan2 (terms[0], terms[1]),
+                                                 asin (terms[2]),
+                                                 atan2 (terms[3], terms[4]));
+    }
+
+    /**
+     * Gets the Euler angles of the rotation like toEuler, using the
+     * MathUtils::Fast approximations of atan2 and asin. Each angle is within
+     * 1.5e-5 rad of toEuler for float quaternions.
+     *
+     * @ret     Euler angles <roll, pitch, yaw>.
+     */
+    Matrix<3, 1, T_Scalar> toEulerFast () const
+    {
+        T_Scalar terms[5];
+        eulerTerms (terms);
+        return MathUtils::makeVector3<T_Scalar> (
+            MathUtils::Fast::atan2 (terms[0], terms[1]),
+            MathUtils::Fast::asin (terms[2]),
+            MathUtils::Fast::atan2 (terms[3], terms[4]));
+    }
+
+    /**
+     * Rotates a vector from the body frame to the world frame. See note (1).
+     *
+     * @param   kVec Vector to rotate.
+     *
+     * @ret     Rotated vector.
+     */
+    template <typename T_Expr>
+    Matrix<3, 1, T_Scalar> rotate (
+        const MatrixExpression<T_Expr, 3, 1, T_Scalar>& kVec) const
+    {
+        return MathUtils::rotateVector (mVec, kVec);
+    }
+
+    /**
+     * Propagates the attitude by body rates over a timestep with first-order
+     * integration. See note (3).
+     *
+     * @param   kRates Body rates.
+     * @param   kDt    Timestep.
+     */
+    template <typename T_Expr>
+    void integrateFirstOrder (
+        const MatrixExpression<T_Expr, 3, 1, T_Scalar>& kRates,
+        const T_Scalar kDt)
+    {
+        this->integrate (kRates, kDt, 1);
+    }
+
+    /**
+     * Propagates the attitude by body rates over a timestep with second-order
+     * integration. See note (3).
+     *
+     * @param   kRates Body rates.
+     * @param   kDt    Timestep.
+     */
+    template <typename T_Expr>
+    void integrateSecondOrder (
+        const MatrixExpression<T_Expr, 3, 1, T_Scalar>& kRates,
+        const T_Scalar kDt)
+    {
+        const T_Scalar ax = kRates (0, 0) * kDt;
+        const T_Scalar ay = kRates (1, 0) * kDt;
+        const T_Scalar az = kRates (2, 0) * kDt;
+        this->integrate (kRates, kDt,
+                         1 - (T_Scalar) 0.125 * (ax * ax + ay * ay + az * az));
+    }
+
+private:
+    Matrix<4, 1, T_Scalar> mVec; /* Components <w, x, y, z>. */
+
+    /**
+     * Right-multiplies by the rotation increment <kW, rates dt / 2> and
+     * normalizes.
+     *
+     * @param   kRates Body rates.
+     * @param   kDt    Timestep.
+     * @param   kW     Scalar component of the increment.
+     */
+    template <typename T_Expr>
+    void integrate (const MatrixExpression<T_Expr, 3, 1, T_Scalar>& kRates,
+                    const T_Scalar kDt, const T_Scalar kW)
+    {
+        const T_Scalar halfDt = (T_Scalar) 0.5 * kDt;
+        *this = *this * BasicQuaternion<T_Scalar> (kW,
+                                                   kRates (0, 0) * halfDt,
+                                                   kRates (1, 0) * halfDt,
+                                                   kRates (2, 0) * halfDt);
+        this->normalize ();
+    }
+
+    /**
+     * Computes the arguments of the inverse trigonometric functions giving the
+     * Euler angles.
+     *
+     * @param   kTerms Roll atan2 arguments, clamped pitch sine and yaw atan2
+     *                 arguments, in that order.
+     */
+    void eulerTerms (T_Scalar (&kTerms)[5]) const
+    {
+        const T_Scalar w = mVec[0];
+        const T_Scalar x = mVec[1];
+        const T_Scalar y = mVec[2];
+        const T_Scalar z = mVec[3];
+
+        // Clamp the pitch sine, which can exceed 1 by rounding.
+        T_Scalar sinPitch = 2 * (w * y - z * x);
+        sinPitch = sinPitch > 1 ? 1 : (sinPitch < -1 ? -1 : sinPitch);
+
+        kTerms[0] = 2 * (w * x + y * z);
+        kTerms[1] = 1 - 2 * (x * x + y * y);
+        kTerms[2] = sinPitch;
+        kTerms[3] = 2 * (w * z + x * y);
+        kTerms[4] = 1 - 2 * (y * y + z * z);
+    }
+};
+
+/**
+ * Quaternion over the default scalar type. See usage instructions above.
+ */
+typedef BasicQuaternion<Real_t> Quaternion;
+
+} // namespace Photic
+
+#endif
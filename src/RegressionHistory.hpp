@@ -0,0 +1,262 @@
+/**
+ *                                 [PHOTIC]
+ *                                  v3.2.0
+ *
+ * This file is part of Photic, a collection of utilities for writing high-power
+ * rocket flight computer software. Developed in Austin, TX by the Longhorn
+ * Rocketry Association at the University of Texas at Austin.
+ *
+ *                            ---- THIS FILE ----
+ *
+ * A RegressionHistory works like a History and also fits a line, and
+ * optionally a parabola, to its elements by least squares. The slope of the
+ * fit is a much less noisy trend than the difference of two means, e.g. for
+ * apogee detection once the altitude trend turns negative or burnout detection
+ * once the acceleration trend does.
+ *
+ *                              ---- USAGE ----
+ *
+ *   (1) Create a RegressionHistory. The template parameters are the same as
+ *       History.
+ *
+ *         Photic::RegressionHistory<20> altHist;
+ *
+ *   (2) Add elements and act on the fit. The fit is over sample index, so
+ *       multiply by the sample rate for units per second.
+ *
+ *         altHist.add (baro.getAltitude ());
+ *         Real_t vertVel = altHist.getSlope () * sampleRateHz;
+ *         if (altHist.atCapacity () && vertVel < 0) { ... }
+ *
+ *                              ---- NOTES ----
+ *
+ *   (1) The fit is over the age u of each element in samples, 0 for the
+ *       newest, and reported over time, so getSlope is in element units per
+ *       sample and getIntercept is the fitted value at the newest element,
+ *       i.e. a smoothed current value. Elements are assumed evenly spaced.
+ *
+ *   (2) Besides the running sums History keeps, RegressionHistory keeps
+ *       Sigma(u (x - shift)) and Sigma(u^2 (x - shift)). The sums of u, u^2,
+ *       u^3 and u^4 depend only on the number of elements and are computed in
+ *       closed form. Each add ages every element by one sample, which updates
+ *       the weighted sums from the unweighted ones in O(1), so every fit costs
+ *       O(1). As in History, the sums are recomputed exactly each time the
+ *       ring buffer index wraps.
+ *
+ *   (3) The fits are computed about the mean age, where the normal equations
+ *       decouple, to limit cancellation. For large windows of float elements,
+ *       the quadratic fit still benefits from a double accumulator, e.g.
+ *       RegressionHistory<1000, float, double>.
+ *
+ *   (4) The slope, residual and curvature are 0 when there are too few
+ *       elements to fit, i.e. fewer than 2 for a line or 3 for a parabola.
+ *       The intercept of an empty history is undefined.
+ *
+ *   (5) The History base is protected so that the weighted sums cannot be
+ *       bypassed by adding through a History reference. The History getters
+ *       are public as in History.
+ */
+
+#ifndef PHOTIC_REGRESSION_HISTORY_HPP
+#define PHOTIC_REGRESSION_HISTORY_HPP
+
+#include <math.h>
+
+#include "History.hpp"
+#include "Types.hpp"
+
+namespace Photic
+{
+
+template <HistoryDim_t T_Dim, typename T_Scalar = Real_t,
+          typename T_Accum = T_Scalar,
+          typename T_Storage = HistoryStorage<T_Scalar>>
+class RegressionHistory :
+    protected History<T_Dim, T_Scalar, T_Accum, T_Storage>
+{
+protected:
+    T_Accum mSigmaUX;    /* Running Sigma(u (x - shift)). */
+    T_Accum mSigmaUSqrX; /* Running Sigma(u^2 (x - shift)). */
+
+    /**
+     * Recomputes the weighted running sums exactly from the elements in the
+     * history, with the shift History chose.
+     */
+    void computeWeightedSums ()
+    {
+        mSigmaUX = 0;
+        mSigmaUSqrX = 0;
+        HistoryDim_t slot = this->mIdx;
+        for (HistoryDim_t u = 0; u < this->mCurrentSize; u++)
+        {
+            slot = slot == 0 ? T_Dim - 1 : slot - 1;
+            const T_Accum x = this->element (slot) - this->mShift;
+            mSigmaUX += u * x;
+            mSigmaUSqrX += (T_Accum) u * u * x;
+        }
+    }
+
+    /**
+     * Gets the linear fit slope over age and the sum of the weights about the
+     * mean age.
+     *
+     * @param   kS2 Set to Sigma((u - mean u)^2).
+     *
+     * @ret     Slope over age.
+     */
+    T_Accum ageSlope (T_Accum& kS2) const
+    {
+        const T_Accum n = this->mCurrentSize;
+        const T_Accum meanU = (n - 1) / 2;
+        kS2 = n * (n * n - 1) / 12;
+        return (mSigmaUX - meanU * this->mSigmaX) / kS2;
+    }
+
+public:
+    using History<T_Dim, T_Scalar, T_Accum, T_Storage>::getMean;
+    using History<T_Dim, T_Scalar, T_Accum, T_Storage>::getStdev;
+    using History<T_Dim, T_Scalar, T_Accum, T_Storage>::atCapacity;
+    using History<T_Dim, T_Scalar, T_Accum, T_Storage>::getSaturations;
+
+    /**
+     * Constructor.
+     *
+     * @param   kStorage Storage policy. See note (5) in History.hpp.
+     */
+    explicit RegressionHistory (const T_Storage& kStorage = T_Storage ()) :
+        History<T_Dim, T_Scalar, T_Accum, T_Storage> (kStorage),
+        mSigmaUX (0), mSigmaUSqrX (0)
+    {}
+
+    /**
+     * Adds a new element to the history. If the history is at capacity, the
+     * oldest element is thrown out. See note (2).
+     *
+     * @param   kData New element.
+     */
+    void add (const T_Scalar kData)
+    {
+        // Remove the oldest element, at age n - 1, and sum the rest.
+        T_Accum rest = this->mSigmaX;
+        if (this->atCapacity ())
+        {
+            const T_Accum oldest = this->element (this->mIdx) - this->mShift;
+            const T_Accum u = T_Dim - 1;
+            mSigmaUX -= u * oldest;
+            mSigmaUSqrX -= u * u * oldest;
+            rest -= oldest;
+        }
+
+        // Age the rest by one sample: Sigma((u + 1)^2 x) = Sigma(u^2 x) +
+        // 2 Sigma(u x) + Sigma(x). The new element is at age 0, so adds
+        // nothing to either weighted sum.
+        mSigmaUSqrX += 2 * mSigmaUX + rest;
+        mSigmaUX += rest;
+
+        History<T_Dim, T_Scalar, T_Accum, T_Storage>::add (kData);
+
+        // History recomputed its sums with a new shift when the index wrapped.
+        if (this->mIdx == 0)
+        {
+            this->computeWeightedSums ();
+        }
+    }
+
+    /**
+     * Gets the slope of the least squares line. See note (1).
+     *
+     * @ret     Slope in element units per sample.
+     */
+    T_Accum getSlope () const
+    {
+        if (this->mCurrentSize < 2)
+        {
+            return 0;
+        }
+
+        T_Accum s2;
+        return -this->ageSlope (s2);
+    }
+
+    /**
+     * Gets the value of the least squares line at the newest element. See
+     * note (1).
+     *
+     * @ret     Fitted current value.
+     */
+    T_Accum getIntercept () const
+    {
+        const T_Accum n = this->mCurrentSize;
+        const T_Accum mean = this->mSigmaX / n;
+        if (this->mCurrentSize < 2)
+        {
+            return this->mShift + mean;
+        }
+
+        T_Accum s2;
+        return this->mShift + mean - this->ageSlope (s2) * (n - 1) / 2;
+    }
+
+    /**
+     * Gets the root mean square residual of the least squares line, i.e. the
+     * standard deviation of the elements about the line.
+     *
+     * @ret     RMS residual.
+     */
+    T_Accum getResidual () const
+    {
+        if (this->mCurrentSize < 2)
+        {
+            return 0;
+        }
+
+        const T_Accum n = this->mCurrentSize;
+        T_Accum s2;
+        const T_Accum b = this->ageSlope (s2);
+        const T_Accum sse = this->mSigmaXSqr -
+                            this->mSigmaX * this->mSigmaX / n - b * b * s2;
+        return sse > 0 ? sqrt (sse / n) : 0;
+    }
+
+    /**
+     * Gets the second derivative of the least squares parabola. See note (3).
+     *
+     * @ret     Curvature in element units per sample squared.
+     */
+    T_Accum getCurvature () const
+    {
+        if (this->mCurrentSize < 3)
+        {
+            return 0;
+        }
+
+        // About the mean age m, x = a + b (u - m) + c (u - m)^2 decouples b
+        // from a and c, leaving a 2x2 system in a and c.
+        const T_Accum n = this->mCurrentSize;
+        const T_Accum m = (n - 1) / 2;
+        const T_Accum s2 = n * (n * n - 1) / 12;
+        const T_Accum s4 = n * (n * n - 1) * (3 * n * n - 7) / 240;
+        const T_Accum s2x =
+            mSigmaUSqrX - 2 * m * mSigmaUX + m * m * this->mSigmaX;
+        const T_Accum c =
+            (n * s2x - s2 * this->mSigmaX) / (n * s4 - s2 * s2);
+
+        // Age and time differ in sign, which the second derivative does not
+        // see.
+        return 2 * c;
+    }
+
+    /**
+     * Clears all elements from the history.
+     */
+    void clear ()
+    {
+        History<T_Dim, T_Scalar, T_Accum, T_Storage>::clear ();
+        mSigmaUX = 0;
+        mSigmaUSqrX = 0;
+    }
+};
+
+} // namespace Photic
+
+#endif
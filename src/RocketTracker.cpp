@@ -10,6 +10,9 @@
 #include "RocketTracker.hpp"
 #include "History.hpp"
 #include "MathUtils.hpp"
+#include "MatrixView.hpp"
+#include "Quaternion.hpp"
+#include "VectorHistory.hpp"
 
 namespace Photic
 {
@@ -57,11 +60,14 @@ Vector3_t RocketTracker::track (const bool kRunSensors)
         mPBarometer->run ();
     }
 
-    // Compute vertical acceleration relative to the Earth.
-    Vector4_t quatOrient = mPImu->getQuaternionOrientation ();
-    Vector3_t vecAccelRocket = mPImu->getAccelerationVector ();
-    Vector3_t vecAccelWorld = MathUtils::rotateVector (quatOrient, vecAccelRocket);
-    Real_t accelVertical = vecAccelWorld[mVertAccelIdx];
+    // Compute vertical acceleration relative to the Earth, reading the IMU
+    // readings in place.
+    const MatrixView<4, 1, const Real_t> quatOrient (
+        mPImu->getQuaternionOrientationPtr ());
+    const MatrixView<3, 1, const Real_t> vecAccelRocket (
+        mPImu->getAccelerationVectorPtr ());
+    Real_t accelVertical = MathUtils::rotateVectorComponent (
+        quatOrient, vecAccelRocket, mVertAccelIdx);
 
     // Get altitude estimate from barometer.
     Real_t altitude = mPBarometer->getAltitude ();
@@ -84,8 +90,12 @@ void RocketTracker::profileSensors (Real_t& kBaroVarRet, Real_t& kImuVarRet,
     // Number of readings in sensor variance sample.
     static constexpr uint32_t numSamples = 1000;
 
-    // Estimate the barometer's altitude measurement variance.
-    History<numSamples> altitudeReadings;
+    // Estimate the barometer's altitude measurement variance. Readings are
+    // stored to the nearest centimeter, which halves the buffer. The storage
+    // offset follows the readings, so only their spread is limited, to 655 m,
+    // not their distance from the first reading.
+    History<numSamples, Real_t, Real_t, QuantizedStorage<int16_t>>
+        altitudeReadings (QuantizedStorage<int16_t> (0.01));
     while (!altitudeReadings.atCapacity ())
     {
         mPBarometer->run ();
@@ -97,16 +107,29 @@ void RocketTracker::profileSensors (Real_t& kBaroVarRet, Real_t& kImuVarRet,
     // Estimate launchpad altitude as the average barometer altitude reading.
     kLpAltRet = altitudeReadings.getMean ();
 
-    // Estimate the IMU's acceleration measurement variance.
-    History<numSamples> accelReadings;
-    while (!accelReadings.atCapacity ())
+    // Estimate the IMU's acceleration measurement covariance. Only the
+    // covariance is needed, so the readings are accumulated as they arrive
+    // instead of buffered.
+    CovarianceAccumulator<3> accelReadings;
+    for (uint32_t i = 0; i < numSamples; i++)
     {
         mPImu->run ();
-        Real_t vertAccel = (mPImu->getAccelerationVectorPtr ())[mVertAccelIdx];
-        accelReadings.add (vertAccel);
+        accelReadings.add (mPImu->getAccelerationVectorPtr ());
     }
-    Real_t imuStdev = accelReadings.getStdev ();
-    kImuVarRet = imuStdev * imuStdev;
+
+    // The variance of the world-frame vertical acceleration is r Cov r^T,
+    // where r is the row of the body-to-world rotation giving the vertical
+    // component.
+    const Vector4_t quatOrient = MatrixView<4, 1, const Real_t> (
+        mPImu->getQuaternionOrientationPtr ());
+    const Matrix<3, 3> rot = Quaternion (quatOrient).toRotationMatrix ();
+    Matrix<1, 3> vertRow;
+    for (Dim_t j = 0; j < 3; j++)
+    {
+        vertRow[j] = rot (mVertAccelIdx, j);
+    }
+    kImuVarRet = (vertRow * accelReadings.getCovariance () *
+                  vertRow.transpose ()) (0, 0);
 }
 
 } // namespace Photic
\ No newline at end of file
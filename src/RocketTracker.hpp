@@ -16,7 +16,8 @@
  *
  *   - IMUInterface and BarometerInterface for communicating with the rocket's
  *     sensors.
- *   - History for analyzing variance in the rocket's sensor readings.
+ *   - History and CovarianceAccumulator for analyzing variance in the rocket's
+ *     sensor readings.
  *   - KalmanFilter (and therefore Matrix and much of MathUtils) for filtering
  *     sensor noise and accurately tracking the rocket's state.
  *
@@ -150,7 +151,9 @@ private:
      * altitude based on the average altitude measurement seen during this time.
      *
      * @param   kBaroVarRet Variance in barometer altitude measurements.
-     * @param   kImuVarRet  Variance in IMU vertical acceleration measurements.
+     * @param   kImuVarRet  Variance in IMU vertical acceleration measurements,
+     *                      from the full accelerometer covariance rotated into
+     *                      the world frame.
      * @param   kLpAltRet   Estimated launchpad altitude.
      */
     void profileSensors (Real_t& kBaroVarRet, Real_t& kImuVarRet,
@@ -0,0 +1,218 @@
+/**
+ *                                 [PHOTIC]
+ *                                  v3.2.0
+ *
+ * This file is part of Photic, a collection of utilities for writing high-power
+ * rocket flight computer software. Developed in Austin, TX by the Longhorn
+ * Rocketry Association at the University of Texas at Austin.
+ *
+ *                            ---- THIS FILE ----
+ *
+ * An SpscHistory is a History that one writer, e.g. a sensor data-ready
+ * interrupt or a sensor thread, adds to while one reader, e.g. the main flight
+ * loop, reads its statistics, without locks or disabling interrupts.
+ *
+ *                              ---- USAGE ----
+ *
+ *   (1) Create an SpscHistory. The template parameters are the same as
+ *       History, optionally followed by the capacity of the queue between the
+ *       writer and the reader, which defaults to the history capacity.
+ *
+ *         Photic::SpscHistory<25> vertAccelHist;
+ *
+ *   (2) Add elements from the writer, e.g. in the IMU data-ready ISR.
+ *
+ *         void imuIsr ()
+ *         {
+ *             vertAccelHist.add (readVertAccel ());
+ *         }
+ *
+ *   (3) Read statistics from the reader.
+ *
+ *         if (vertAccelHist.atCapacity () && vertAccelHist.getMean () > 30)
+ *         { ... }
+ *
+ *                              ---- NOTES ----
+ *
+ *   (1) add only writes the new element to a single-producer/single-consumer
+ *       ring buffer queue and publishes it by advancing the queue head. Reader
+ *       methods first drain the queue into a History that only the reader
+ *       touches, advancing the queue tail, so the two sides never write the
+ *       same variable. The head is stored with release and loaded with
+ *       acquire ordering, and likewise the tail, so an element is fully
+ *       written before the reader can see it and fully read before the writer
+ *       can reuse its slot.
+ *
+ *   (2) If the reader falls so far behind that the queue is full, add drops
+ *       the new element and returns false, and the overrun is counted. The
+ *       writer can never evict queued elements itself since the reader owns
+ *       the tail. Size the queue for the longest stretch the reader can go
+ *       without reading.
+ *
+ *   (3) Atomic loads and stores use the GCC __atomic builtins rather than
+ *       <atomic>, which is missing on most Arduino cores. They are lock-free
+ *       where HistoryDim_t loads and stores are single instructions, e.g. on
+ *       32-bit ARM boards like the SAMD21. The element copy itself need not be
+ *       atomic.
+ *
+ *   (4) Exactly one context may call add, and exactly one other context may
+ *       call every other method.
+ */
+
+#ifndef PHOTIC_SPSC_HISTORY_HPP
+#define PHOTIC_SPSC_HISTORY_HPP
+
+#include "History.hpp"
+#include "Types.hpp"
+
+namespace Photic
+{
+
+template <HistoryDim_t T_Dim, typename T_Scalar = Real_t,
+          typename T_Accum = T_Scalar,
+          typename T_Storage = HistoryStorage<T_Scalar>,
+          HistoryDim_t T_Queue = T_Dim>
+class SpscHistory
+{
+protected:
+    /**
+     * Number of queue slots. One slot is always empty so that a full queue is
+     * distinguishable from an empty one.
+     */
+    static constexpr uint32_t QUEUE_SLOTS = (uint32_t) T_Queue + 1;
+
+    T_Scalar     mQueue[QUEUE_SLOTS]; /* Elements added but not yet drained. */
+    HistoryDim_t mHead;               /* Next queue slot. Writer's. */
+    HistoryDim_t mTail;               /* Oldest queued slot. Reader's. */
+    uint32_t     mOverruns;           /* Dropped elements. Writer's. */
+
+    History<T_Dim, T_Scalar, T_Accum, T_Storage> mHistory; /* Reader's. */
+
+    /**
+     * Advances a queue index.
+     *
+     * @param   kIdx Queue index.
+     *
+     * @ret     Next queue index.
+     */
+    static HistoryDim_t next (const HistoryDim_t kIdx)
+    {
+        return kIdx + 1u >= QUEUE_SLOTS ? 0 : kIdx + 1;
+    }
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param   kStorage Storage policy. See note (5) in History.hpp.
+     */
+    explicit SpscHistory (const T_Storage& kStorage = T_Storage ()) :
+        mHead (0), mTail (0), mOverruns (0), mHistory (kStorage)
+    {}
+
+    /**
+     * Adds a new element to the history. Writer only. See note (2).
+     *
+     * @param   kData New element.
+     *
+     * @ret     True if the element was queued, false if the queue was full.
+     */
+    bool add (const T_Scalar kData)
+    {
+        const HistoryDim_t head = __atomic_load_n (&mHead, __ATOMIC_RELAXED);
+        const HistoryDim_t nextHead = next (head);
+        if (nextHead == __atomic_load_n (&mTail, __ATOMIC_ACQUIRE))
+        {
+            const uint32_t overruns =
+                __atomic_load_n (&mOverruns, __ATOMIC_RELAXED);
+            __atomic_store_n (&mOverruns, overruns + 1, __ATOMIC_RELAXED);
+            return false;
+        }
+
+        mQueue[head] = kData;
+        __atomic_store_n (&mHead, nextHead, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    /**
+     * Moves every queued element into the history. Reader only. The other
+     * reader methods call this first, so calling it directly is only needed
+     * to keep the queue short.
+     *
+     * @ret     Number of elements moved.
+     */
+    HistoryDim_t drain ()
+    {
+        HistoryDim_t tail = __atomic_load_n (&mTail, __ATOMIC_RELAXED);
+        const HistoryDim_t head = __atomic_load_n (&mHead, __ATOMIC_ACQUIRE);
+        HistoryDim_t count = 0;
+        while (tail != head)
+        {
+            mHistory.add (mQueue[tail]);
+            tail = next (tail);
+            __atomic_store_n (&mTail, tail, __ATOMIC_RELEASE);
+            count++;
+        }
+
+        return count;
+    }
+
+    /**
+     * Gets the history mean. Reader only.
+     *
+     * @ret     History mean.
+     */
+    T_Accum getMean ()
+    {
+        this->drain ();
+        return mHistory.getMean ();
+    }
+
+    /**
+     * Gets the history standard deviation. Reader only.
+     *
+     * @ret     History standard deviation.
+     */
+    T_Accum getStdev ()
+    {
+        this->drain ();
+        return mHistory.getStdev ();
+    }
+
+    /**
+     * Gets if the history is at capacity. Reader only.
+     *
+     * @ret     If history is at capacity.
+     */
+    bool atCapacity ()
+    {
+        this->drain ();
+        return mHistory.atCapacity ();
+    }
+
+    /**
+     * Gets the number of elements add has dropped because the queue was full.
+     * Reader or writer.
+     *
+     * @ret     Number of dropped elements.
+     */
+    uint32_t getOverruns () const
+    {
+        return __atomic_load_n (&mOverruns, __ATOMIC_RELAXED);
+    }
+
+    /**
+     * Clears all elements from the history, including queued elements. Reader
+     * only. The overrun count is kept.
+     */
+    void clear ()
+    {
+        __atomic_store_n (&mTail, __atomic_load_n (&mHead, __ATOMIC_ACQUIRE),
+                          __ATOMIC_RELEASE);
+        mHistory.clear ();
+    }
+};
+
+} // namespace Photic
+
+#endif
@@ -0,0 +1,287 @@
+/**
+ *                                 [PHOTIC]
+ *                                  v3.2.0
+ *
+ * This file is part of Photic, a collection of utilities for writing high-power
+ * rocket flight computer software. Developed in Austin, TX by the Longhorn
+ * Rocketry Association at the University of Texas at Austin.
+ *
+ *                            ---- THIS FILE ----
+ *
+ * Matrix with a structural zero/one pattern fixed at compile time, e.g. a
+ * selector matrix like a Kalman filter's H or a unit upper triangular state
+ * transition matrix.
+ *
+ * Products involving a StructuredMatrix skip every term with a structural zero
+ * factor and every multiply by a structural one. Since the Matrix loops are
+ * unrolled, this is resolved at compile time: a product with a selector matrix
+ * compiles to row/column selection and a product with a unit triangular matrix
+ * does roughly half the work of a dense product. The pattern applies through
+ * transposes, the expression operators and every multiply kernel.
+ *
+ *                              ---- USAGE ----
+ *
+ *   Patterns are bitmasks over the row-major element indices. The
+ *   matrixPattern* helpers build common ones:
+ *
+ *     // [1 0 0
+ *     //  0 0 1]
+ *     constexpr uint64_t kHPattern = matrixPatternBit (0, 0, 3) |
+ *                                    matrixPatternBit (1, 2, 3);
+ *     StructuredMatrix<2, 3, kHPattern, kHPattern> h;
+ *
+ *     // Unit upper triangular.
+ *     StructuredMatrix<3, 3, matrixPatternUpper (3, 3),
+ *                      matrixPatternDiagonal (3, 3)> a;
+ *     a (0, 1) = dt;
+ *
+ *                              ---- NOTES ----
+ *
+ *   (1) Only free elements (non-zero, non-unit) may be written. Structural
+ *       elements are set on construction and must not be changed.
+ *
+ *   (2) Unlike Matrix, the default constructor initializes the matrix. Free
+ *       elements start at 0.
+ *
+ *   (3) Results match the equivalent dense product except where the dense
+ *       product would multiply a structural zero by an infinity or NaN.
+ */
+
+#ifndef PHOTIC_STRUCTURED_MATRIX_HPP
+#define PHOTIC_STRUCTURED_MATRIX_HPP
+
+#include "Matrix.hpp"
+#include "Types.hpp"
+
+namespace Photic
+{
+
+/**
+ * Gets the pattern bit of a single element.
+ *
+ * @param   kRow  Row index.
+ * @param   kCol  Column index.
+ * @param   kCols Number of columns in the matrix.
+ *
+ * @ret     Pattern with only the element set.
+ */
+constexpr uint64_t matrixPatternBit (const Dim_t kRow, const Dim_t kCol,
+                                     const Dim_t kCols)
+{
+    return (uint64_t) 1 << (kRow * kCols + kCol);
+}
+
+/**
+ * Gets the pattern of the main diagonal of a matrix.
+ *
+ * @param   kRows Number of rows in the matrix.
+ * @param   kCols Number of columns in the matrix.
+ *
+ * @ret     Diagonal pattern.
+ */
+constexpr uint64_t matrixPatternDiagonal (const Dim_t kRows, const Dim_t kCols)
+{
+    return kRows == 0 ? 0 :
+           (kRows <= kCols ?
+                matrixPatternBit (kRows - 1, kRows - 1, kCols) : 0) |
+           matrixPatternDiagonal (kRows - 1, kCols);
+}
+
+/**
+ * Gets the pattern of the upper triangle of a matrix, including the main
+ * diagonal.
+ *
+ * @param   kRows Number of rows in the matrix.
+ * @param   kCols Number of columns in the matrix.
+ *
+ * @ret     Upper triangular pattern.
+ */
+constexpr uint64_t matrixPatternUpper (const Dim_t kRows, const Dim_t kCols)
+{
+    return kRows == 0 ? 0 :
+           (kRows <= kCols ?
+                (((uint64_t) 1 << (kCols - kRows + 1)) - 1) <<
+                    ((kRows - 1) * kCols + kRows - 1) : 0) |
+           matrixPatternUpper (kRows - 1, kCols);
+}
+
+/**
+ * @param   T_NonZero Pattern of elements which may be non-zero. All others are
+ *                    structural zeros.
+ * @param   T_Unit    Pattern of structural ones. Must be a subset of
+ *                    T_NonZero.
+ */
+template <Dim_t T_Rows, Dim_t T_Cols, uint64_t T_NonZero, uint64_t T_Unit = 0,
+          typename T_Scalar = Real_t>
+class StructuredMatrix final :
+    public MatrixExpression<
+        StructuredMatrix<T_Rows, T_Cols, T_NonZero, T_Unit, T_Scalar>, T_Rows,
+        T_Cols, T_Scalar>
+{
+public:
+    static_assert (T_Rows * T_Cols <= 64,
+                   "StructuredMatrix patterns are limited to 64 elements");
+    static_assert ((T_Unit & ~T_NonZero) == 0,
+                   "Structural ones must be in the non-zero pattern");
+
+    /**
+     * PUBLIC FOR USE BY UTILITIES ONLY -- DO NOT USE OUTSIDE THIS FILE
+     *
+     * Elements in row-major order, including structural elements.
+     */
+    PHOTIC_MATRIX_ALIGN T_Scalar mData[T_Rows * T_Cols];
+
+    /**
+     * Gets if an element is a structural zero.
+     *
+     * @param   kRow Row index.
+     * @param   kCol Column index.
+     *
+     * @ret     If the element is always 0.
+     */
+    static constexpr bool zero (const Dim_t kRow, const Dim_t kCol)
+    {
+        return (T_NonZero & matrixPatternBit (kRow, kCol, T_Cols)) == 0;
+    }
+
+    /**
+     * Gets if an element is a structural one.
+     *
+     * @param   kRow Row index.
+     * @param   kCol Column index.
+     *
+     * @ret     If the element is always 1.
+     */
+    static constexpr bool unit (const Dim_t kRow, const Dim_t kCol)
+    {
+        return (T_Unit & matrixPatternBit (kRow, kCol, T_Cols)) != 0;
+    }
+
+    /**
+     * Sets structural elements and zeros free elements. See note (2).
+     */
+    StructuredMatrix ()
+    {
+        MatrixLoop2D<T_Rows, T_Cols>::run (
+            [&] (const Dim_t i, const Dim_t j) PHOTIC_MATRIX_INLINE
+        {
+            mData[T_Cols * i + j] = unit (i, j) ? 1 : 0;
+        });
+    }
+
+    /**
+     * Constant element access operator.
+     *
+     * @param   kRow Row index.
+     * @param   kCol Column index.
+     *
+     * @ret     Element at (kRow, kCol).
+     */
+    constexpr T_Scalar operator() (const Dim_t kRow, const Dim_t kCol) const
+    {
+        return mData[T_Cols * kRow + kCol];
+    }
+
+    /**
+     * Element access operator that allows mutation of free elements. See note
+     * (1).
+     *
+     * @param   kRow Row index.
+     * @param   kCol Column index.
+     *
+     * @ret     Reference to element at (kRow, kCol).
+     */
+    T_Scalar& operator() (const Dim_t kRow, const Dim_t kCol)
+    {
+        return mData[T_Cols * kRow + kCol];
+    }
+
+    /**
+     * Expression interface; see MatrixExpression.hpp.
+     */
+    static constexpr bool packetAccess =
+        ExpressionIsSame<T_Scalar, float>::value;
+
+    constexpr T_Scalar coeff (const Dim_t kRow, const Dim_t kCol) const
+    {
+        return mData[T_Cols * kRow + kCol];
+    }
+
+#ifdef PHOTIC_SIMD
+    MatrixSimd::Packet_t packet (const uint32_t kIdx) const
+    {
+        return MatrixSimd::load (mData + kIdx);
+    }
+#endif
+
+    bool references (const void* kPBegin, const void* kPEnd) const
+    {
+        return matrixStorageOverlaps (kPBegin, kPEnd, mData,
+                                      mData + T_Rows * T_Cols);
+    }
+
+    bool aliases (const void*, const void*) const
+    {
+        // A StructuredMatrix is never the destination of an expression.
+        return false;
+    }
+};
+
+template <Dim_t T_Rows, Dim_t T_Cols, uint64_t T_NonZero, uint64_t T_Unit,
+          typename T_Scalar>
+struct MatrixStructure<
+    StructuredMatrix<T_Rows, T_Cols, T_NonZero, T_Unit, T_Scalar>>
+{
+    typedef StructuredMatrix<T_Rows, T_Cols, T_NonZero, T_Unit, T_Scalar>
+        Structured_t;
+
+    static constexpr bool zero (const Dim_t kRow, const Dim_t kCol)
+    {
+        return Structured_t::zero (kRow, kCol);
+    }
+
+    static constexpr bool unit (const Dim_t kRow, const Dim_t kCol)
+    {
+        return Structured_t::unit (kRow, kCol);
+    }
+};
+
+/**
+ * Structured matrices and their transposes are held as-is in expressions and
+ * products, like Matrix.
+ */
+template <Dim_t T_Rows, Dim_t T_Cols, uint64_t T_NonZero, uint64_t T_Unit,
+          typename T_Scalar>
+struct ExpressionNest<
+    StructuredMatrix<T_Rows, T_Cols, T_NonZero, T_Unit, T_Scalar>>
+{
+    typedef const StructuredMatrix<T_Rows, T_Cols, T_NonZero, T_Unit,
+                                   T_Scalar>& Type;
+};
+
+template <Dim_t T_Rows, Dim_t T_Cols, uint64_t T_NonZero, uint64_t T_Unit,
+          typename T_Scalar>
+struct ProductOperand<
+    StructuredMatrix<T_Rows, T_Cols, T_NonZero, T_Unit, T_Scalar>, T_Rows,
+    T_Cols>
+{
+    typedef const StructuredMatrix<T_Rows, T_Cols, T_NonZero, T_Unit,
+                                   T_Scalar>& Type;
+};
+
+template <Dim_t T_Rows, Dim_t T_Cols, uint64_t T_NonZero, uint64_t T_Unit,
+          typename T_Scalar>
+struct ProductOperand<
+    MatrixTranspose<
+        StructuredMatrix<T_Cols, T_Rows, T_NonZero, T_Unit, T_Scalar>, T_Rows,
+        T_Cols>,
+    T_Rows, T_Cols>
+{
+    typedef const MatrixTranspose<
+        StructuredMatrix<T_Cols, T_Rows, T_NonZero, T_Unit, T_Scalar>, T_Rows,
+        T_Cols> Type;
+};
+
+} // namespace Photic
+
+#endif
\ No newline at end of file
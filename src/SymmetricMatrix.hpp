@@ -0,0 +1,398 @@
+/**
+ *                                 [PHOTIC]
+ *                                  v3.2.0
+ *
+ * This file is part of Photic, a collection of utilities for writing high-power
+ * rocket flight computer software. Developed in Austin, TX by the Longhorn
+ * Rocketry Association at the University of Texas at Austin.
+ *
+ *                            ---- THIS FILE ----
+ *
+ * Square symmetric matrix which stores only its upper triangle, e.g. a
+ * covariance matrix. An NxN SymmetricMatrix stores N(N+1)/2 elements instead
+ * of N^2, so a 3x3 covariance takes 6 elements rather than 9.
+ *
+ * This file also provides the products a covariance propagation needs, which
+ * compute only the upper triangle of their symmetric results:
+ *
+ *   propagateInto                  dst = A P A^T (also H P H^T)
+ *   multiplyInto                   dst = upper of A B
+ *   multiplyTransposedInto         dst = upper of A B^T
+ *   multiplyTransposedSubtractInto dst -= upper of A B^T
+ *
+ * Products with a symmetric operand and a Matrix destination, e.g. A P and
+ * P H^T, use the Matrix kernels, which read the symmetric operand in place.
+ *
+ *                              ---- NOTES ----
+ *
+ *   (1) Writing element (i, j) also writes element (j, i), since they are the
+ *       same element.
+ *
+ *   (2) A SymmetricMatrix is a matrix expression, so it can be used anywhere a
+ *       Matrix can be read, e.g. Matrix<3, 3> full = p; or a * p.
+ *
+ *   (3) Kernels that write a symmetric destination from a general product
+ *       compute only its upper triangle. The caller must know the full product
+ *       is symmetric, e.g. K (P H^T)^T where K = P H^T S^-1.
+ *
+ *   (4) As with the Matrix kernels, destinations must not be operands. The
+ *       exception is propagateInto, which allows p to be the destination.
+ */
+
+#ifndef PHOTIC_SYMMETRIC_MATRIX_HPP
+#define PHOTIC_SYMMETRIC_MATRIX_HPP
+
+#include "Matrix.hpp"
+#include "Types.hpp"
+
+namespace Photic
+{
+
+template <Dim_t T_Dim, typename T_Scalar = Real_t>
+class SymmetricMatrix final :
+    public MatrixExpression<SymmetricMatrix<T_Dim, T_Scalar>, T_Dim, T_Dim,
+                            T_Scalar>
+{
+public:
+    /**
+     * Number of stored elements.
+     */
+    static constexpr uint32_t packedSize = T_Dim * (T_Dim + 1) / 2;
+
+    /**
+     * PUBLIC FOR USE BY UTILITIES ONLY -- DO NOT USE OUTSIDE THIS FILE
+     *
+     * Upper triangle elements stored contiguously by row.
+     */
+    T_Scalar mData[packedSize];
+
+    /**
+     * Gets the index of an element in the packed storage.
+     *
+     * @param   kRow Row index.
+     * @param   kCol Column index.
+     *
+     * @ret     Index in mData.
+     */
+    static constexpr uint32_t index (const Dim_t kRow, const Dim_t kCol)
+    {
+        return kRow <= kCol ?
+            (uint32_t) kRow * (2 * T_Dim - kRow - 1) / 2 + kCol :
+            index (kCol, kRow);
+    }
+
+    /**
+     * Default constructor does nothing.
+     *
+     * WARNING: Matrix may be filled with garbage.
+     */
+    SymmetricMatrix () {}
+
+    /**
+     * Constructor that fills the matrix with some value.
+     *
+     * @param   kFill Fill value.
+     */
+    SymmetricMatrix (const T_Scalar kFill)
+    {
+        this->fill (kFill);
+    }
+
+    /**
+     * Gets the zero matrix. Usable in constant expressions.
+     *
+     * @ret     Zero matrix.
+     */
+    static constexpr SymmetricMatrix<T_Dim, T_Scalar> zero ()
+    {
+        return SymmetricMatrix<T_Dim, T_Scalar> (
+            typename MakeMatrixIndexSequence<packedSize>::Type (), 0);
+    }
+
+    /**
+     * Gets the identity matrix. Usable in constant expressions.
+     *
+     * @ret     Identity matrix.
+     */
+    static constexpr SymmetricMatrix<T_Dim, T_Scalar> identity ()
+    {
+        return SymmetricMatrix<T_Dim, T_Scalar> (
+            typename MakeMatrixIndexSequence<packedSize>::Type (), 1);
+    }
+
+    /**
+     * Fills the matrix with some value.
+     *
+     * @param   kFill Fill value.
+     */
+    void fill (const T_Scalar kFill)
+    {
+        MatrixLoop<packedSize>::run ([&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+        {
+            mData[i] = kFill;
+        });
+    }
+
+    /**
+     * Constant element access operator.
+     *
+     * @param   kRow Row index.
+     * @param   kCol Column index.
+     *
+     * @ret     Element at (kRow, kCol).
+     */
+    constexpr T_Scalar operator() (const Dim_t kRow, const Dim_t kCol) const
+    {
+        return mData[index (kRow, kCol)];
+    }
+
+    /**
+     * Element access operator that allows mutation. See note (1).
+     *
+     * @param   kRow Row index.
+     * @param   kCol Column index.
+     *
+     * @ret     Reference to element at (kRow, kCol).
+     */
+    T_Scalar& operator() (const Dim_t kRow, const Dim_t kCol)
+    {
+        return mData[index (kRow, kCol)];
+    }
+
+    /**
+     * Adds another symmetric matrix to this one in place.
+     *
+     * @param   kRhs RHS matrix.
+     *
+     * @ret     This matrix.
+     */
+    SymmetricMatrix<T_Dim, T_Scalar>& operator+= (
+        const SymmetricMatrix<T_Dim, T_Scalar>& kRhs)
+    {
+        MatrixLoop<packedSize>::run ([&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+        {
+            mData[i] += kRhs.mData[i];
+        });
+
+        return *this;
+    }
+
+    /**
+     * Subtracts another symmetric matrix from this one in place.
+     *
+     * @param   kRhs RHS matrix.
+     *
+     * @ret     This matrix.
+     */
+    SymmetricMatrix<T_Dim, T_Scalar>& operator-= (
+        const SymmetricMatrix<T_Dim, T_Scalar>& kRhs)
+    {
+        MatrixLoop<packedSize>::run ([&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+        {
+            mData[i] -= kRhs.mData[i];
+        });
+
+        return *this;
+    }
+
+    /**
+     * Gets if two symmetric matrices are equal. Mostly used for testing.
+     *
+     * @param   kRhs RHS matrix.
+     *
+     * @ret     If this matrix and the RHS are equal.
+     */
+    bool operator== (const SymmetricMatrix<T_Dim, T_Scalar>& kRhs) const
+    {
+        bool equal = true;
+
+        MatrixLoop<packedSize>::run ([&] (const uint32_t i) PHOTIC_MATRIX_INLINE
+        {
+            equal = equal && mData[i] == kRhs.mData[i];
+        });
+
+        return equal;
+    }
+
+    /**
+     * Expression interface; see MatrixExpression.hpp.
+     */
+    static constexpr bool packetAccess = false;
+
+    constexpr T_Scalar coeff (const Dim_t kRow, const Dim_t kCol) const
+    {
+        return mData[index (kRow, kCol)];
+    }
+
+    bool references (const void* kPBegin, const void* kPEnd) const
+    {
+        return matrixStorageOverlaps (kPBegin, kPEnd, mData,
+                                      mData + packedSize);
+    }
+
+    bool aliases (const void*, const void*) const
+    {
+        // Packed storage is never the element buffer of a Matrix destination.
+        return false;
+    }
+
+private:
+    /**
+     * Gets if a packed index is on the main diagonal, searching from some row.
+     *
+     * @param   kIdx Packed index.
+     * @param   kRow First row to check.
+     *
+     * @ret     If the element is on the main diagonal.
+     */
+    static constexpr bool diagonal (const uint32_t kIdx, const Dim_t kRow)
+    {
+        return kRow < T_Dim &&
+               (kIdx == index (kRow, kRow) || diagonal (kIdx, kRow + 1));
+    }
+
+    /**
+     * Constant expression constructor used by zero and identity. Elements on
+     * the main diagonal are set to kDiagonal and all others to 0.
+     *
+     * @param   kDiagonal Diagonal value.
+     */
+    template <uint32_t... T_Idxs>
+    constexpr SymmetricMatrix (MatrixIndexSequence<T_Idxs...>,
+                               const T_Scalar kDiagonal) :
+        mData {(diagonal (T_Idxs, 0) ? kDiagonal : 0)...} {}
+};
+
+/**
+ * Symmetric matrices are cheap to index and are held by reference in
+ * expressions and products, like Matrix.
+ */
+template <Dim_t T_Dim, typename T_Scalar>
+struct ExpressionNest<SymmetricMatrix<T_Dim, T_Scalar>>
+{
+    typedef const SymmetricMatrix<T_Dim, T_Scalar>& Type;
+};
+
+template <Dim_t T_Dim, typename T_Scalar>
+struct ProductOperand<SymmetricMatrix<T_Dim, T_Scalar>, T_Dim, T_Dim>
+{
+    typedef const SymmetricMatrix<T_Dim, T_Scalar>& Type;
+};
+
+/**
+ * Stores the upper triangle of a * b, or a * b^T if T_RhsTransposed, into a
+ * symmetric destination with T_StoreOp. See note (3).
+ *
+ * @param   kDst Destination symmetric matrix.
+ * @param   kA   LHS expression.
+ * @param   kB   RHS expression, untransposed.
+ */
+template <typename T_StoreOp, bool T_RhsTransposed, typename T_A,
+          typename T_B, Dim_t T_Dim, Dim_t T_Inner, typename T_Scalar>
+void multiplySymmetricKernel (
+    SymmetricMatrix<T_Dim, T_Scalar>& kDst,
+    const MatrixExpression<T_A, T_Dim, T_Inner, T_Scalar>& kA,
+    const T_B& kB)
+{
+    const typename ProductOperand<T_A, T_Dim, T_Inner>::Type a = kA.derived ();
+    const typename ProductOperand<T_B, T_RhsTransposed ? T_Dim : T_Inner,
+                                  T_RhsTransposed ? T_Inner : T_Dim>::Type b =
+        kB;
+
+    MatrixLoop2D<T_Dim, T_Dim>::run (
+        [&] (const Dim_t i, const Dim_t j) PHOTIC_MATRIX_INLINE
+    {
+        if (i > j)
+        {
+            return;
+        }
+
+        T_Scalar elem = 0;
+
+        MatrixLoop<T_Inner>::run ([&] (const uint32_t k) PHOTIC_MATRIX_INLINE
+        {
+            ProductTerm<T_A, T_B>::accumulate (elem, a, i, k, b,
+                                               T_RhsTransposed ? j : k,
+                                               T_RhsTransposed ? k : j);
+        });
+
+        T_StoreOp::apply (
+            kDst.mData[SymmetricMatrix<T_Dim, T_Scalar>::index (i, j)], elem);
+    });
+}
+
+/**
+ * Computes the upper triangle of a * b into a symmetric destination, e.g.
+ * H (P H^T). See note (3).
+ *
+ * @param   kDst Destination symmetric matrix.
+ * @param   kA   LHS expression.
+ * @param   kB   RHS expression.
+ */
+template <typename T_A, typename T_B, Dim_t T_Dim, Dim_t T_Inner,
+          typename T_Scalar>
+void multiplyInto (SymmetricMatrix<T_Dim, T_Scalar>& kDst,
+                   const MatrixExpression<T_A, T_Dim, T_Inner, T_Scalar>& kA,
+                   const MatrixExpression<T_B, T_Inner, T_Dim, T_Scalar>& kB)
+{
+    multiplySymmetricKernel<MatrixStoreOp, false> (kDst, kA, kB.derived ());
+}
+
+/**
+ * Computes the upper triangle of a * b^T into a symmetric destination. See
+ * note (3).
+ *
+ * @param   kDst Destination symmetric matrix.
+ * @param   kA   LHS expression.
+ * @param   kB   RHS expression (untransposed).
+ */
+template <typename T_A, typename T_B, Dim_t T_Dim, Dim_t T_Inner,
+          typename T_Scalar>
+void multiplyTransposedInto (
+    SymmetricMatrix<T_Dim, T_Scalar>& kDst,
+    const MatrixExpression<T_A, T_Dim, T_Inner, T_Scalar>& kA,
+    const MatrixExpression<T_B, T_Dim, T_Inner, T_Scalar>& kB)
+{
+    multiplySymmetricKernel<MatrixStoreOp, true> (kDst, kA, kB.derived ());
+}
+
+/**
+ * Subtracts the upper triangle of a * b^T from a symmetric destination, e.g.
+ * P -= K (P H^T)^T. See note (3).
+ *
+ * @param   kDst Destination symmetric matrix.
+ * @param   kA   LHS expression.
+ * @param   kB   RHS expression (untransposed).
+ */
+template <typename T_A, typename T_B, Dim_t T_Dim, Dim_t T_Inner,
+          typename T_Scalar>
+void multiplyTransposedSubtractInto (
+    SymmetricMatrix<T_Dim, T_Scalar>& kDst,
+    const MatrixExpression<T_A, T_Dim, T_Inner, T_Scalar>& kA,
+    const MatrixExpression<T_B, T_Dim, T_Inner, T_Scalar>& kB)
+{
+    multiplySymmetricKernel<MatrixSubtractStoreOp, true> (kDst, kA,
+                                                          kB.derived ());
+}
+
+/**
+ * Computes dst = a * p * a^T, e.g. A P A^T or H P H^T. Only the upper triangle
+ * of the result is computed. The destination may be p.
+ *
+ * @param   kDst Destination symmetric matrix.
+ * @param   kA   Outer expression.
+ * @param   kP   Inner symmetric matrix.
+ */
+template <typename T_A, Dim_t T_Rows, Dim_t T_Dim, typename T_Scalar>
+void propagateInto (SymmetricMatrix<T_Rows, T_Scalar>& kDst,
+                    const MatrixExpression<T_A, T_Rows, T_Dim, T_Scalar>& kA,
+                    const SymmetricMatrix<T_Dim, T_Scalar>& kP)
+{
+    Matrix<T_Rows, T_Dim, T_Scalar> ap;
+    multiplyInto (ap, kA, kP);
+    multiplyTransposedInto (kDst, ap, kA);
+}
+
+} // namespace Photic
+
+#endif
@@ -0,0 +1,307 @@
+/**
+ *                                 [PHOTIC]
+ *                                  v3.2.0
+ *
+ * This file is part of Photic, a collection of utilities for writing high-power
+ * rocket flight computer software. Developed in Austin, TX by the Longhorn
+ * Rocketry Association at the University of Texas at Austin.
+ *
+ *                            ---- THIS FILE ----
+ *
+ * A TieredHistory covers a long time horizon in little memory by keeping the
+ * most recent elements at full rate and progressively decimating older ones,
+ * e.g. the last second of altitude at full rate for liftoff detection and the
+ * last minute at a tenth of the rate or less for landing detection.
+ *
+ *                              ---- USAGE ----
+ *
+ *   (1) Create a TieredHistory. The template parameters are the number of
+ *       entries per tier, the number of tiers and the decimation factor
+ *       between tiers, then the element and accumulator types as with
+ *       History.
+ *
+ *         Photic::TieredHistory<50, 3, 10> altHist;
+ *
+ *       At 100 Hz this covers the last 0.5 s at full rate, the 5 s before
+ *       that in 0.1 s entries and the 50 s before that in 1 s entries, in
+ *       150 entries instead of 5550 elements.
+ *
+ *   (2) Add elements.
+ *
+ *         altHist.add (baro.getAltitude ());
+ *
+ *   (3) Query the minimum, maximum and mean over the newest N tiers, e.g.
+ *       the full-rate tier alone or every tier.
+ *
+ *         Real_t recentMean = altHist.getMean (1);
+ *         Real_t range = altHist.getMax (3) - altHist.getMin (3);
+ *         uint32_t samples = altHist.getSpan (3);
+ *
+ *                              ---- NOTES ----
+ *
+ *   (1) Tiers are disjoint in time. Tier 0 holds the newest elements. Each
+ *       entry of tier k aggregates (min, max and sum) T_Decimation^k
+ *       consecutive elements, formed from T_Decimation entries as they are
+ *       evicted from tier k - 1. Entries evicted from tier k - 1 but not yet
+ *       enough to form a tier k entry are kept as a pending aggregate, which
+ *       counts as part of tier k, so no element between tiers is missing from
+ *       queries. Entries evicted from the last tier are discarded.
+ *
+ *   (2) Each tier keeps a running sum and monotonic deques of its entries'
+ *       minimums and maximums (see MinMaxHistory), so a query over the newest
+ *       N tiers costs O(N) and add costs amortized O(1). Queries cover whole
+ *       tiers; getSpan gives the number of elements a query covers.
+ *
+ *   (3) The horizon grows geometrically with the number of tiers while memory
+ *       grows linearly, i.e. memory is logarithmic in the horizon. Each tier
+ *       takes T_TierDim (2 sizeof (T_Scalar) + sizeof (T_Accum) +
+ *       2 sizeof (HistoryDim_t)) bytes.
+ *
+ *   (4) Queries on an empty TieredHistory are undefined.
+ */
+
+#ifndef PHOTIC_TIERED_HISTORY_HPP
+#define PHOTIC_TIERED_HISTORY_HPP
+
+#include "History.hpp"
+#include "MinMaxHistory.hpp"
+#include "Types.hpp"
+
+namespace Photic
+{
+
+template <HistoryDim_t T_TierDim, Dim_t T_Tiers, uint16_t T_Decimation,
+          typename T_Scalar = Real_t, typename T_Accum = T_Scalar>
+class TieredHistory
+{
+    static_assert (T_Decimation <= T_TierDim, "Decimation factor must not "
+                                              "exceed the tier size");
+
+protected:
+    T_Scalar     mMin[T_Tiers][T_TierDim];  /* Entry minimums. */
+    T_Scalar     mMax[T_Tiers][T_TierDim];  /* Entry maximums. */
+    T_Accum      mSum[T_Tiers][T_TierDim];  /* Entry sums. */
+    HistoryDim_t mSize[T_Tiers];            /* Entries in each tier. */
+    HistoryDim_t mIdx[T_Tiers];             /* Next entry index per tier. */
+    T_Accum      mTierSum[T_Tiers];         /* Running sum of entry sums. */
+    uint32_t     mEntrySpan[T_Tiers];       /* Elements per entry. */
+    HistoryMonotonicDeque<T_TierDim, false> mMinDeque[T_Tiers];
+    HistoryMonotonicDeque<T_TierDim, true>  mMaxDeque[T_Tiers];
+
+    // Aggregate of entries evicted from tier k - 1 waiting to form an entry
+    // of tier k. Index 0 is unused.
+    T_Scalar     mPendMin[T_Tiers];         /* Pending minimum. */
+    T_Scalar     mPendMax[T_Tiers];         /* Pending maximum. */
+    T_Accum      mPendSum[T_Tiers];         /* Pending sum. */
+    uint16_t     mPendCount[T_Tiers];       /* Pending entries. */
+
+    /**
+     * Adds an entry to a tier, evicting its oldest entry toward the next tier
+     * if the tier is at capacity.
+     *
+     * @param   kTier Tier index.
+     * @param   kMin  Entry minimum.
+     * @param   kMax  Entry maximum.
+     * @param   kSum  Entry sum.
+     */
+    void push (const Dim_t kTier, const T_Scalar kMin, const T_Scalar kMax,
+               const T_Accum kSum)
+    {
+        const HistoryDim_t slot = mIdx[kTier];
+        if (mSize[kTier] == T_TierDim)
+        {
+            mMinDeque[kTier].evict (slot);
+            mMaxDeque[kTier].evict (slot);
+            mTierSum[kTier] -= mSum[kTier][slot];
+            if (kTier + 1 < T_Tiers)
+            {
+                this->absorb (kTier + 1, mMin[kTier][slot], mMax[kTier][slot],
+                              mSum[kTier][slot]);
+            }
+        }
+        else
+        {
+            mSize[kTier]++;
+        }
+
+        mMin[kTier][slot] = kMin;
+        mMax[kTier][slot] = kMax;
+        mSum[kTier][slot] = kSum;
+        mTierSum[kTier] += kSum;
+        mMinDeque[kTier].push (mMin[kTier], slot);
+        mMaxDeque[kTier].push (mMax[kTier], slot);
+
+        // Wrap the index, and discard the running sum's accumulated rounding
+        // as History does.
+        if (++mIdx[kTier] >= T_TierDim)
+        {
+            mIdx[kTier] = 0;
+            mTierSum[kTier] = 0;
+            for (HistoryDim_t i = 0; i < T_TierDim; i++)
+            {
+                mTierSum[kTier] += mSum[kTier][i];
+            }
+        }
+    }
+
+    /**
+     * Adds an entry evicted from the previous tier to a tier's pending
+     * aggregate, and pushes the aggregate once it is complete.
+     *
+     * @param   kTier Tier index, at least 1.
+     * @param   kMin  Evicted entry minimum.
+     * @param   kMax  Evicted entry maximum.
+     * @param   kSum  Evicted entry sum.
+     */
+    void absorb (const Dim_t kTier, const T_Scalar kMin, const T_Scalar kMax,
+                 const T_Accum kSum)
+    {
+        if (mPendCount[kTier] == 0)
+        {
+            mPendMin[kTier] = kMin;
+            mPendMax[kTier] = kMax;
+            mPendSum[kTier] = kSum;
+        }
+        else
+        {
+            mPendMin[kTier] = kMin < mPendMin[kTier] ? kMin : mPendMin[kTier];
+            mPendMax[kTier] = kMax > mPendMax[kTier] ? kMax : mPendMax[kTier];
+            mPendSum[kTier] += kSum;
+        }
+
+        if (++mPendCount[kTier] == T_Decimation)
+        {
+            mPendCount[kTier] = 0;
+            this->push (kTier, mPendMin[kTier], mPendMax[kTier],
+                        mPendSum[kTier]);
+        }
+    }
+
+public:
+    /**
+     * Constructor.
+     */
+    TieredHistory ()
+    {
+        uint32_t span = 1;
+        for (Dim_t t = 0; t < T_Tiers; t++)
+        {
+            mEntrySpan[t] = span;
+            span *= T_Decimation;
+        }
+        this->clear ();
+    }
+
+    /**
+     * Adds a new element to the history. See note (1).
+     *
+     * @param   kData New element.
+     */
+    void add (const T_Scalar kData)
+    {
+        this->push (0, kData, kData, kData);
+    }
+
+    /**
+     * Gets the number of elements covered by the newest tiers.
+     *
+     * @param   kTiers Number of tiers, 1 to T_Tiers.
+     *
+     * @ret     Number of elements.
+     */
+    uint32_t getSpan (const Dim_t kTiers) const
+    {
+        uint32_t span = mSize[0];
+        for (Dim_t t = 1; t < kTiers; t++)
+        {
+            span += mSize[t] * mEntrySpan[t] +
+                    mPendCount[t] * mEntrySpan[t - 1];
+        }
+        return span;
+    }
+
+    /**
+     * Gets the minimum element in the newest tiers.
+     *
+     * @param   kTiers Number of tiers, 1 to T_Tiers.
+     *
+     * @ret     Minimum.
+     */
+    T_Scalar getMin (const Dim_t kTiers) const
+    {
+        T_Scalar min = mMin[0][mMinDeque[0].front ()];
+        for (Dim_t t = 1; t < kTiers; t++)
+        {
+            if (mSize[t] > 0 && mMin[t][mMinDeque[t].front ()] < min)
+            {
+                min = mMin[t][mMinDeque[t].front ()];
+            }
+            if (mPendCount[t] > 0 && mPendMin[t] < min)
+            {
+                min = mPendMin[t];
+            }
+        }
+        return min;
+    }
+
+    /**
+     * Gets the maximum element in the newest tiers.
+     *
+     * @param   kTiers Number of tiers, 1 to T_Tiers.
+     *
+     * @ret     Maximum.
+     */
+    T_Scalar getMax (const Dim_t kTiers) const
+    {
+        T_Scalar max = mMax[0][mMaxDeque[0].front ()];
+        for (Dim_t t = 1; t < kTiers; t++)
+        {
+            if (mSize[t] > 0 && mMax[t][mMaxDeque[t].front ()] > max)
+            {
+                max = mMax[t][mMaxDeque[t].front ()];
+            }
+            if (mPendCount[t] > 0 && mPendMax[t] > max)
+            {
+                max = mPendMax[t];
+            }
+        }
+        return max;
+    }
+
+    /**
+     * Gets the mean of the elements in the newest tiers.
+     *
+     * @param   kTiers Number of tiers, 1 to T_Tiers.
+     *
+     * @ret     Mean.
+     */
+    T_Accum getMean (const Dim_t kTiers) const
+    {
+        T_Accum sum = 0;
+        for (Dim_t t = 0; t < kTiers; t++)
+        {
+            sum += mTierSum[t] + (mPendCount[t] > 0 ? mPendSum[t] : 0);
+        }
+        return sum / this->getSpan (kTiers);
+    }
+
+    /**
+     * Clears all elements from the history.
+     */
+    void clear ()
+    {
+        for (Dim_t t = 0; t < T_Tiers; t++)
+        {
+            mSize[t] = 0;
+            mIdx[t] = 0;
+            mTierSum[t] = 0;
+            mPendCount[t] = 0;
+            mMinDeque[t].clear ();
+            mMaxDeque[t].clear ();
+        }
+    }
+};
+
+} // namespace Photic
+
+#endif
@@ -0,0 +1,318 @@
+/**
+ *                                 [PHOTIC]
+ *                                  v3.2.0
+ *
+ * This file is part of Photic, a collection of utilities for writing high-power
+ * rocket flight computer software. Developed in Austin, TX by the Longhorn
+ * Rocketry Association at the University of Texas at Austin.
+ *
+ *                            ---- THIS FILE ----
+ *
+ * A TimedHistory is a History whose window is a duration rather than a number
+ * of elements. Each element is stored with a timestamp, and elements older
+ * than the window are dropped, so a window covers the same time when the
+ * sensor rate jitters, the loop overruns or the loop frequency is retuned.
+ *
+ *                              ---- USAGE ----
+ *
+ *   (1) Create a TimedHistory. The template parameter is the capacity, which
+ *       must hold as many elements as the highest sample rate puts in the
+ *       window. The constructor takes the window in microseconds.
+ *
+ *         Photic::TimedHistory<64> altHist (500000);
+ *
+ *   (2) Add elements with their timestamps in microseconds, e.g. from
+ *       micros () on Arduino.
+ *
+ *         altHist.add (baro.getAltitude (), micros ());
+ *
+ *   (3) Act on statistics over the last 0.5 s, e.g. detect apogee once the
+ *       altitude trend turns negative.
+ *
+ *         if (altHist.getSlope () < 0) { ... }
+ *
+ *                              ---- NOTES ----
+ *
+ *   (1) The window ends at the newest timestamp. add drops the elements older
+ *       than the window by advancing the ring buffer tail, which acts as a
+ *       time cursor, so each element is dropped once and add is amortized
+ *       O(1). Call expire to drop old elements when no new ones arrive, e.g.
+ *       after a sensor dropout. If the history is at capacity, add drops the
+ *       oldest element even if it is in the window.
+ *
+ *   (2) Running sums of the elements and timestamps give the mean and the
+ *       least squares slope in O(1), and monotonic deques give the minimum and
+ *       maximum in O(1) (see MinMaxHistory). As in History, the sums are of
+ *       the elements less a reference element and of the times since a
+ *       reference time. They are recomputed exactly, relative to the oldest
+ *       element, each time the window turns over, i.e. once as many elements
+ *       have been dropped as remain. The times in the sums then stay within
+ *       about two windows of the reference however large the capacity, which
+ *       keeps the slope free of cancellation, and the recomputation is
+ *       amortized O(1).
+ *
+ *   (3) Timestamps must not decrease. They are compared by unsigned
+ *       difference, so they may wrap around 2^32 us (71.6 minutes), but the
+ *       span of the history must be shorter than that.
+ *
+ *   (4) The slope is in element units per second. It is 0 with fewer than 2
+ *       elements or when every element has the same timestamp. The mean,
+ *       minimum and maximum of an empty history are undefined.
+ */
+
+#ifndef PHOTIC_TIMED_HISTORY_HPP
+#define PHOTIC_TIMED_HISTORY_HPP
+
+#include "History.hpp"
+#include "MinMaxHistory.hpp"
+#include "Types.hpp"
+
+namespace Photic
+{
+
+template <HistoryDim_t T_Dim, typename T_Scalar = Real_t,
+          typename T_Accum = T_Scalar>
+class TimedHistory
+{
+protected:
+    T_Scalar     mData[T_Dim];   /* Element ring buffer. */
+    uint32_t     mTime[T_Dim];   /* Timestamp of each element in us. */
+    HistoryDim_t mCurrentSize;   /* Current number of elements. */
+    HistoryDim_t mIdx;           /* Index of next element. */
+    uint32_t     mWindow;        /* Window duration in us. */
+    uint32_t     mTimeRef;       /* Reference time for running sums. */
+    HistoryDim_t mEvicted;       /* Elements dropped since recomputing sums. */
+    T_Scalar     mShift;         /* Reference element for running sums. */
+    T_Accum      mSigmaX;        /* Running Sigma(x - shift). */
+    T_Accum      mSigmaT;        /* Running Sigma(t - tref) in seconds. */
+    T_Accum      mSigmaTSqr;     /* Running Sigma((t - tref)^2). */
+    T_Accum      mSigmaTX;       /* Running Sigma((t - tref) (x - shift)). */
+    HistoryMonotonicDeque<T_Dim, false> mMinDeque; /* Minimum candidates. */
+    HistoryMonotonicDeque<T_Dim, true>  mMaxDeque; /* Maximum candidates. */
+
+    /**
+     * Gets the slot of the oldest element.
+     *
+     * @ret     Oldest slot.
+     */
+    HistoryDim_t oldest () const
+    {
+        const uint32_t slot = (uint32_t) mIdx + T_Dim - mCurrentSize;
+        return slot >= T_Dim ? slot - T_Dim : slot;
+    }
+
+    /**
+     * Adds an element's contribution to the running sums, or removes it.
+     *
+     * @param   kSlot Slot of the element.
+     * @param   kSign 1 to add, -1 to remove.
+     */
+    void accumulate (const HistoryDim_t kSlot, const T_Accum kSign)
+    {
+        const T_Accum x = mData[kSlot] - mShift;
+        const T_Accum t = (T_Accum) (uint32_t) (mTime[kSlot] - mTimeRef) *
+                          (T_Accum) 1e-6;
+        mSigmaX += kSign * x;
+        mSigmaT += kSign * t;
+        mSigmaTSqr += kSign * t * t;
+        mSigmaTX += kSign * t * x;
+    }
+
+    /**
+     * Drops the oldest element.
+     */
+    void evictOldest ()
+    {
+        const HistoryDim_t slot = this->oldest ();
+        mMinDeque.evict (slot);
+        mMaxDeque.evict (slot);
+        this->accumulate (slot, -1);
+        mCurrentSize--;
+        mEvicted++;
+    }
+
+    /**
+     * Recomputes the running sums exactly, relative to the oldest element.
+     */
+    void computeSums ()
+    {
+        mSigmaX = 0;
+        mSigmaT = 0;
+        mSigmaTSqr = 0;
+        mSigmaTX = 0;
+        mEvicted = 0;
+        if (mCurrentSize == 0)
+        {
+            return;
+        }
+
+        HistoryDim_t slot = this->oldest ();
+        mTimeRef = mTime[slot];
+        mShift = mData[slot];
+        for (HistoryDim_t i = 0; i < mCurrentSize; i++)
+        {
+            this->accumulate (slot, 1);
+            slot = slot + 1 >= T_Dim ? 0 : slot + 1;
+        }
+    }
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param   kWindowUs Window duration in microseconds.
+     */
+    explicit TimedHistory (const uint32_t kWindowUs) :
+        mCurrentSize (0), mIdx (0), mWindow (kWindowUs), mTimeRef (0),
+        mEvicted (0), mShift (0), mSigmaX (0), mSigmaT (0), mSigmaTSqr (0),
+        mSigmaTX (0)
+    {}
+
+    /**
+     * Adds a new element to the history and drops the elements that have left
+     * the window. See note (1).
+     *
+     * @param   kData   New element.
+     * @param   kTimeUs Timestamp of the element in microseconds.
+     */
+    void add (const T_Scalar kData, const uint32_t kTimeUs)
+    {
+        if (mCurrentSize == T_Dim)
+        {
+            this->evictOldest ();
+        }
+        else if (mCurrentSize == 0)
+        {
+            mTimeRef = kTimeUs;
+            mShift = kData;
+        }
+
+        const HistoryDim_t slot = mIdx;
+        mData[slot] = kData;
+        mTime[slot] = kTimeUs;
+        mCurrentSize++;
+        this->accumulate (slot, 1);
+        mMinDeque.push (mData, slot);
+        mMaxDeque.push (mData, slot);
+        mIdx = mIdx + 1 >= T_Dim ? 0 : mIdx + 1;
+
+        this->expire (kTimeUs);
+
+        // Re-reference the running sums and discard their accumulated
+        // rounding once the window has turned over. See note (2).
+        if (mEvicted >= mCurrentSize)
+        {
+            this->computeSums ();
+        }
+    }
+
+    /**
+     * Drops the elements older than the window before a time.
+     *
+     * @param   kNowUs Current time in microseconds.
+     */
+    void expire (const uint32_t kNowUs)
+    {
+        while (mCurrentSize > 0 &&
+               (uint32_t) (kNowUs - mTime[this->oldest ()]) > mWindow)
+        {
+            this->evictOldest ();
+        }
+
+        // Start an emptied history's sums from exactly 0.
+        if (mCurrentSize == 0)
+        {
+            this->computeSums ();
+        }
+    }
+
+    /**
+     * Gets the mean of the elements in the window.
+     *
+     * @ret     Mean.
+     */
+    T_Accum getMean () const
+    {
+        return mShift + mSigmaX / mCurrentSize;
+    }
+
+    /**
+     * Gets the smallest element in the window.
+     *
+     * @ret     Minimum.
+     */
+    T_Scalar getMin () const
+    {
+        return mData[mMinDeque.front ()];
+    }
+
+    /**
+     * Gets the largest element in the window.
+     *
+     * @ret     Maximum.
+     */
+    T_Scalar getMax () const
+    {
+        return mData[mMaxDeque.front ()];
+    }
+
+    /**
+     * Gets the least squares slope of the elements in the window over time.
+     * See note (4).
+     *
+     * @ret     Slope in element units per second.
+     */
+    T_Accum getSlope () const
+    {
+        const T_Accum n = mCurrentSize;
+        const T_Accum denom = n * mSigmaTSqr - mSigmaT * mSigmaT;
+        if (mCurrentSize < 2 || !(denom > 0))
+        {
+            return 0;
+        }
+
+        return (n * mSigmaTX - mSigmaT * mSigmaX) / denom;
+    }
+
+    /**
+     * Gets the number of elements in the window.
+     *
+     * @ret     Number of elements.
+     */
+    HistoryDim_t getSize () const
+    {
+        return mCurrentSize;
+    }
+
+    /**
+     * Gets the time between the oldest and newest elements in the window.
+     *
+     * @ret     Span in microseconds.
+     */
+    uint32_t getSpan () const
+    {
+        if (mCurrentSize == 0)
+        {
+            return 0;
+        }
+
+        const HistoryDim_t newest = mIdx == 0 ? T_Dim - 1 : mIdx - 1;
+        return mTime[newest] - mTime[this->oldest ()];
+    }
+
+    /**
+     * Clears all elements from the history.
+     */
+    void clear ()
+    {
+        mIdx = 0;
+        mCurrentSize = 0;
+        mMinDeque.clear ();
+        mMaxDeque.clear ();
+        this->computeSums ();
+    }
+};
+
+} // namespace Photic
+
+#endif
@@ -18,14 +18,20 @@ namespace Photic
 {
 
 /**
- * cstdint types.
+ * cstdint types. The 32-bit types use the compiler's own definitions where
+ * available, since int is only 16 bits on AVR.
  */
-typedef char               int8_t;
+typedef signed char        int8_t;
 typedef unsigned char      uint8_t;
 typedef short              int16_t;
 typedef unsigned short     uint16_t;
+#if defined (__INT32_TYPE__) && defined (__UINT32_TYPE__)
+typedef __INT32_TYPE__     int32_t;
+typedef __UINT32_TYPE__    uint32_t;
+#else
 typedef int                int32_t;
 typedef unsigned int       uint32_t;
+#endif
 typedef long long          int64_t;
 typedef unsigned long long uint64_t;
 
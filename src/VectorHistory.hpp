@@ -0,0 +1,347 @@
+/**
+ *                                 [PHOTIC]
+ *                                  v3.2.0
+ *
+ * This file is part of Photic, a collection of utilities for writing high-power
+ * rocket flight computer software. Developed in Austin, TX by the Longhorn
+ * Rocketry Association at the University of Texas at Austin.
+ *
+ *                            ---- THIS FILE ----
+ *
+ * A VectorHistory is a History of vector samples, e.g. 3-axis acceleration or
+ * magnetometer readings. All channels share one ring buffer index, and the
+ * per-channel statistics and the covariance between channels are computed in
+ * a single pass over the samples.
+ *
+ *                              ---- USAGE ----
+ *
+ *   (1) Create a VectorHistory. The template parameters are the capacity and
+ *       the number of channels, then the element and accumulator types as
+ *       with History.
+ *
+ *         Photic::VectorHistory<100, 3> accelHist;
+ *
+ *   (2) Add vector samples. Any column vector expression works, e.g. a
+ *       Vector3_t or a view of an IMU reading.
+ *
+ *         accelHist.add (imu.getAccelerationVector ());
+ *
+ *   (3) Act on per-channel statistics or the covariance.
+ *
+ *         Photic::Vector3_t accelMean = accelHist.getMean ();
+ *         Photic::SymmetricMatrix<3> accelCov = accelHist.getCovariance ();
+ *
+ *                              ---- NOTES ----
+ *
+ *   (1) Samples are stored channel-major: each channel's elements are
+ *       contiguous, so the statistics pass reads each channel sequentially.
+ *
+ *   (2) Statistics are cached. They are recomputed in one pass over the
+ *       samples when a statistic is requested after an add. As in History,
+ *       the pass accumulates sums of each channel less its first element to
+ *       avoid cancellation. The pass is a CovarianceAccumulator, which can
+ *       also be used on its own to get the statistics of a stream of samples
+ *       without storing them.
+ *
+ *   (3) Covariances and standard deviations are of the population, i.e.
+ *       divide by the number of samples, matching History.
+ *
+ *   (4) The behavior of a zero capacity VectorHistory is undefined. The mean
+ *       of an empty VectorHistory is undefined.
+ */
+
+#ifndef PHOTIC_VECTOR_HISTORY_HPP
+#define PHOTIC_VECTOR_HISTORY_HPP
+
+#include <math.h>
+
+#include "History.hpp"
+#include "Matrix.hpp"
+#include "SymmetricMatrix.hpp"
+#include "Types.hpp"
+
+namespace Photic
+{
+
+/**
+ * Streaming accumulator of the mean and covariance of vector samples, for
+ * when only the statistics of a run of samples are needed and the samples
+ * need not be kept. See note (2).
+ */
+template <Dim_t T_Channels, typename T_Scalar = Real_t,
+          typename T_Accum = T_Scalar>
+class CovarianceAccumulator
+{
+protected:
+    T_Accum mShift[T_Channels];                    /* First sample. */
+    T_Accum mSigmaX[T_Channels];                   /* Sigma(x - shift). */
+    SymmetricMatrix<T_Channels, T_Accum> mSigmaXY; /* Sigma((x - shift) *
+                                                      (y - shift)). */
+    uint32_t mCount;                               /* Number of samples. */
+
+public:
+    /**
+     * Constructor.
+     */
+    CovarianceAccumulator () : mSigmaXY (0), mCount (0)
+    {
+        for (Dim_t c = 0; c < T_Channels; c++)
+        {
+            mShift[c] = 0;
+            mSigmaX[c] = 0;
+        }
+    }
+
+    /**
+     * Adds a sample whose channels are evenly spaced in memory.
+     *
+     * @param   kSample First channel of the sample.
+     * @param   kStride Distance between channels in elements.
+     */
+    void add (const T_Scalar* const kSample, const uint32_t kStride = 1)
+    {
+        T_Accum x[T_Channels];
+        for (Dim_t c = 0; c < T_Channels; c++)
+        {
+            if (mCount == 0)
+            {
+                mShift[c] = kSample[c * kStride];
+                mSigmaX[c] = 0;
+            }
+            x[c] = kSample[c * kStride] - mShift[c];
+            mSigmaX[c] += x[c];
+        }
+
+        // Sigma(x y) relative to the shift, per pair of channels.
+        for (Dim_t c = 0; c < T_Channels; c++)
+        {
+            for (Dim_t d = c; d < T_Channels; d++)
+            {
+                mSigmaXY (c, d) += x[c] * x[d];
+            }
+        }
+        mCount++;
+    }
+
+    /**
+     * Adds a sample.
+     *
+     * @param   kSample New sample. May be any column vector expression.
+     */
+    template <typename T_Expr>
+    void add (
+        const MatrixExpression<T_Expr, T_Channels, 1, T_Scalar>& kSample)
+    {
+        T_Scalar sample[T_Channels];
+        for (Dim_t c = 0; c < T_Channels; c++)
+        {
+            sample[c] = kSample (c, 0);
+        }
+        this->add (sample);
+    }
+
+    /**
+     * Gets the mean of each channel. The mean of no samples is undefined.
+     *
+     * @ret     Channel means.
+     */
+    Matrix<T_Channels, 1, T_Accum> getMean () const
+    {
+        Matrix<T_Channels, 1, T_Accum> mean;
+        for (Dim_t c = 0; c < T_Channels; c++)
+        {
+            mean[c] = mShift[c] + mSigmaX[c] / mCount;
+        }
+
+        return mean;
+    }
+
+    /**
+     * Gets the covariance matrix of the channels. See note (3).
+     *
+     * @ret     Channel covariance, or 0 with fewer than 2 samples.
+     */
+    SymmetricMatrix<T_Channels, T_Accum> getCovariance () const
+    {
+        const T_Accum n = mCount;
+        SymmetricMatrix<T_Channels, T_Accum> cov (0);
+        for (Dim_t c = 0; mCount >= 2 && c < T_Channels; c++)
+        {
+            for (Dim_t d = c; d < T_Channels; d++)
+            {
+                cov (c, d) = (mSigmaXY (c, d) - mSigmaX[c] * mSigmaX[d] / n) /
+                             n;
+            }
+        }
+
+        return cov;
+    }
+
+    /**
+     * Gets the number of samples added.
+     *
+     * @ret     Number of samples.
+     */
+    uint32_t getCount () const
+    {
+        return mCount;
+    }
+
+    /**
+     * Clears all samples.
+     */
+    void clear ()
+    {
+        mSigmaXY = SymmetricMatrix<T_Channels, T_Accum> (0);
+        mCount = 0;
+    }
+};
+
+template <HistoryDim_t T_Dim, Dim_t T_Channels, typename T_Scalar = Real_t,
+          typename T_Accum = T_Scalar>
+class VectorHistory
+{
+protected:
+    T_Scalar mData[T_Channels][T_Dim];         /* Samples, channel-major. */
+    HistoryDim_t mCurrentSize;                 /* Current number of samples. */
+    HistoryDim_t mIdx;                         /* Index of next sample. */
+    Matrix<T_Channels, 1, T_Accum> mMean;      /* Last computed mean. */
+    SymmetricMatrix<T_Channels, T_Accum> mCov; /* Last computed covariance. */
+    bool mDirty;                               /* If stats are out of date. */
+
+    /**
+     * Computes the mean and covariance of the history.
+     */
+    void computeStats ()
+    {
+        // Channel c of sample i is T_Dim elements after channel c - 1.
+        CovarianceAccumulator<T_Channels, T_Scalar, T_Accum> accum;
+        for (HistoryDim_t i = 0; i < mCurrentSize; i++)
+        {
+            accum.add (&mData[0][i], T_Dim);
+        }
+        mMean = accum.getMean ();
+        mCov = accum.getCovariance ();
+
+        // Mark these stats as up to date.
+        mDirty = false;
+    }
+
+public:
+    /**
+     * Constructor.
+     */
+    VectorHistory () : mCurrentSize (0), mIdx (0), mDirty (true) {}
+
+    /**
+     * Adds a new sample to the history. If the history is at capacity, the
+     * oldest sample is thrown out.
+     *
+     * @param   kSample New sample. May be any column vector expression.
+     */
+    template <typename T_Expr>
+    void add (
+        const MatrixExpression<T_Expr, T_Channels, 1, T_Scalar>& kSample)
+    {
+        for (Dim_t c = 0; c < T_Channels; c++)
+        {
+            mData[c][mIdx] = kSample (c, 0);
+        }
+        mIdx++;
+
+        // Increment size if not yet at capacity.
+        if (mCurrentSize < T_Dim)
+        {
+            mCurrentSize++;
+        }
+
+        // Wrap index around to start of history to replace oldest sample on
+        // next add call.
+        if (mIdx >= T_Dim)
+        {
+            mIdx = 0;
+        }
+
+        // Invalidate last stat computations.
+        mDirty = true;
+    }
+
+    /**
+     * Gets the mean of each channel.
+     *
+     * @ret     Channel means.
+     */
+    Matrix<T_Channels, 1, T_Accum> getMean ()
+    {
+        if (mDirty)
+        {
+            this->computeStats ();
+        }
+
+        return mMean;
+    }
+
+    /**
+     * Gets the standard deviation of each channel.
+     *
+     * @ret     Channel standard deviations.
+     */
+    Matrix<T_Channels, 1, T_Accum> getStdev ()
+    {
+        if (mDirty)
+        {
+            this->computeStats ();
+        }
+
+        // Rounding can leave a variance slightly negative when a channel's
+        // elements are nearly equal.
+        Matrix<T_Channels, 1, T_Accum> stdev;
+        for (Dim_t c = 0; c < T_Channels; c++)
+        {
+            const T_Accum variance = mCov (c, c);
+            stdev[c] = variance > 0 ? sqrt (variance) : 0;
+        }
+
+        return stdev;
+    }
+
+    /**
+     * Gets the covariance matrix of the channels. Its diagonal holds the
+     * variance of each channel.
+     *
+     * @ret     Channel covariance.
+     */
+    SymmetricMatrix<T_Channels, T_Accum> getCovariance ()
+    {
+        if (mDirty)
+        {
+            this->computeStats ();
+        }
+
+        return mCov;
+    }
+
+    /**
+     * Gets if the history is at capacity.
+     *
+     * @ret     If history is at capacity.
+     */
+    bool atCapacity () const
+    {
+        return (mCurrentSize == T_Dim);
+    }
+
+    /**
+     * Clears all samples from the history.
+     */
+    void clear ()
+    {
+        mIdx = 0;
+        mCurrentSize = 0;
+        mDirty = true;
+    }
+};
+
+} // namespace Photic
+
+#endif
@@ -0,0 +1,178 @@
+/**
+ * Tests for EwmaStats, TimedEwmaStats and EwmaCrossover.
+ */
+
+#ifndef TEST_EWMA_STATS_HPP
+#define TEST_EWMA_STATS_HPP
+
+#include <math.h>
+
+#include "EwmaStats.hpp"
+#include "TestMacros.hpp"
+
+using namespace Photic;
+
+namespace TestEwmaStats
+{
+
+/**
+ * Tests the recurrence against the explicitly weighted mean and variance, in
+ * which element i of n has weight alpha (1 - alpha)^(n - 1 - i), except the
+ * first, which has the remaining weight (1 - alpha)^(n - 1).
+ */
+void testEwmaStatsWeights ()
+{
+    TEST_DEFINE ("EwmaStatsWeights");
+
+    const uint32_t adds = 60;
+    const double alpha = 0.15;
+    EwmaStats<double> stats (alpha);
+    double data[adds];
+    uint32_t state = 31337;
+    bool match = true;
+    for (uint32_t n = 1; n <= adds; n++)
+    {
+        state = state * 1103515245 + 12345;
+        data[n - 1] = 50 + (double) ((state >> 16) % 1000) / 100;
+        stats.add (data[n - 1]);
+
+        double weight[adds];
+        double mean = 0;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            weight[i] = pow (1 - alpha, n - 1 - i) * (i == 0 ? 1 : alpha);
+            mean += weight[i] * data[i];
+        }
+        double variance = 0;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            variance += weight[i] * (data[i] - mean) * (data[i] - mean);
+        }
+        match = match && fabs (stats.getMean () - mean) < 1e-9 &&
+                fabs (stats.getVariance () - variance) < 1e-9;
+    }
+    CHECK_TRUE (match);
+    CHECK_APPROX (stats.getStdev (), sqrt (stats.getVariance ()), 1e-12);
+    CHECK_EQUAL (stats.getAlpha (), alpha);
+
+    // A constant signal has no spread, and clearing restarts from the next
+    // element.
+    stats.clear ();
+    stats.add (-3);
+    stats.add (-3);
+    CHECK_EQUAL (stats.getMean (), -3);
+    CHECK_EQUAL (stats.getStdev (), 0);
+
+    // Stationary noise: uniform on [0, 1) has mean 0.5 and variance 1/12.
+    EwmaStats<> noise (0.002);
+    for (uint32_t i = 0; i < 20000; i++)
+    {
+        state = state * 1103515245 + 12345;
+        noise.add ((Real_t) ((state >> 8) & 0xffff) / 65536);
+    }
+    CHECK_APPROX (noise.getMean (), 0.5, 0.03);
+    CHECK_APPROX (noise.getStdev (), sqrt (1.0 / 12), 0.02);
+}
+
+/**
+ * Tests that a time constant tracker decays by the elapsed time regardless of
+ * the sample intervals.
+ */
+void testTimedEwmaStats ()
+{
+    TEST_DEFINE ("TimedEwmaStats");
+
+    // Step from 0 to 1: after time T the mean is 1 - e^(-T / tau).
+    const Real_t tau = 0.5;
+    TimedEwmaStats<> even (tau);
+    TimedEwmaStats<> jittered (tau);
+    even.add (0, 0);
+    jittered.add (0, 0);
+    Real_t elapsed = 0;
+    uint32_t state = 5;
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        even.add (1, 0.01);
+        state = state * 1103515245 + 12345;
+        const Real_t dt = 0.002 + 0.016 * ((state >> 16) % 100) / 100;
+        if (elapsed + dt < 1)
+        {
+            jittered.add (1, dt);
+            elapsed += dt;
+        }
+    }
+    jittered.add (1, 1 - elapsed);
+    CHECK_APPROX (even.getMean (), (1 - exp (-2.0)), 1e-4);
+    CHECK_APPROX (jittered.getMean (), (1 - exp (-2.0)), 1e-4);
+    CHECK_APPROX (even.getAlpha (), (1 - exp (-0.02)), 1e-6);
+}
+
+/**
+ * Tests crossing detection with hysteresis.
+ */
+void testEwmaCrossover ()
+{
+    TEST_DEFINE ("EwmaCrossover");
+
+    // Accelerometer noise on the pad, then liftoff at 100 Hz.
+    EwmaCrossover<TimedEwmaStats<>> liftoff (TimedEwmaStats<> (0.05),
+                                             TimedEwmaStats<> (2), 5);
+    uint32_t state = 8;
+    int32_t crossingsUp = 0;
+    int32_t crossingsDown = 0;
+    int32_t firstUp = -1;
+    for (int32_t i = 0; i < 400; i++)
+    {
+        state = state * 1103515245 + 12345;
+        const Real_t noise = (Real_t) ((state >> 16) % 200) / 100 - 1;
+        const Real_t accel = (i < 200 ? 9.81 : 60) + noise;
+        const int8_t crossing = liftoff.add (accel, 0.01);
+        crossingsUp += crossing > 0;
+        crossingsDown += crossing < 0;
+        firstUp = crossing > 0 && firstUp < 0 ? i : firstUp;
+    }
+    // Noise within the hysteresis margin never crosses. Liftoff crosses once,
+    // within a few samples.
+    CHECK_EQUAL (crossingsUp, 1);
+    CHECK_EQUAL (crossingsDown, 0);
+    CHECK_TRUE (firstUp >= 200 && firstUp < 210);
+    CHECK_EQUAL (liftoff.getSide (), 1);
+    CHECK_TRUE (liftoff.getSpread () > 5);
+    int8_t burnout = 0;
+    for (int32_t i = 0; i < 50 && burnout == 0; i++)
+    {
+        burnout = liftoff.add (-9.81, 0.01);
+    }
+    CHECK_EQUAL (burnout, -1);
+    CHECK_EQUAL (liftoff.getSide (), -1);
+    CHECK_TRUE (liftoff.getFast ().getMean () < liftoff.getSlow ().getMean ());
+
+    // Fixed factor trackers report the rise after a fall.
+    EwmaCrossover<EwmaStats<>> cross (EwmaStats<> (0.5), EwmaStats<> (0.05));
+    cross.add (10);
+    CHECK_EQUAL (cross.add (0), -1);
+    CHECK_EQUAL (cross.getSide (), -1);
+    int8_t rise = 0;
+    for (int32_t i = 0; i < 10 && rise == 0; i++)
+    {
+        rise = cross.add (20);
+    }
+    CHECK_EQUAL (rise, 1);
+
+    cross.clear ();
+    CHECK_EQUAL (cross.getSide (), 0);
+}
+
+/**
+ * Entry point for exponentially weighted stats tests.
+ */
+void test ()
+{
+    testEwmaStatsWeights ();
+    testTimedEwmaStats ();
+    testEwmaCrossover ();
+}
+
+} // namespace TestEwmaStats
+
+#endif
@@ -0,0 +1,164 @@
+/**
+ * Tests for Fixed.
+ */
+
+#ifndef TEST_FIXED_HPP
+#define TEST_FIXED_HPP
+
+#include "Fixed.hpp"
+#include "History.hpp"
+#include "Matrix.hpp"
+#include "TestMacros.hpp"
+
+using namespace Photic;
+
+namespace TestFixed
+{
+
+/**
+ * Tests conversions to and from fixed point.
+ */
+void testFixedConversion ()
+{
+    TEST_DEFINE ("FixedConversion");
+
+    // Integers and exactly representable reals convert exactly.
+    constexpr Fixed<16> three = 3;
+    CHECK_EQUAL (three.raw (), 3 * 65536);
+    CHECK_EQUAL ((Fixed<16> (-2.5)).raw (), -5 * 32768);
+    CHECK_EQUAL ((double) Fixed<16> (0.75), 0.75);
+    CHECK_EQUAL ((float) Fixed<16>::fromRaw (1), 1.0f / 65536);
+
+    // Other reals round to the nearest representable value.
+    CHECK_EQUAL ((Fixed<4> (0.03)).raw (), 0);
+    CHECK_EQUAL ((Fixed<4> (0.04)).raw (), 1);
+    CHECK_EQUAL ((Fixed<4> (-0.04)).raw (), -1);
+
+    // Out of range values saturate, and NaN converts to 0.
+    CHECK_TRUE (Fixed<16> (40000) == Fixed<16>::max ());
+    CHECK_TRUE (Fixed<16> (-1e9) == Fixed<16>::lowest ());
+    CHECK_EQUAL ((Fixed<16> (NAN)).raw (), 0);
+}
+
+/**
+ * Tests fixed point arithmetic, including saturation.
+ */
+void testFixedArithmetic ()
+{
+    TEST_DEFINE ("FixedArithmetic");
+
+    const Fixed<16> a = 6.25;
+    const Fixed<16> b = -2.5;
+    CHECK_TRUE (a + b == 3.75);
+    CHECK_TRUE (a - b == 8.75);
+    CHECK_TRUE (a * b == -15.625);
+    CHECK_TRUE (a / b == -2.5);
+    CHECK_TRUE (-a == -6.25);
+    CHECK_TRUE (0.5 * a == 3.125);
+    CHECK_TRUE (a < 7 && b <= -2.5 && a > b && a >= 6.25 && a != b);
+
+    Fixed<16> c = 1;
+    c += 2;
+    c *= 3;
+    c -= 1;
+    c /= 4;
+    CHECK_TRUE (c == 2);
+
+    // Products are rounded to nearest.
+    const Fixed<16> lsb = Fixed<16>::fromRaw (1);
+    CHECK_TRUE (lsb * 0.5 == lsb);
+    CHECK_TRUE (lsb * 0.25 == 0);
+
+    // Results out of range saturate instead of wrapping.
+    const Fixed<16> big = 20000;
+    CHECK_TRUE (big + big == Fixed<16>::max ());
+    CHECK_TRUE (-big - big == Fixed<16>::lowest ());
+    CHECK_TRUE (big * -big == Fixed<16>::lowest ());
+    CHECK_TRUE (big / 0.25 == Fixed<16>::max ());
+    CHECK_TRUE (-Fixed<16>::lowest () == Fixed<16>::max ());
+    CHECK_TRUE (a / 0 == Fixed<16>::max ());
+    CHECK_TRUE (b / 0 == Fixed<16>::lowest ());
+
+    // Quotients and reciprocals are within 2 LSB of exact across the range of
+    // divisor magnitudes.
+    bool match = true;
+    for (int32_t i = 1; i < 2000000; i = i * 3 + 1)
+    {
+        const Fixed<16> divisor = Fixed<16>::fromRaw (i);
+        const double exact = 100.0 / (double) divisor;
+        const Fixed<16> quotient = Fixed<16> (100) / divisor;
+        const Fixed<16> recip = reciprocal (-divisor);
+        if (exact < 32767)
+        {
+            match = match && fabs ((double) quotient - exact) <= 2.0 / 65536;
+        }
+        if (exact < 3276700)
+        {
+            match = match &&
+                    fabs ((double) recip + exact / 100) <= 2.0 / 65536;
+        }
+    }
+    CHECK_TRUE (match);
+}
+
+/**
+ * Tests the fixed point math functions.
+ */
+void testFixedMathFunctions ()
+{
+    TEST_DEFINE ("FixedMathFunctions");
+
+    CHECK_TRUE (sqrt (Fixed<16> (16)) == 4);
+    CHECK_TRUE (sqrt (Fixed<16> (0.25)) == 0.5);
+    CHECK_TRUE (sqrt (Fixed<16> (-1)) == 0);
+    CHECK_APPROX ((double) sqrt (Fixed<16> (2)), 1.41421356, 1.0 / 65536);
+    CHECK_APPROX ((double) sqrt (Fixed<12> (400000)), 632.455532, 1.0 / 4096);
+    CHECK_TRUE (fabs (Fixed<16> (-3.5)) == 3.5);
+    CHECK_TRUE (reciprocal (Fixed<16> (8)) == 0.125);
+}
+
+/**
+ * Tests fixed point as the element type of Matrix and History.
+ */
+void testFixedElementType ()
+{
+    TEST_DEFINE ("FixedElementType");
+
+    typedef Fixed<16> Fixed_t;
+    Matrix<2, 2, Fixed_t> a;
+    a (0, 0) = 1;
+    a (0, 1) = 2;
+    a (1, 0) = -0.5;
+    a (1, 1) = 4;
+    Matrix<2, 1, Fixed_t> x (0.5);
+    const Matrix<2, 2, Fixed_t> identity = Matrix<2, 2, Fixed_t>::identity ();
+    Matrix<2, 1, Fixed_t> y = (a + identity) * x * 2;
+    CHECK_TRUE (y (0, 0) == 4);
+    CHECK_TRUE (y (1, 0) == 4.5);
+
+    Matrix<2, 2> f = a.cast<Real_t> ();
+    CHECK_EQUAL (f (1, 0), -0.5);
+
+    History<4, Fixed_t> hist;
+    hist.add (1);
+    hist.add (2);
+    hist.add (3);
+    hist.add (4);
+    CHECK_TRUE (hist.getMean () == 2.5);
+    CHECK_APPROX ((double) hist.getStdev (), 1.118034, 2.0 / 65536);
+}
+
+/**
+ * Entry point for fixed point tests.
+ */
+void test ()
+{
+    testFixedConversion ();
+    testFixedArithmetic ();
+    testFixedMathFunctions ();
+    testFixedElementType ();
+}
+
+} // namespace TestFixed
+
+#endif
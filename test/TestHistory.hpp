@@ -6,6 +6,8 @@
 #define TEST_HISTORY_HPP
 
 #include "History.hpp"
+#include "MedianHistory.hpp"
+#include "MinMaxHistory.hpp"
 #include "TestMacros.hpp"
 
 using namespace Photic;
@@ -76,6 +78,181 @@ void testHistoryCapAndClear ()
     CHECK_EQUAL (hist.getMean (), 2);
 }
 
+/**
+ * Tests histories over other element types and with a wider accumulator.
+ */
+void testHistoryScalarTypes ()
+{
+    TEST_DEFINE ("HistoryScalarTypes");
+
+    // Double history.
+    History<3, double> histD;
+    histD.add (1e-9);
+    histD.add (3e-9);
+    CHECK_APPROX (histD.getMean (), 2e-9, 1e-18);
+
+    // Float storage with double accumulation. Sigma(x^2) is around 4e8 here,
+    // well past the point where float can resolve the spread of the data.
+    History<4, float, double> histW;
+    histW.add (10000);
+    histW.add (10001);
+    histW.add (10002);
+    histW.add (10003);
+    CHECK_EQUAL (histW.getMean (), 10001.5);
+    CHECK_APPROX (histW.getStdev (), 1.1180, 0.0001);
+}
+
+/**
+ * Tests that the running sums track the exact statistics over many windows.
+ */
+void testHistoryRunningStats ()
+{
+    TEST_DEFINE ("HistoryRunningStats");
+
+    // Large offset with small spread, the worst case for running sums. Stop
+    // partway through a window so the sums have not just been recomputed.
+    const uint32_t adds = 10050;
+    History<100> hist;
+    float data[adds];
+    bool meanOk = true;
+    for (uint32_t i = 0; i < adds; i++)
+    {
+        data[i] = 1000 + 3 * sin (0.37 * i) + 0.01 * (i % 7);
+        hist.add (data[i]);
+
+        // Stats are available after every add.
+        const uint32_t n = i < 100 ? i + 1 : 100;
+        double sum = 0;
+        for (uint32_t j = i + 1 - n; j <= i; j++)
+        {
+            sum += data[j];
+        }
+        meanOk = meanOk && fabs (hist.getMean () - sum / n) < 1e-3;
+    }
+    CHECK_TRUE (meanOk);
+
+    // Exact two-pass statistics of the last 100 elements.
+    double mean = 0;
+    for (uint32_t i = adds - 100; i < adds; i++)
+    {
+        mean += data[i] / 100.0;
+    }
+    double variance = 0;
+    for (uint32_t i = adds - 100; i < adds; i++)
+    {
+        variance += (data[i] - mean) * (data[i] - mean) / 100.0;
+    }
+    CHECK_APPROX (hist.getMean (), mean, 1e-3);
+    CHECK_APPROX (hist.getStdev (), sqrt (variance), 1e-3);
+
+    // Identical elements never produce a NaN from a slightly negative
+    // variance.
+    History<7> flat;
+    bool notNan = true;
+    for (uint32_t i = 0; i < 50; i++)
+    {
+        flat.add (0.1f * 3);
+        notNan = notNan && !isnan (flat.getStdev ());
+    }
+    CHECK_TRUE (notNan);
+    flat.clear ();
+    flat.add (5);
+    CHECK_EQUAL (flat.getMean (), 5);
+}
+
+/**
+ * Tests histories with quantized storage.
+ */
+void testHistoryQuantized ()
+{
+    TEST_DEFINE ("HistoryQuantized");
+
+    typedef History<1000, float, float, QuantizedStorage<int16_t>> Quantized_t;
+    CHECK_TRUE (sizeof (Quantized_t) < sizeof (History<1000>) / 2 + 64);
+
+    // Centimeter altitudes relative to the first element match a float
+    // history of the same values rounded to centimeters.
+    Quantized_t hist (QuantizedStorage<int16_t> (0.01));
+    History<1000> exact;
+    for (uint32_t i = 0; i < 1500; i++)
+    {
+        const float alt = 1400 + 4 * sin (0.1 * i) + 0.003 * (i % 5);
+        hist.add (alt);
+        exact.add (1400 + round ((alt - 1400) * 100) / 100);
+    }
+    CHECK_APPROX (hist.getMean (), exact.getMean (), 1e-4);
+    CHECK_APPROX (hist.getStdev (), exact.getStdev (), 1e-4);
+
+    // Fixed offset, rounding and saturation of int8_t storage.
+    History<4, float, float, QuantizedStorage<int8_t>> small (
+        QuantizedStorage<int8_t> (0.5, 10));
+    small.add (10.7);
+    CHECK_EQUAL (small.getMean (), 10.5);
+    small.add (1000);
+    CHECK_EQUAL (small.getMean (), (10.5 + 73.5) / 2);
+    small.clear ();
+    small.add (-1000);
+    CHECK_EQUAL (small.getMean (), -54);
+    CHECK_EQUAL (small.getSaturations (), 2);
+
+    // Derived histories decode the elements they return.
+    MinMaxHistory<3, float, float, QuantizedStorage<int16_t>> minMax (
+        QuantizedStorage<int16_t> (0.25, 100));
+    MedianHistory<3, float, float, QuantizedStorage<int16_t>> median (
+        QuantizedStorage<int16_t> (0.25, 100));
+    const float values[4] = {101, 99.5, 103.25, 97};
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        minMax.add (values[i]);
+        median.add (values[i]);
+    }
+    CHECK_EQUAL (minMax.getMin (), 97);
+    CHECK_EQUAL (minMax.getMax (), 103.25);
+    CHECK_EQUAL (median.getMedian (), 99.5);
+}
+
+/**
+ * Tests that quantized storage with no fixed offset follows a signal that
+ * drifts across several full ranges of the stored integers.
+ */
+void testHistoryQuantizedDrift ()
+{
+    TEST_DEFINE ("HistoryQuantizedDrift");
+
+    // A climb of 2000 m at 1 m per sample crosses the 655 m range of
+    // centimeter int16_t storage three times, with 200 m in each window.
+    History<200, float, double, QuantizedStorage<int16_t>> hist (
+        QuantizedStorage<int16_t> (0.01));
+    MedianHistory<200, float, double, QuantizedStorage<int16_t>> median (
+        QuantizedStorage<int16_t> (0.01));
+    History<200, double> exact;
+    const float first = 100;
+    bool match = true;
+    for (uint32_t i = 0; i < 2000; i++)
+    {
+        const float alt = first + i + 0.5 * sin (0.3 * i);
+        hist.add (alt);
+        median.add (alt);
+        exact.add (first + round ((alt - first) * 100) / 100);
+        match = match && fabs (hist.getMean () - exact.getMean ()) < 1e-3 &&
+                fabs (hist.getStdev () - exact.getStdev ()) < 1e-3;
+    }
+    CHECK_TRUE (match);
+    CHECK_EQUAL (hist.getSaturations (), 0);
+    CHECK_APPROX (median.getMedian (), exact.getMean (), 1);
+    CHECK_APPROX (median.getPercentile (100), (first + 1999), 1);
+
+    // A window spread wider than the range saturates, which is counted.
+    History<4, float, float, QuantizedStorage<int8_t>> wide (
+        QuantizedStorage<int8_t> (0.5));
+    wide.add (0);
+    wide.add (100);
+    CHECK_EQUAL (wide.getSaturations (), 0);
+    CHECK_EQUAL (wide.getMean (), 50);
+    wide.add (200);
+    CHECK_EQUAL (wide.getSaturations (), 1);
+}
+
 /**
  * Entry point for history tests.
  */
@@ -83,6 +260,10 @@ void test ()
 {
     testHistoryStats ();
     testHistoryCapAndClear ();
+    testHistoryScalarTypes ();
+    testHistoryRunningStats ();
+    testHistoryQuantized ();
+    testHistoryQuantizedDrift ();
 }
 
 } // namespace TestHistory
@@ -32,7 +32,7 @@ namespace TestKalmanFilter
  * fail. As long as it fails very, very rarely, the Kalman filter is working
  * satisfactorily.
  */
-void test ()
+void testKalmanFilterAccuracyIncrease ()
 {
     TEST_DEFINE ("KalmanFilterAccuracyIncrease");
 
@@ -115,6 +115,53 @@ void test ()
     CHECK_TRUE (accelPercentError < 0.01);
 }
 
+/**
+ * Tests that a double precision filter tracks the Real_t filter on the same
+ * noiseless observations.
+ */
+void testKalmanFilterScalarTypes ()
+{
+    TEST_DEFINE ("KalmanFilterScalarTypes");
+
+    const Real_t tStep = 0.1;
+    KalmanFilter kf;
+    BasicKalmanFilter<double> kfD;
+    kf.setDeltaT (tStep);
+    kfD.setDeltaT (tStep);
+    kf.setSensorVariance (15.45, 1.8);
+    kfD.setSensorVariance (15.45, 1.8);
+    kf.setInitialState (0, 0, 0);
+    kfD.setInitialState (0, 0, 0);
+    kf.computeKg (100);
+    kfD.computeKg (100);
+
+    Vector3_t state (0);
+    Matrix<3, 1, double> stateD (0);
+    double pos = 0;
+    double vel = 0;
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        vel += 9.81 * tStep;
+        pos += vel * tStep;
+        state = kf.filter (pos, 9.81);
+        stateD = kfD.filter (pos, 9.81);
+    }
+
+    for (Dim_t i = 0; i < 3; i++)
+    {
+        CHECK_APPROX (state[i], stateD[i], fabs (stateD[i]) * 0.001);
+    }
+}
+
+/**
+ * Entry point for Kalman filter tests.
+ */
+void test ()
+{
+    testKalmanFilterAccuracyIncrease ();
+    testKalmanFilterScalarTypes ();
+}
+
 } // namespace TestKalmanFilter
 
 #endif
\ No newline at end of file
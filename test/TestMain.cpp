@@ -3,12 +3,28 @@
  */
 
 #include "TestMatrix.hpp"
+#include "TestSymmetricMatrix.hpp"
+#include "TestStructuredMatrix.hpp"
+#include "TestMatrixFactorization.hpp"
+#include "TestMatrixView.hpp"
+#include "TestMatrixBatch.hpp"
+#include "TestFixed.hpp"
 #include "TestMathUtils.hpp"
+#include "TestQuaternion.hpp"
 #include "TestKalmanFilter.hpp"
 #include "TestIMUInterface.hpp"
 #include "TestBarometerInterface.hpp"
 #include "TestHistory.hpp"
+#include "TestMinMaxHistory.hpp"
+#include "TestMedianHistory.hpp"
+#include "TestVectorHistory.hpp"
+#include "TestTieredHistory.hpp"
+#include "TestTimedHistory.hpp"
+#include "TestRegressionHistory.hpp"
+#include "TestEwmaStats.hpp"
 #include "TestRocketTracker.hpp"
+#include "TestSpscHistory.hpp"
+#include "TestQuantileSketch.hpp"
 
 int main (int ac, char** av)
 {
@@ -16,15 +32,31 @@ int main (int ac, char** av)
 
     // Tests with no dependencies that should run on any platform.
     TestMatrix::test ();
+    TestSymmetricMatrix::test ();
+    TestStructuredMatrix::test ();
+    TestMatrixFactorization::test ();
+    TestMatrixView::test ();
+    TestMatrixBatch::test ();
+    TestFixed::test ();
     TestMathUtils::test ();
+    TestQuaternion::test ();
     TestIMUInterface::test ();
     TestBarometerInterface::test ();
     TestHistory::test ();
+    TestMinMaxHistory::test ();
+    TestMedianHistory::test ();
+    TestVectorHistory::test ();
+    TestTieredHistory::test ();
+    TestTimedHistory::test ();
+    TestRegressionHistory::test ();
+    TestEwmaStats::test ();
 
     // Tests that rely on specific STL components that may or may not be
     // available on the target platform.
     TestKalmanFilter::test ();
     TestRocketTracker::test ();
+    TestSpscHistory::test ();
+    TestQuantileSketch::test ();
 
     SUITE_END;
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 #ifndef TEST_MATH_UTILS_HPP
 #define TEST_MATH_UTILS_HPP
 
+#include <time.h>
+
 #include "MathUtils.hpp"
 #include "TestMacros.hpp"
 
@@ -160,6 +162,219 @@ void testMathUtilsRotateVector ()
     CHECK_APPROX (result[0], vecRot[0], 1e-3);
     CHECK_APPROX (result[1], vecRot[1], 1e-3);
     CHECK_APPROX (result[2], vecRot[2], 1e-3);
+
+    // Destination-passing variant writes the same result.
+    Vector3_t vecRotInto;
+    MathUtils::rotateVectorInto (vecRotInto, quat, vec);
+    CHECK_TRUE (vecRotInto == vecRot);
+}
+
+/**
+ * Tests single-component and batch rotation against rotating one vector at a
+ * time.
+ */
+void testMathUtilsRotateVectorBatch ()
+{
+    TEST_DEFINE ("MathUtilsRotateVectorBatch");
+
+    // 23 samples exercise both the 4-wide kernels and the remainder loop.
+    // Arrays start one element in so vectorized loads are unaligned.
+    const uint32_t count = 23;
+    Real_t quat[4][count + 1];
+    Real_t vec[3][count + 1];
+    Vector4_t quats[count];
+    Vector3_t vecs[count];
+    for (uint32_t i = 0; i < count; i++)
+    {
+        quats[i] = MathUtils::makeVector4 (0.9 - 0.05 * i, 0.1 * i - 1,
+                                           0.3 + 0.02 * i * i, -0.4);
+        quats[i] *= 1 / sqrt ((quats[i].transpose () * quats[i]) (0, 0));
+        vecs[i] = MathUtils::makeVector3 (0.8 * i - 9.81, 2 - 0.1 * i, 0.5);
+        for (Dim_t j = 0; j < 4; j++)
+        {
+            quat[j][i + 1] = quats[i][j];
+        }
+        for (Dim_t j = 0; j < 3; j++)
+        {
+            vec[j][i + 1] = vecs[i][j];
+        }
+    }
+
+    const Real_t* const quatArrays[4] = {quat[0] + 1, quat[1] + 1,
+                                         quat[2] + 1, quat[3] + 1};
+    const Real_t* const vecArrays[3] = {vec[0] + 1, vec[1] + 1, vec[2] + 1};
+    Real_t world[3][count];
+    Real_t* const worldArrays[3] = {world[0], world[1], world[2]};
+    Real_t vertical[count];
+    MathUtils::rotateVectorBatch (quatArrays, vecArrays, worldArrays, count);
+    MathUtils::rotateVectorComponentBatch (quatArrays, vecArrays, 2, vertical,
+                                           count);
+
+    // Every path matches rotateVector exactly.
+    bool match = true;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const Vector3_t expected = MathUtils::rotateVector (quats[i], vecs[i]);
+        for (Dim_t j = 0; j < 3; j++)
+        {
+            match = match && world[j][i] == expected[j] &&
+                    MathUtils::rotateVectorComponent (quats[i], vecs[i], j) ==
+                        expected[j];
+        }
+        match = match && vertical[i] == expected[2];
+    }
+    CHECK_TRUE (match);
+
+    // Rotating in place.
+    Real_t* const inPlace[3] = {vec[0] + 1, vec[1] + 1, vec[2] + 1};
+    MathUtils::rotateVectorBatch (quatArrays, vecArrays, inPlace, count);
+    CHECK_EQUAL (vec[1][count], world[1][count - 1]);
+    CHECK_EQUAL (vec[0][1], world[0][0]);
+}
+
+/**
+ * Tracks the largest of a series of errors.
+ *
+ * @param   kMax Largest error so far.
+ * @param   kErr Next error.
+ */
+void trackMaxError (double& kMax, const double kErr)
+{
+    kMax = kErr > kMax ? kErr : kMax;
+}
+
+/**
+ * Tests the fast approximations against the exact functions across their
+ * domains.
+ */
+void testMathUtilsFastAccuracy ()
+{
+    TEST_DEFINE ("MathUtilsFastAccuracy");
+
+    double sqrtErr = 0;
+    double logErr = 0;
+    for (float x = 1e-30; x < 1e30; x *= 1.01)
+    {
+        const double root = sqrt ((double) x);
+        trackMaxError (sqrtErr, fabs (MathUtils::Fast::sqrt (x) / root - 1));
+
+        // Log error is relative to the result once it exceeds 1.
+        const double exact = log ((double) x);
+        trackMaxError (logErr, fabs (MathUtils::Fast::log (x) - exact) /
+                                   (fabs (exact) > 1 ? fabs (exact) : 1));
+    }
+    for (float x = 0.5; x < 2; x += 1e-4)
+    {
+        trackMaxError (logErr,
+                       fabs (MathUtils::Fast::log (x) - log ((double) x)));
+    }
+
+    double atan2Err = 0;
+    for (float angle = -M_PI; angle <= M_PI; angle += 1e-3)
+    {
+        for (float radius = 1e-3; radius < 1e4; radius *= 10)
+        {
+            const float y = radius * sin (angle);
+            const float x = radius * cos (angle);
+            trackMaxError (atan2Err, fabs (MathUtils::Fast::atan2 (y, x) -
+                                           atan2 ((double) y, (double) x)));
+        }
+    }
+
+    double asinErr = 0;
+    for (float x = -1; x <= 1; x += 1e-4)
+    {
+        trackMaxError (asinErr,
+                       fabs (MathUtils::Fast::asin (x) - asin ((double) x)));
+    }
+
+    double expErr = 0;
+    for (float x = -87; x <= 88; x += 1e-2)
+    {
+        trackMaxError (expErr,
+                       fabs (MathUtils::Fast::exp (x) / exp ((double) x) - 1));
+    }
+
+    // Bases and exponents with |y ln (x)| <= 10, including the barometric
+    // formula's exponent.
+    double powErr = 0;
+    for (float base = 0.01; base < 100; base *= 1.05)
+    {
+        for (float exponent = -2; exponent <= 2; exponent += 0.0625)
+        {
+            const double exact = pow ((double) base, (double) exponent);
+            trackMaxError (powErr,
+                           fabs (MathUtils::Fast::pow (base, exponent) / exact -
+                                 1));
+        }
+        const double exact = pow ((double) base, 0.190263);
+        trackMaxError (powErr,
+                       fabs (MathUtils::Fast::pow (base, 0.190263f) / exact -
+                             1));
+    }
+
+    PRINTF ("    max error: sqrt %.3g, log %.3g, atan2 %.3g, asin %.3g, "
+            "exp %.3g, pow %.3g\n",
+            sqrtErr, logErr, atan2Err, asinErr, expErr, powErr);
+    CHECK_TRUE (sqrtErr < 5e-6);
+    CHECK_TRUE (logErr < 2e-7);
+    CHECK_TRUE (atan2Err < 1.5e-5);
+    CHECK_TRUE (asinErr < 1e-5);
+    CHECK_TRUE (expErr < 1e-6);
+    CHECK_TRUE (powErr < 2e-6);
+
+    // Special values.
+    CHECK_EQUAL (MathUtils::Fast::sqrt (0.0f), 0);
+    CHECK_EQUAL (MathUtils::Fast::atan2 (0.0f, 0.0f), 0);
+    CHECK_APPROX (MathUtils::Fast::atan2 (0.0f, -1.0f), M_PI, 1e-6);
+    CHECK_APPROX (MathUtils::Fast::asin (-1.0f), -M_PI_2, 1e-6);
+    CHECK_EQUAL (MathUtils::Fast::pow (0.0f, 2.0f), 0);
+    CHECK_TRUE (MathUtils::Fast::exp (1000.0f) > 1e38);
+
+    // Other element types use the exact functions.
+    CHECK_EQUAL (MathUtils::Fast::atan2 (1.0, 2.0), atan2 (1.0, 2.0));
+    CHECK_EQUAL (MathUtils::Fast::pow (3.0, 0.5), pow (3.0, 0.5));
+}
+
+/**
+ * Times the fast approximations against the exact functions. Timings are
+ * printed rather than checked, since they depend on the machine and build.
+ */
+void testMathUtilsFastThroughput ()
+{
+    TEST_DEFINE ("MathUtilsFastThroughput");
+
+    const uint32_t calls = 200000;
+    volatile float sink = 0;
+    float fastSum = 0;
+    float exactSum = 0;
+
+    clock_t start = clock ();
+    for (uint32_t i = 0; i < calls; i++)
+    {
+        const float x = 1e-4f * i;
+        fastSum += MathUtils::Fast::atan2 (x - 10, 3.0f) +
+                   MathUtils::Fast::asin (x * 0.05f - 0.5f) +
+                   MathUtils::Fast::pow (x + 1, 0.190263f) +
+                   MathUtils::Fast::exp (-x) + MathUtils::Fast::sqrt (x);
+    }
+    const double fastNs = 1e9 * (clock () - start) / CLOCKS_PER_SEC / calls;
+    sink = fastSum;
+
+    start = clock ();
+    for (uint32_t i = 0; i < calls; i++)
+    {
+        const float x = 1e-4f * i;
+        exactSum += atan2f (x - 10, 3.0f) + asinf (x * 0.05f - 0.5f) +
+                    powf (x + 1, 0.190263f) + expf (-x) + sqrtf (x);
+    }
+    const double exactNs = 1e9 * (clock () - start) / CLOCKS_PER_SEC / calls;
+    sink = exactSum;
+    (void) sink;
+
+    PRINTF ("    atan2+asin+pow+exp+sqrt: fast %.1f ns, math.h %.1f ns\n",
+            fastNs, exactNs);
+    CHECK_APPROX (fastSum / exactSum, 1, 1e-4);
 }
 
 void test ()
@@ -169,6 +384,9 @@ void test ()
     testMathUtilsMatrixInvertMatrix2 ();
     testMathUtilsCrossProduct ();
     testMathUtilsRotateVector ();
+    testMathUtilsRotateVectorBatch ();
+    testMathUtilsFastAccuracy ();
+    testMathUtilsFastThroughput ();
 }
 
 } // namespace TestMathUtils
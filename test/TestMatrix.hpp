@@ -184,6 +184,423 @@ void testMatrixTranspose ()
     CHECK_EQUAL (mat1 (2, 1), 6);
 }
 
+/**
+ * Tests that chained expressions evaluate to the same result as evaluating
+ * each operation separately.
+ */
+void testMatrixExpressionChain ()
+{
+    TEST_DEFINE ("MatrixExpressionChain");
+
+    Matrix<3, 3> a = MathUtils::makeMatrix3 (1, 2, 3,
+                                             4, 5, 6,
+                                             7, 8, 9);
+    Matrix<3, 3> p = MathUtils::makeMatrix3 (-5,  0, 10,
+                                              2, -4, 53,
+                                              1,  1, 7);
+    Matrix<3, 3> q = MathUtils::makeMatrix3 (1, 0, 0,
+                                             0, 2, 0,
+                                             0, 0, 3);
+
+    // Evaluate a * p * a^T + q one operation at a time.
+    Matrix<3, 3> ap = a * p;
+    Matrix<3, 3> at = a.transpose ();
+    Matrix<3, 3> apat = ap * at;
+    Matrix<3, 3> expected = apat + q;
+
+    Matrix<3, 3> result = a * p * a.transpose () + q;
+    CHECK_TRUE (result == expected);
+
+    // Transpose and scale of a compound expression.
+    Matrix<3, 3> sum = a + p;
+    Matrix<3, 3> sumT = sum.transpose ();
+    Matrix<3, 3> sumTScaled = sumT * 2;
+    result = (a + p).transpose () * 2;
+    CHECK_TRUE (result == sumTScaled);
+
+    // Product of two compound expressions.
+    Matrix<3, 3> diff = a - q;
+    expected = sum * diff;
+    result = (a + p) * (a - q);
+    CHECK_TRUE (result == expected);
+}
+
+/**
+ * Tests assigning an expression to a matrix that the expression reads from.
+ */
+void testMatrixExpressionAliasing ()
+{
+    TEST_DEFINE ("MatrixExpressionAliasing");
+
+    const Matrix<3, 3> a = MathUtils::makeMatrix3 (1, 2, 3,
+                                                   4, 5, 6,
+                                                   7, 8, 9);
+    const Matrix<3, 3> b = MathUtils::makeMatrix3 (-5,  0, 10,
+                                                    2, -4, 53,
+                                                    1,  1, 7);
+
+    // Destination on the left of a product.
+    Matrix<3, 3> mat0 = a;
+    Matrix<3, 3> expected = a * b;
+    mat0 = mat0 * b;
+    CHECK_TRUE (mat0 == expected);
+
+    // Destination on the right of a product.
+    mat0 = b;
+    expected = a * b;
+    mat0 = a * mat0;
+    CHECK_TRUE (mat0 == expected);
+
+    // Destination transposed into itself.
+    mat0 = a;
+    expected = a.transpose ();
+    mat0 = mat0.transpose ();
+    CHECK_TRUE (mat0 == expected);
+
+    // Destination in an element-wise expression and a product.
+    mat0 = a;
+    expected = a + a * b - b;
+    mat0 = mat0 + mat0 * b - b;
+    CHECK_TRUE (mat0 == expected);
+}
+
+/**
+ * Tests the in-place compound assignment operators.
+ */
+void testMatrixCompoundAssignment ()
+{
+    TEST_DEFINE ("MatrixCompoundAssignment");
+
+    const Matrix<3, 3> a = MathUtils::makeMatrix3 (1, 2, 3,
+                                                   4, 5, 6,
+                                                   7, 8, 9);
+    const Matrix<3, 3> b = MathUtils::makeMatrix3 (-5,  0, 10,
+                                                    2, -4, 53,
+                                                    1,  1, 7);
+
+    Matrix<3, 3> mat0 = a;
+    Matrix<3, 3> expected = a + b;
+    mat0 += b;
+    CHECK_TRUE (mat0 == expected);
+
+    expected = expected - a * b;
+    mat0 -= a * b;
+    CHECK_TRUE (mat0 == expected);
+
+    expected = expected * -3;
+    mat0 *= -3;
+    CHECK_TRUE (mat0 == expected);
+
+    // Square right-multiplication, including by an expression that reads the
+    // destination.
+    expected = expected * b;
+    mat0 *= b;
+    CHECK_TRUE (mat0 == expected);
+
+    expected = expected * expected.transpose ();
+    mat0 *= mat0.transpose ();
+    CHECK_TRUE (mat0 == expected);
+
+    // Non-square LHS.
+    Matrix<2, 3> mat1;
+    mat1 (0, 0) = 1; mat1 (0, 1) = 2; mat1 (0, 2) = 3;
+    mat1 (1, 0) = 4; mat1 (1, 1) = 5; mat1 (1, 2) = 6;
+    Matrix<2, 3> expected1 = mat1 * a;
+    mat1 *= a;
+    CHECK_TRUE (mat1 == expected1);
+}
+
+/**
+ * Tests the destination-passing multiplication kernels.
+ */
+void testMatrixMultiplyInto ()
+{
+    TEST_DEFINE ("MatrixMultiplyInto");
+
+    const Matrix<3, 3> a = MathUtils::makeMatrix3 (1, 2, 3,
+                                                   4, 5, 6,
+                                                   7, 8, 9);
+    const Matrix<3, 3> b = MathUtils::makeMatrix3 (-5,  0, 10,
+                                                    2, -4, 53,
+                                                    1,  1, 7);
+    const Matrix<3, 3> c = MathUtils::makeMatrix3 (3, 1, 4,
+                                                   1, 5, 9,
+                                                   2, 6, 5);
+
+    Matrix<3, 3> mat0;
+    Matrix<3, 3> expected = a * b;
+    multiplyInto (mat0, a, b);
+    CHECK_TRUE (mat0 == expected);
+
+    mat0 = c;
+    expected = c + a * b;
+    multiplyAddInto (mat0, a, b);
+    CHECK_TRUE (mat0 == expected);
+
+    mat0 = c;
+    expected = c - a * b;
+    multiplySubtractInto (mat0, a, b);
+    CHECK_TRUE (mat0 == expected);
+
+    expected = a * b.transpose ();
+    multiplyTransposedInto (mat0, a, b);
+    CHECK_TRUE (mat0 == expected);
+
+    mat0 = c;
+    expected = c + a * b.transpose ();
+    multiplyTransposedAddInto (mat0, a, b);
+    CHECK_TRUE (mat0 == expected);
+
+    // Non-square operands.
+    Matrix<2, 3> h (0);
+    h (0, 0) = 1;
+    h (1, 2) = 1;
+    Matrix<3, 2> pht;
+    multiplyTransposedInto (pht, a, h);
+    CHECK_EQUAL (pht (0, 0), 1);
+    CHECK_EQUAL (pht (0, 1), 3);
+    CHECK_EQUAL (pht (1, 0), 4);
+    CHECK_EQUAL (pht (1, 1), 6);
+    CHECK_EQUAL (pht (2, 0), 7);
+    CHECK_EQUAL (pht (2, 1), 9);
+}
+
+/**
+ * Tests constexpr construction of zero and identity matrices.
+ */
+void testMatrixZeroIdentity ()
+{
+    TEST_DEFINE ("MatrixZeroIdentity");
+
+    constexpr Matrix<3, 3> identity = Matrix<3, 3>::identity ();
+    static_assert (identity (0, 0) == 1 && identity (1, 1) == 1 &&
+                   identity (2, 2) == 1 && identity (0, 1) == 0 &&
+                   identity (2, 0) == 0, "Identity is not constexpr");
+    CHECK_TRUE (identity == MathUtils::makeMatrix3 (1, 0, 0,
+                                                    0, 1, 0,
+                                                    0, 0, 1));
+
+    constexpr Matrix<2, 3> zero = Matrix<2, 3>::zero ();
+    Matrix<2, 3> expected (0);
+    CHECK_TRUE (zero == expected);
+
+    // Non-square identity has ones on the main diagonal only.
+    Matrix<2, 3> identity1 = Matrix<2, 3>::identity ();
+    expected (0, 0) = 1;
+    expected (1, 1) = 1;
+    CHECK_TRUE (identity1 == expected);
+}
+
+/**
+ * Tests arithmetic on matrices too large to be unrolled, which take the
+ * runtime loop kernels.
+ */
+void testMatrixLargeArithmetic ()
+{
+    TEST_DEFINE ("MatrixLargeArithmetic");
+
+    Matrix<5, 6> a;
+    Matrix<6, 5> b;
+    for (uint32_t i = 0; i < 30; i++)
+    {
+        a.mData[i] = (Real_t) (i % 7) - 3;
+        b.mData[i] = (Real_t) (i % 5) * 2 - 1;
+    }
+
+    // Compare product against a straightforward reference.
+    Matrix<5, 5> expected;
+    for (Dim_t i = 0; i < 5; i++)
+    {
+        for (Dim_t j = 0; j < 5; j++)
+        {
+            Real_t elem = 0;
+            for (Dim_t k = 0; k < 6; k++)
+            {
+                elem += a (i, k) * b (k, j);
+            }
+            expected (i, j) = elem;
+        }
+    }
+
+    Matrix<5, 5> mat0 = a * b;
+    CHECK_TRUE (mat0 == expected);
+    multiplyInto (mat0, a, b);
+    CHECK_TRUE (mat0 == expected);
+
+    // Sum with a transpose and in-place scaling.
+    Matrix<5, 6> mat1 = a + b.transpose ();
+    mat1 *= 2;
+    bool match = true;
+    for (Dim_t i = 0; i < 5; i++)
+    {
+        for (Dim_t j = 0; j < 6; j++)
+        {
+            match = match && (mat1 (i, j) == (a (i, j) + b (j, i)) * 2);
+        }
+    }
+    CHECK_TRUE (match);
+}
+
+/**
+ * Tests that the kernels with vectorized variants (element-wise expressions,
+ * products with packet-wide rows, and 4x4 transposes) match a plain scalar
+ * reference bit-for-bit. Without a vectorized backend this checks the scalar
+ * kernels against the same reference. See MatrixSimd.hpp for the tolerance
+ * when the compiler contracts scalar multiply-adds.
+ */
+void testMatrixSimdParity ()
+{
+    TEST_DEFINE ("MatrixSimdParity");
+
+    Matrix<4, 4> a;
+    Matrix<4, 4> b;
+    Matrix<3, 4> c;
+    Matrix<3, 3> d;
+    Matrix<3, 3> e;
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        a.mData[i] = (Real_t) 0.1 * i - 0.7;
+        b.mData[i] = (Real_t) 1.3 / (i + 1);
+    }
+    for (uint32_t i = 0; i < 12; i++)
+    {
+        c.mData[i] = (Real_t) 0.37 * i * i - 2;
+    }
+    for (uint32_t i = 0; i < 9; i++)
+    {
+        d.mData[i] = (Real_t) 3.1 - 0.45 * i;
+        e.mData[i] = (Real_t) 0.01 * i + 0.5;
+    }
+
+    // Products.
+    Matrix<4, 4> ab = a * b;
+    Matrix<3, 4> cb = c * b;
+    bool match = true;
+    for (Dim_t i = 0; i < 4; i++)
+    {
+        for (Dim_t j = 0; j < 4; j++)
+        {
+            Real_t elemAb = 0;
+            Real_t elemCb = 0;
+            for (Dim_t k = 0; k < 4; k++)
+            {
+                elemAb += a (i, k) * b (k, j);
+                elemCb += (i < 3 ? c (i, k) : 0) * b (k, j);
+            }
+            match = match && ab (i, j) == elemAb;
+            match = match && (i == 3 || cb (i, j) == elemCb);
+        }
+    }
+    CHECK_TRUE (match);
+
+    // Accumulating product.
+    Matrix<3, 4> cbAcc = c;
+    multiplyAddInto (cbAcc, c, b);
+    match = true;
+    for (uint32_t i = 0; i < 12; i++)
+    {
+        Real_t expected = c.mData[i];
+        expected += cb.mData[i];
+        match = match && cbAcc.mData[i] == expected;
+    }
+    CHECK_TRUE (match);
+
+    // 4x4 transpose.
+    Matrix<4, 4> at = a.transpose ();
+    match = true;
+    for (Dim_t i = 0; i < 4; i++)
+    {
+        for (Dim_t j = 0; j < 4; j++)
+        {
+            match = match && at (i, j) == a (j, i);
+        }
+    }
+    CHECK_TRUE (match);
+
+    // Element-wise expressions with a partial trailing packet, including
+    // scaling by an int (vectorized) and a double (not vectorized).
+    Matrix<3, 3> f = d + e * 3 - d * 0.5;
+    Matrix<3, 3> g = d;
+    g -= e;
+    g += d * 2;
+    match = true;
+    for (uint32_t i = 0; i < 9; i++)
+    {
+        Real_t elemF = d.mData[i] + (Real_t) (e.mData[i] * 3);
+        elemF = elemF - (Real_t) (d.mData[i] * 0.5);
+        Real_t elemG = d.mData[i];
+        elemG -= e.mData[i];
+        elemG += (Real_t) (d.mData[i] * 2);
+        match = match && f.mData[i] == elemF && g.mData[i] == elemG;
+    }
+    CHECK_TRUE (match);
+}
+
+/**
+ * Tests matrices over element types other than Real_t, conversions between
+ * them, and opt-in wide accumulation of products.
+ */
+void testMatrixScalarTypes ()
+{
+    TEST_DEFINE ("MatrixScalarTypes");
+
+    // Double matrices support the same arithmetic as Real_t matrices.
+    Matrix<3, 3, double> a;
+    Matrix<3, 3, double> b;
+    for (uint32_t i = 0; i < 9; i++)
+    {
+        a.mData[i] = i + 0.5;
+        b.mData[i] = 9.0 - i;
+    }
+    Matrix<3, 3, double> c = a * b + a.transpose () * 2.0 - b;
+    for (Dim_t i = 0; i < 3; i++)
+    {
+        for (Dim_t j = 0; j < 3; j++)
+        {
+            double elem = 0;
+            for (Dim_t k = 0; k < 3; k++)
+            {
+                elem += a (i, k) * b (k, j);
+            }
+            elem = elem + a (j, i) * 2.0 - b (i, j);
+            CHECK_EQUAL (c (i, j), elem);
+        }
+    }
+    const Matrix<3, 3, double> identity = Matrix<3, 3, double>::identity ();
+    const Matrix<3, 3, double> ai = a * identity;
+    CHECK_TRUE (ai == a);
+
+    // Integer matrices.
+    Matrix<2, 2, int32_t> m (3);
+    m += Matrix<2, 2, int32_t>::identity ();
+    Matrix<2, 1, int32_t> v (2);
+    Matrix<2, 1, int32_t> mv = m * v;
+    CHECK_EQUAL (mv (0, 0), 14);
+    CHECK_EQUAL (mv (1, 0), 14);
+
+    // Conversions between element types.
+    Matrix<3, 3> f = a.cast<Real_t> ();
+    Matrix<3, 3, int32_t> n = (a * 2.0).cast<int32_t> ();
+    for (uint32_t i = 0; i < 9; i++)
+    {
+        CHECK_EQUAL (f.mData[i], (Real_t) a.mData[i]);
+        CHECK_EQUAL (n.mData[i], (int32_t) (2 * i + 1));
+    }
+
+    // Products accumulate in the element type unless a wider accumulator is
+    // requested. 2^24 + 1 is not representable in float, so the narrow sum
+    // rounds away the small term that the wide sum keeps.
+    Matrix<1, 3, float> row;
+    row (0, 0) = 16777216;
+    row (0, 1) = 1;
+    row (0, 2) = -16777216;
+    const Matrix<3, 1, float> ones (1);
+    Matrix<1, 1, float> narrow = row * ones;
+    Matrix<1, 1, float> wide = product<double> (row, ones);
+    CHECK_EQUAL (narrow (0, 0), 0);
+    CHECK_EQUAL (wide (0, 0), 1);
+}
+
 /**
  * Entry point for matrix tests.
  */
@@ -196,6 +613,14 @@ void test ()
     testMatrixMultiplication ();
     testMatrixScalarMultiplication ();
     testMatrixTranspose ();
+    testMatrixExpressionChain ();
+    testMatrixExpressionAliasing ();
+    testMatrixCompoundAssignment ();
+    testMatrixMultiplyInto ();
+    testMatrixZeroIdentity ();
+    testMatrixLargeArithmetic ();
+    testMatrixSimdParity ();
+    testMatrixScalarTypes ();
 }
 
 } // namespace TestMatrix
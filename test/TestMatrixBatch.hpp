@@ -0,0 +1,178 @@
+/**
+ * Tests for MatrixBatch.
+ */
+
+#ifndef TEST_MATRIX_BATCH_HPP
+#define TEST_MATRIX_BATCH_HPP
+
+#include "Matrix.hpp"
+#include "MatrixBatch.hpp"
+#include "SymmetricMatrix.hpp"
+#include "TestMacros.hpp"
+
+using namespace Photic;
+
+namespace TestMatrixBatch
+{
+
+/**
+ * Fills an array of matrices with distinct values per instance.
+ *
+ * @param   kMats Destination matrices.
+ * @param   kSeed Offset to distinguish arrays.
+ */
+template <Dim_t T_Rows, Dim_t T_Cols, uint32_t T_Lanes>
+void makeInstances (Matrix<T_Rows, T_Cols> (&kMats)[T_Lanes],
+                    const Real_t kSeed)
+{
+    for (uint32_t lane = 0; lane < T_Lanes; lane++)
+    {
+        for (Dim_t i = 0; i < T_Rows; i++)
+        {
+            for (Dim_t j = 0; j < T_Cols; j++)
+            {
+                kMats[lane] (i, j) =
+                    kSeed + 0.37 * lane - 1.3 * i + 0.71 * j * j;
+            }
+        }
+    }
+}
+
+/**
+ * Computes a covariance-style update on batches and on each instance alone.
+ *
+ * @ret     If every lane of the batched result matches its instance exactly.
+ */
+template <uint32_t T_Lanes>
+bool checkLockstep ()
+{
+    Matrix<3, 3> a[T_Lanes];
+    Matrix<3, 3> p[T_Lanes];
+    Matrix<3, 2> h[T_Lanes];
+    makeInstances (a, 0.25);
+    makeInstances (p, -2);
+    makeInstances (h, 1);
+
+    MatrixBatch<3, 3, T_Lanes> aBatch;
+    MatrixBatch<3, 3, T_Lanes> pBatch;
+    MatrixBatch<3, 2, T_Lanes> hBatch;
+    batchGather (aBatch, a);
+    batchGather (pBatch, p);
+    batchGather (hBatch, h);
+
+    // Batched.
+    MatrixBatch<3, 3, T_Lanes> apBatch;
+    multiplyInto (apBatch, aBatch, pBatch);
+    pBatch = apBatch * aBatch.transpose () - pBatch * 0.5f;
+    pBatch += Matrix<3, 3, BatchScalar<T_Lanes>>::identity ();
+    MatrixBatch<2, 2, T_Lanes> sBatch = hBatch.transpose () * pBatch * hBatch;
+    Matrix<2, 2> s[T_Lanes];
+    batchScatter (sBatch, s);
+
+    // One instance at a time.
+    bool match = true;
+    for (uint32_t lane = 0; lane < T_Lanes; lane++)
+    {
+        Matrix<3, 3> ap;
+        multiplyInto (ap, a[lane], p[lane]);
+        p[lane] = ap * a[lane].transpose () - p[lane] * 0.5f;
+        p[lane] += Matrix<3, 3>::identity ();
+        const Matrix<2, 2> sLane = h[lane].transpose () * p[lane] * h[lane];
+        match = match && s[lane] == sLane &&
+                batchLane (pBatch, lane) == p[lane];
+    }
+
+    return match;
+}
+
+/**
+ * Tests lane-wise BatchScalar arithmetic, on both vectorized and looped lane
+ * counts.
+ */
+void testMatrixBatchScalar ()
+{
+    TEST_DEFINE ("MatrixBatchScalar");
+
+    BatchScalar<8> x;
+    BatchScalar<5> y;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        x[i] = i + 1;
+    }
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        y[i] = 4 * i;
+    }
+
+    const BatchScalar<8> xr = (x * x + 2 - x) / 2;
+    CHECK_EQUAL (xr[0], 1);
+    CHECK_EQUAL (xr[7], 29);
+    const BatchScalar<5> yr = sqrt (y) - -fabs (BatchScalar<5> (-1));
+    CHECK_EQUAL (yr[0], 1);
+    CHECK_EQUAL (yr[4], 5);
+
+    BatchScalar<8> acc = 1;
+    acc *= x;
+    acc -= 0.5;
+    acc /= 0.5;
+    acc += x;
+    CHECK_EQUAL (acc[3], 11);
+}
+
+/**
+ * Tests that batches compute the same results as each instance alone.
+ */
+void testMatrixBatchLockstep ()
+{
+    TEST_DEFINE ("MatrixBatchLockstep");
+
+    CHECK_TRUE (checkLockstep<8> ());
+    CHECK_TRUE (checkLockstep<5> ());
+    CHECK_TRUE (checkLockstep<20> ());
+}
+
+/**
+ * Tests moving instances into and out of batches.
+ */
+void testMatrixBatchGatherScatter ()
+{
+    TEST_DEFINE ("MatrixBatchGatherScatter");
+
+    Matrix<2, 3> mats[4];
+    makeInstances (mats, 3);
+    MatrixBatch<2, 3, 4> batch;
+    batchGather (batch, mats);
+
+    // Element (i, j) of every instance is stored contiguously.
+    CHECK_EQUAL (batch (1, 2)[3], mats[3] (1, 2));
+    CHECK_TRUE (&batch (0, 1)[1] == &batch (0, 1)[0] + 1);
+
+    Matrix<2, 3> replacement (9);
+    setBatchLane (batch, 2, replacement);
+    Matrix<2, 3> out[4];
+    batchScatter (batch, out);
+    CHECK_TRUE (out[0] == mats[0]);
+    CHECK_TRUE (out[2] == replacement);
+    CHECK_TRUE (out[3] == mats[3]);
+
+    // Batches work with other matrix types, e.g. symmetric covariances.
+    SymmetricMatrix<2, BatchScalar<4>> cov =
+        SymmetricMatrix<2, BatchScalar<4>>::identity ();
+    cov (0, 1) = batch (0, 0);
+    const Matrix<2, 2, BatchScalar<4>> covFull = cov;
+    CHECK_EQUAL ((batchLane (covFull, 1) (1, 0)), mats[1] (0, 0));
+}
+
+/**
+ * Entry point for matrix batch tests.
+ */
+void test ()
+{
+    testMatrixBatchScalar ();
+    testMatrixBatchLockstep ();
+    testMatrixBatchGatherScatter ();
+}
+
+} // namespace TestMatrixBatch
+
+#endif
@@ -0,0 +1,253 @@
+/**
+ * Tests for MatrixFactorization.
+ */
+
+#ifndef TEST_MATRIX_FACTORIZATION_HPP
+#define TEST_MATRIX_FACTORIZATION_HPP
+
+#include "MatrixFactorization.hpp"
+#include "TestMacros.hpp"
+
+using namespace Photic;
+
+namespace TestMatrixFactorization
+{
+
+/**
+ * Fills a matrix with a symmetric positive definite matrix: a diagonally
+ * dominant matrix with distinct off-diagonal elements.
+ *
+ * @param   kMat Destination matrix.
+ */
+template <Dim_t T_Dim>
+void makeSpd (Matrix<T_Dim, T_Dim>& kMat)
+{
+    for (Dim_t i = 0; i < T_Dim; i++)
+    {
+        for (Dim_t j = 0; j < T_Dim; j++)
+        {
+            kMat (i, j) = i == j ? 10 + i : 1.0 / (1 + i + j);
+        }
+    }
+}
+
+/**
+ * Fills a matrix with a general nonsingular matrix whose leading element is
+ * 0, so that LU requires pivoting.
+ *
+ * @param   kMat Destination matrix.
+ */
+template <Dim_t T_Dim>
+void makeGeneral (Matrix<T_Dim, T_Dim>& kMat)
+{
+    for (Dim_t i = 0; i < T_Dim; i++)
+    {
+        for (Dim_t j = 0; j < T_Dim; j++)
+        {
+            kMat (i, j) = (i == j ? 4.0 : 0.0) +
+                          (Real_t) ((i * 7 + j * 3 + 1) % 5) - 2;
+        }
+    }
+    kMat (0, 0) = 0;
+}
+
+/**
+ * Fills a matrix with right-hand sides.
+ *
+ * @param   kMat Destination matrix.
+ */
+template <Dim_t T_Rows, Dim_t T_Cols>
+void makeRhs (Matrix<T_Rows, T_Cols>& kMat)
+{
+    for (Dim_t i = 0; i < T_Rows; i++)
+    {
+        for (Dim_t j = 0; j < T_Cols; j++)
+        {
+            kMat (i, j) = (Real_t) i - 2 * (Real_t) j + 0.5;
+        }
+    }
+}
+
+/**
+ * Gets if two matrices are equal to within a tolerance.
+ *
+ * @param   kLhs LHS matrix.
+ * @param   kRhs RHS matrix.
+ *
+ * @ret     If every pair of elements differs by at most 1e-4.
+ */
+template <Dim_t T_Rows, Dim_t T_Cols>
+bool approxEqual (const Matrix<T_Rows, T_Cols>& kLhs,
+                  const Matrix<T_Rows, T_Cols>& kRhs)
+{
+    for (uint32_t i = 0; i < T_Rows * T_Cols; i++)
+    {
+        if (fabs (kLhs.mData[i] - kRhs.mData[i]) > 1e-4)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Checks every factorization of an N x N matrix against its product with the
+ * solution.
+ *
+ * @param   kLuOk       Set to if the LU solve is correct.
+ * @param   kCholeskyOk Set to if the Cholesky solve is correct.
+ * @param   kLdltOk     Set to if both LDL^T solves are correct.
+ */
+template <Dim_t T_Dim>
+void checkFactorizations (bool& kLuOk, bool& kCholeskyOk, bool& kLdltOk)
+{
+    Matrix<T_Dim, 2> b;
+    makeRhs (b);
+    Matrix<2, T_Dim> bt = b.transpose ();
+
+    // General matrix with LU.
+    Matrix<T_Dim, T_Dim> a;
+    makeGeneral (a);
+    Matrix<T_Dim, T_Dim> lu = a;
+    Dim_t pivots[T_Dim];
+    Matrix<T_Dim, 2> x = b;
+    kLuOk = luDecompose (lu, pivots);
+    luSolve (lu, pivots, x);
+    Matrix<T_Dim, 2> ax = a * x;
+    kLuOk = kLuOk && approxEqual (ax, b);
+
+    // Symmetric positive definite matrix with Cholesky and LDL^T.
+    makeSpd (a);
+    Matrix<T_Dim, T_Dim> l = a;
+    x = b;
+    kCholeskyOk = choleskyDecompose (l);
+    choleskySolve (l, x);
+    ax = a * x;
+    kCholeskyOk = kCholeskyOk && approxEqual (ax, b);
+
+    Matrix<T_Dim, T_Dim> ldl = a;
+    x = b;
+    Matrix<2, T_Dim> xt = bt;
+    kLdltOk = ldltDecompose (ldl);
+    ldltSolve (ldl, x);
+    ldltSolveRight (ldl, xt);
+    ax = a * x;
+    Matrix<2, T_Dim> xta = xt * a;
+    kLdltOk = kLdltOk && approxEqual (ax, b) && approxEqual (xta, bt);
+}
+
+/**
+ * Tests the factorizations and solves on unrolled (up to 4x4) and looped
+ * sizes.
+ */
+void testMatrixFactorizationSolve ()
+{
+    TEST_DEFINE ("MatrixFactorizationSolve");
+
+    bool luOk;
+    bool choleskyOk;
+    bool ldltOk;
+
+    checkFactorizations<2> (luOk, choleskyOk, ldltOk);
+    CHECK_TRUE (luOk && choleskyOk && ldltOk);
+    checkFactorizations<3> (luOk, choleskyOk, ldltOk);
+    CHECK_TRUE (luOk && choleskyOk && ldltOk);
+    checkFactorizations<4> (luOk, choleskyOk, ldltOk);
+    CHECK_TRUE (luOk && choleskyOk && ldltOk);
+    checkFactorizations<5> (luOk, choleskyOk, ldltOk);
+    CHECK_TRUE (luOk && choleskyOk && ldltOk);
+    checkFactorizations<6> (luOk, choleskyOk, ldltOk);
+    CHECK_TRUE (luOk && choleskyOk && ldltOk);
+}
+
+/**
+ * Tests the factors themselves on a known 3x3 matrix.
+ */
+void testMatrixFactorizationFactors ()
+{
+    TEST_DEFINE ("MatrixFactorizationFactors");
+
+    // A = L L^T with L = [2 0 0; 1 3 0; -1 2 4].
+    Matrix<3, 3> a;
+    a (0, 0) =  4; a (0, 1) =  2; a (0, 2) = -2;
+    a (1, 0) =  2; a (1, 1) = 10; a (1, 2) =  5;
+    a (2, 0) = -2; a (2, 1) =  5; a (2, 2) = 21;
+
+    Matrix<3, 3> l = a;
+    CHECK_TRUE (choleskyDecompose (l));
+    CHECK_EQUAL (l (0, 0), 2);
+    CHECK_EQUAL (l (1, 0), 1);
+    CHECK_EQUAL (l (1, 1), 3);
+    CHECK_EQUAL (l (2, 0), -1);
+    CHECK_EQUAL (l (2, 1), 2);
+    CHECK_EQUAL (l (2, 2), 4);
+
+    // Upper triangle is left unchanged.
+    CHECK_EQUAL (l (0, 1), 2);
+    CHECK_EQUAL (l (1, 2), 5);
+
+    // D = diag (4, 9, 16), and L is the Cholesky factor with unit diagonal.
+    Matrix<3, 3> ldl = a;
+    CHECK_TRUE (ldltDecompose (ldl));
+    CHECK_EQUAL (ldl (0, 0), 4);
+    CHECK_EQUAL (ldl (1, 1), 9);
+    CHECK_EQUAL (ldl (2, 2), 16);
+    CHECK_EQUAL (ldl (1, 0), 0.5);
+    CHECK_EQUAL (ldl (2, 0), -0.5);
+    CHECK_APPROX (ldl (2, 1), 2.0 / 3, 1e-6);
+
+    // LU pivots the largest element of the first column to the top.
+    Matrix<3, 3> lu = a;
+    Dim_t pivots[3];
+    CHECK_TRUE (luDecompose (lu, pivots));
+    CHECK_EQUAL (pivots[0], 0);
+    CHECK_EQUAL (lu (0, 0), 4);
+    CHECK_EQUAL (lu (1, 0), 0.5);
+    CHECK_EQUAL (lu (2, 0), -0.5);
+}
+
+/**
+ * Tests that singular and indefinite matrices are reported.
+ */
+void testMatrixFactorizationFailure ()
+{
+    TEST_DEFINE ("MatrixFactorizationFailure");
+
+    // Rank 2: third row is the sum of the first two.
+    Matrix<3, 3> singular;
+    singular (0, 0) = 1; singular (0, 1) = 2; singular (0, 2) = 3;
+    singular (1, 0) = 0; singular (1, 1) = 1; singular (1, 2) = 4;
+    singular (2, 0) = 1; singular (2, 1) = 3; singular (2, 2) = 7;
+    Matrix<3, 3> lu = singular;
+    Dim_t pivots[3];
+    CHECK_TRUE (!luDecompose (lu, pivots));
+
+    // Symmetric but indefinite.
+    Matrix<2, 2> indefinite;
+    indefinite (0, 0) = 1; indefinite (0, 1) = 2;
+    indefinite (1, 0) = 2; indefinite (1, 1) = 1;
+    Matrix<2, 2> l = indefinite;
+    CHECK_TRUE (!choleskyDecompose (l));
+
+    // LDL^T handles indefinite matrices without pivoting but not a zero pivot.
+    Matrix<2, 2> ldl = indefinite;
+    CHECK_TRUE (ldltDecompose (ldl));
+    Matrix<2, 2> zeroPivot = Matrix<2, 2>::zero ();
+    zeroPivot (0, 1) = 1;
+    zeroPivot (1, 0) = 1;
+    CHECK_TRUE (!ldltDecompose (zeroPivot));
+}
+
+/**
+ * Entry point for matrix factorization tests.
+ */
+void test ()
+{
+    testMatrixFactorizationSolve ();
+    testMatrixFactorizationFactors ();
+    testMatrixFactorizationFailure ();
+}
+
+} // namespace TestMatrixFactorization
+
+#endif
@@ -0,0 +1,167 @@
+/**
+ * Tests for MatrixView.
+ */
+
+#ifndef TEST_MATRIX_VIEW_HPP
+#define TEST_MATRIX_VIEW_HPP
+
+#include "IMUInterface.hpp"
+#include "MathUtils.hpp"
+#include "Matrix.hpp"
+#include "MatrixView.hpp"
+#include "TestMacros.hpp"
+
+using namespace Photic;
+
+namespace TestMatrixView
+{
+
+/**
+ * Gets a 4x4 matrix whose element (i, j) is 10i + j.
+ *
+ * @ret     Matrix.
+ */
+Matrix<4, 4> makeIndexed ()
+{
+    Matrix<4, 4> mat;
+    for (Dim_t i = 0; i < 4; i++)
+    {
+        for (Dim_t j = 0; j < 4; j++)
+        {
+            mat (i, j) = 10 * i + j;
+        }
+    }
+    return mat;
+}
+
+/**
+ * Tests reading and writing blocks, rows and columns of a matrix in place.
+ */
+void testMatrixViewAccess ()
+{
+    TEST_DEFINE ("MatrixViewAccess");
+
+    Matrix<4, 4> mat = makeIndexed ();
+    const Matrix<4, 4>& constMat = mat;
+
+    // Reads see the viewed elements.
+    auto block = blockView<1, 2, 2, 2> (mat);
+    CHECK_EQUAL (block (0, 0), 12);
+    CHECK_EQUAL (block (1, 1), 23);
+    CHECK_EQUAL ((rowView<3> (constMat)[2]), 32);
+    CHECK_EQUAL ((columnView<1> (constMat)[2]), 21);
+    const Matrix<2, 2> blockCopy = block;
+    CHECK_EQUAL (blockCopy (1, 0), 22);
+
+    // Writes go to the viewed matrix, and elements outside the view are
+    // unchanged.
+    block.fill (-1);
+    CHECK_EQUAL (mat (2, 3), -1);
+    CHECK_EQUAL (mat (1, 1), 11);
+    CHECK_EQUAL (mat (3, 3), 33);
+    block (0, 1) = 5;
+    CHECK_EQUAL (mat (1, 3), 5);
+    columnView<0> (mat) *= 2;
+    CHECK_EQUAL (mat (3, 0), 60);
+    CHECK_EQUAL (mat (3, 1), 31);
+
+    // Copying a view copies the pointer, and assigning one view to another
+    // copies elements.
+    auto blockAlias = block;
+    blockAlias (1, 1) = 7;
+    CHECK_EQUAL (mat (2, 3), 7);
+    auto top = blockView<0, 0, 2, 2> (mat);
+    top = block;
+    CHECK_EQUAL (mat (0, 1), 5);
+    CHECK_EQUAL (mat (1, 1), 7);
+
+    // Raw buffers can be viewed with any stride, e.g. every other element.
+    Real_t buf[6] = {1, 2, 3, 4, 5, 6};
+    MatrixView<3, 1, Real_t, 2> odd (buf);
+    odd += odd;
+    CHECK_EQUAL (buf[4], 10);
+    CHECK_EQUAL (buf[5], 6);
+}
+
+/**
+ * Tests views as operands and destinations of matrix operations, including
+ * overlapping views of the same matrix.
+ */
+void testMatrixViewArithmetic ()
+{
+    TEST_DEFINE ("MatrixViewArithmetic");
+
+    Matrix<4, 4> mat = makeIndexed ();
+    const Matrix<4, 4> orig = mat;
+    const Matrix<2, 2> two (2);
+
+    // Views as product operands and destinations.
+    Matrix<2, 2> prod = blockView<0, 0, 2, 2> (mat) * two;
+    CHECK_EQUAL (prod (1, 0), 42);
+    multiplyInto (blockView<2, 2, 2, 2> (mat), two,
+                  blockView<0, 0, 2, 2> (orig));
+    CHECK_EQUAL (mat (2, 2), 20);
+    CHECK_EQUAL (mat (3, 3), 24);
+    multiplyTransposedAddInto (blockView<2, 2, 2, 2> (mat),
+                               Matrix<2, 2>::identity (),
+                               blockView<0, 0, 2, 2> (orig));
+    CHECK_EQUAL (mat (2, 3), 34);
+    Matrix<1, 1> dot = rowView<1> (orig) * columnView<2> (orig);
+    CHECK_EQUAL (dot (0, 0), 10 * 2 + 11 * 12 + 12 * 22 + 13 * 32);
+
+    // Assigning the transpose of a matrix to its own row is done through a
+    // temporary since the view overlaps the operand.
+    mat = orig;
+    rowView<0> (mat) = columnView<0> (mat).transpose ();
+    CHECK_EQUAL (mat (0, 1), 10);
+    CHECK_EQUAL (mat (0, 3), 30);
+
+    // Assigning an overlapping shifted view of a matrix into itself is done
+    // through a temporary.
+    mat = orig;
+    blockView<1, 0, 3, 4> (mat) = blockView<0, 0, 3, 4> (mat);
+    CHECK_EQUAL (mat (1, 0), 0);
+    CHECK_EQUAL (mat (3, 3), 23);
+
+    // A product reading a view of its destination matrix is also done
+    // through a temporary.
+    mat = orig;
+    mat = blockView<0, 0, 4, 4> (mat) * Matrix<4, 4>::identity ();
+    CHECK_TRUE (mat == orig);
+}
+
+/**
+ * Tests math utilities over views of an IMU reading.
+ */
+void testMatrixViewImuBuffer ()
+{
+    TEST_DEFINE ("MatrixViewImuBuffer");
+
+    IMUInterface::Data_t data;
+    data.vecAccel = MathUtils::makeVector3 (1, 2, 3);
+    data.orientQuat = MathUtils::makeVector4 (0.5, 0.5, 0.5, 0.5);
+
+    const MatrixView<4, 1, const Real_t> quat (&data.orientQuat[0]);
+    const MatrixView<3, 1, const Real_t> accel (&data.vecAccel[0]);
+    const Vector3_t viewed = MathUtils::rotateVector (quat, accel);
+    const Vector3_t copied = MathUtils::rotateVector (data.orientQuat,
+                                                      data.vecAccel);
+    CHECK_TRUE (viewed == copied);
+    CHECK_APPROX (viewed[0], 3, 1e-6);
+    CHECK_APPROX (viewed[1], 1, 1e-6);
+    CHECK_APPROX (viewed[2], 2, 1e-6);
+}
+
+/**
+ * Entry point for matrix view tests.
+ */
+void test ()
+{
+    testMatrixViewAccess ();
+    testMatrixViewArithmetic ();
+    testMatrixViewImuBuffer ();
+}
+
+} // namespace TestMatrixView
+
+#endif
@@ -0,0 +1,185 @@
+/**
+ * Tests for MedianHistory.
+ */
+
+#ifndef TEST_MEDIAN_HISTORY_HPP
+#define TEST_MEDIAN_HISTORY_HPP
+
+#include <math.h>
+#include <type_traits>
+
+#include "MedianHistory.hpp"
+#include "TestMacros.hpp"
+
+using namespace Photic;
+
+namespace TestMedianHistory
+{
+
+/**
+ * Computes a percentile of a window by sorting a copy of it.
+ *
+ * @param   kData    Window elements.
+ * @param   kN       Number of elements.
+ * @param   kPercent Percentile in [0, 100].
+ *
+ * @ret     kPercent percentile, interpolated between the closest ranks.
+ */
+Real_t sortedPercentile (const Real_t* const kData, const uint32_t kN,
+                         const Real_t kPercent)
+{
+    // Insertion sort into a copy.
+    Real_t sorted[256];
+    for (uint32_t i = 0; i < kN; i++)
+    {
+        uint32_t j = i;
+        for (; j > 0 && sorted[j - 1] > kData[i]; j--)
+        {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = kData[i];
+    }
+
+    const Real_t pos = kPercent * (kN - 1) / 100;
+    const uint32_t lower = (uint32_t) pos;
+    const Real_t frac = pos - lower;
+    return frac > 0 && lower + 1 < kN ?
+               sorted[lower] + frac * (sorted[lower + 1] - sorted[lower]) :
+               sorted[lower];
+}
+
+/**
+ * Adds a pseudorandom sequence with ties to a history and compares its
+ * percentiles after every add to sorting the same window.
+ *
+ * @ret     If every percentile matched.
+ */
+template <HistoryDim_t T_Dim>
+bool checkAgainstSort ()
+{
+    const uint32_t adds = 400;
+    const Real_t percents[5] = {0, 10, 50, 95, 100};
+    MedianHistory<T_Dim> hist;
+    Real_t data[adds];
+    uint32_t state = 777;
+    bool match = true;
+    for (uint32_t i = 0; i < adds; i++)
+    {
+        state = state * 1103515245 + 12345;
+        data[i] = (Real_t) ((state >> 16) % 50) * 0.5 - 3;
+        hist.add (data[i]);
+
+        const uint32_t first = i + 1 < T_Dim ? 0 : i + 1 - T_Dim;
+        const uint32_t n = i + 1 - first;
+        for (uint32_t j = 0; j < 5; j++)
+        {
+            const Real_t expected =
+                sortedPercentile (data + first, n, percents[j]);
+            match = match && fabs (hist.getPercentile (percents[j]) -
+                                   expected) < 1e-5;
+        }
+    }
+
+    return match;
+}
+
+/**
+ * Tests percentiles against sorting for several capacities.
+ */
+void testMedianHistoryWindow ()
+{
+    TEST_DEFINE ("MedianHistoryWindow");
+
+    CHECK_TRUE (checkAgainstSort<1> ());
+    CHECK_TRUE (checkAgainstSort<8> ());
+    CHECK_TRUE (checkAgainstSort<101> ());
+    CHECK_TRUE (checkAgainstSort<256> ());
+}
+
+/**
+ * Tests robustness to outliers, interpolation and clearing.
+ */
+void testMedianHistoryBehavior ()
+{
+    TEST_DEFINE ("MedianHistoryBehavior");
+
+    // A pressure spike moves the mean but not the median.
+    MedianHistory<5> hist;
+    hist.add (101300);
+    hist.add (101310);
+    hist.add (101305);
+    hist.add (95000);
+    hist.add (101302);
+    CHECK_EQUAL (hist.getMedian (), 101302);
+    CHECK_TRUE (hist.getMean () < 100100);
+
+    // Even counts interpolate between the middle two elements.
+    hist.clear ();
+    hist.add (4);
+    hist.add (1);
+    CHECK_EQUAL (hist.getMedian (), 2.5);
+    CHECK_EQUAL (hist.getPercentile (25), 1.75);
+    CHECK_EQUAL (hist.getPercentile (0), 1);
+    CHECK_EQUAL (hist.getPercentile (100), 4);
+
+    // The History base cannot be used to add around the tree.
+    CHECK_TRUE ((!std::is_convertible<MedianHistory<5>*, History<5>*>::value));
+}
+
+/**
+ * Tests that NaN elements order after every number instead of breaking the
+ * tree, and that the median of the numbers is unaffected while the NaNs are
+ * a minority.
+ */
+void testMedianHistoryNan ()
+{
+    TEST_DEFINE ("MedianHistoryNan");
+
+    const uint32_t adds = 300;
+    const HistoryDim_t dim = 16;
+    MedianHistory<dim> hist;
+    Real_t data[adds];
+    uint32_t state = 99;
+    bool match = true;
+    bool nanOnTop = true;
+    for (uint32_t i = 0; i < adds; i++)
+    {
+        state = state * 1103515245 + 12345;
+        data[i] = i % 7 == 6 ? NAN : (Real_t) ((state >> 16) % 40) - 20;
+        hist.add (data[i]);
+
+        // The median of n elements with only the m numbers sorted first.
+        const uint32_t first = i + 1 < dim ? 0 : i + 1 - dim;
+        const uint32_t n = i + 1 - first;
+        Real_t numbers[dim];
+        uint32_t m = 0;
+        for (uint32_t j = first; j <= i; j++)
+        {
+            if (!isnan (data[j]))
+            {
+                numbers[m++] = data[j];
+            }
+        }
+        const Real_t expected = m < 2 ? numbers[0] :
+            sortedPercentile (numbers, m, (Real_t) 50 * (n - 1) / (m - 1));
+        match = match && hist.getMedian () == expected;
+        nanOnTop = nanOnTop &&
+                   (m == n) != (bool) isnan (hist.getPercentile (100));
+    }
+    CHECK_TRUE (match);
+    CHECK_TRUE (nanOnTop);
+}
+
+/**
+ * Entry point for median history tests.
+ */
+void test ()
+{
+    testMedianHistoryWindow ();
+    testMedianHistoryBehavior ();
+    testMedianHistoryNan ();
+}
+
+} // namespace TestMedianHistory
+
+#endif
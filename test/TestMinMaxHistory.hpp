@@ -0,0 +1,149 @@
+/**
+ * Tests for MinMaxHistory.
+ */
+
+#ifndef TEST_MIN_MAX_HISTORY_HPP
+#define TEST_MIN_MAX_HISTORY_HPP
+
+#include <math.h>
+#include <type_traits>
+
+#include "MinMaxHistory.hpp"
+#include "TestMacros.hpp"
+
+using namespace Photic;
+
+namespace TestMinMaxHistory
+{
+
+/**
+ * Adds a pseudorandom sequence with many ties to a history and compares its
+ * extrema after every add to a scan of the same window.
+ *
+ * @ret     If every extremum matched.
+ */
+template <HistoryDim_t T_Dim>
+bool checkAgainstScan ()
+{
+    const uint32_t adds = 500;
+    MinMaxHistory<T_Dim> hist;
+    Real_t data[adds];
+    uint32_t state = 12345;
+    bool match = true;
+    for (uint32_t i = 0; i < adds; i++)
+    {
+        // Values from a small set so equal elements are common, plus a slow
+        // trend so both deques see long monotonic runs.
+        state = state * 1103515245 + 12345;
+        data[i] = (Real_t) ((state >> 16) % 9) + 0.05 * (i % 40);
+        hist.add (data[i]);
+
+        const uint32_t first = i + 1 < T_Dim ? 0 : i + 1 - T_Dim;
+        Real_t min = data[first];
+        Real_t max = data[first];
+        for (uint32_t j = first; j <= i; j++)
+        {
+            min = data[j] < min ? data[j] : min;
+            max = data[j] > max ? data[j] : max;
+        }
+        match = match && hist.getMin () == min && hist.getMax () == max;
+    }
+
+    return match;
+}
+
+/**
+ * Tests extrema against a linear scan for several capacities.
+ */
+void testMinMaxHistoryWindow ()
+{
+    TEST_DEFINE ("MinMaxHistoryWindow");
+
+    CHECK_TRUE (checkAgainstScan<1> ());
+    CHECK_TRUE (checkAgainstScan<7> ());
+    CHECK_TRUE (checkAgainstScan<64> ());
+}
+
+/**
+ * Tests extrema of monotonic runs, clearing, and the inherited statistics.
+ */
+void testMinMaxHistoryBehavior ()
+{
+    TEST_DEFINE ("MinMaxHistoryBehavior");
+
+    // Rising then falling altitude: the peak stays the maximum until it
+    // leaves the window.
+    MinMaxHistory<4> hist;
+    hist.add (10);
+    hist.add (20);
+    hist.add (30);
+    hist.add (25);
+    CHECK_EQUAL (hist.getMax (), 30);
+    CHECK_EQUAL (hist.getMin (), 10);
+    hist.add (20);
+    hist.add (15);
+    CHECK_EQUAL (hist.getMax (), 30);
+    CHECK_EQUAL (hist.getMin (), 15);
+    hist.add (10);
+    CHECK_EQUAL (hist.getMax (), 25);
+    CHECK_EQUAL (hist.getMean (), 17.5);
+
+    // Clearing drops the old extrema.
+    hist.clear ();
+    hist.add (-1);
+    CHECK_EQUAL (hist.getMax (), -1);
+    CHECK_EQUAL (hist.getMin (), -1);
+    CHECK_TRUE (!hist.atCapacity ());
+
+    // The History base cannot be used to add around the deques.
+    CHECK_TRUE ((!std::is_convertible<MinMaxHistory<4>*, History<4>*>::value));
+}
+
+/**
+ * Tests that a NaN orders after every number instead of flushing the older
+ * candidates from the deques.
+ */
+void testMinMaxHistoryNan ()
+{
+    TEST_DEFINE ("MinMaxHistoryNan");
+
+    MinMaxHistory<5> hist;
+    hist.add (10);
+    hist.add (20);
+    hist.add (NAN);
+    hist.add (5);
+    hist.add (7);
+    CHECK_TRUE (isnan (hist.getMax ()));
+    CHECK_EQUAL (hist.getMin (), 5);
+
+    // Once the NaN leaves the window, the extrema are of the numbers again.
+    hist.add (8);
+    hist.add (3);
+    CHECK_TRUE (isnan (hist.getMax ()));
+    CHECK_EQUAL (hist.getMin (), 3);
+    hist.add (6);
+    CHECK_EQUAL (hist.getMax (), 8);
+    CHECK_EQUAL (hist.getMin (), 3);
+
+    // A NaN is the minimum only when every element is NaN.
+    MinMaxHistory<2> nans;
+    nans.add (NAN);
+    nans.add (NAN);
+    CHECK_TRUE (isnan (nans.getMin ()));
+    nans.add (1);
+    CHECK_EQUAL (nans.getMin (), 1);
+}
+
+/**
+ * Entry point for min/max history tests.
+ */
+void test ()
+{
+    testMinMaxHistoryWindow ();
+    testMinMaxHistoryBehavior ();
+    testMinMaxHistoryNan ();
+}
+
+} // namespace TestMinMaxHistory
+
+#endif
@@ -0,0 +1,175 @@
+/**
+ * Tests for QuantileSketch.
+ */
+
+#ifndef TEST_QUANTILE_SKETCH_HPP
+#define TEST_QUANTILE_SKETCH_HPP
+
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+#include "QuantileSketch.hpp"
+#include "TestMacros.hpp"
+
+using namespace Photic;
+
+namespace TestQuantileSketch
+{
+
+/**
+ * Generates sensor-like noise: a bell curve of sums of uniforms plus rare
+ * large spikes, so the upper tail is long.
+ *
+ * @param   kState Generator state.
+ *
+ * @ret     Next element.
+ */
+double noise (uint32_t& kState)
+{
+    double sum = 0;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        kState = kState * 1103515245 + 12345;
+        sum += (double) ((kState >> 8) & 0xffff) / 65536 - 0.5;
+    }
+    kState = kState * 1103515245 + 12345;
+    return (kState >> 16) % 50 == 0 ? 20 * (1 + sum) : sum;
+}
+
+/**
+ * Gets the fraction of sorted elements below an estimate, counting half of
+ * the elements equal to it.
+ *
+ * @param   kSorted   Sorted elements.
+ * @param   kEstimate Estimated quantile.
+ *
+ * @ret     Rank of the estimate as a fraction.
+ */
+double rankOf (const std::vector<double>& kSorted, const double kEstimate)
+{
+    const size_t lower = std::lower_bound (kSorted.begin (), kSorted.end (),
+                                           kEstimate) - kSorted.begin ();
+    const size_t upper = std::upper_bound (kSorted.begin (), kSorted.end (),
+                                           kEstimate) - kSorted.begin ();
+    return (lower + upper) / 2.0 / kSorted.size ();
+}
+
+/**
+ * Checks p50, p95 and p99 estimates by their rank among the exact sorted
+ * elements, with tighter bounds toward the tail.
+ *
+ * @param   kSketch Sketch of the elements.
+ * @param   kSorted Sorted elements.
+ *
+ * @ret     If every estimate was within bounds.
+ */
+template <typename T_Sketch>
+bool checkRanks (T_Sketch& kSketch, const std::vector<double>& kSorted)
+{
+    return fabs (rankOf (kSorted, kSketch.getPercentile (50)) - 0.50) < 0.01 &&
+           fabs (rankOf (kSorted, kSketch.getPercentile (95)) - 0.95) < 0.006 &&
+           fabs (rankOf (kSorted, kSketch.getPercentile (99)) - 0.99) < 0.003 &&
+           kSketch.getPercentile (0) == kSorted.front () &&
+           kSketch.getPercentile (100) == kSorted.back ();
+}
+
+/**
+ * Tests percentile estimates of a long stream against exact percentiles.
+ */
+void testQuantileSketchAccuracy ()
+{
+    TEST_DEFINE ("QuantileSketchAccuracy");
+
+    const uint32_t adds = 200000;
+    QuantileSketch<64, 64, double> sketch;
+    QuantileSketch<> floatSketch;
+    std::vector<double> data;
+    uint32_t state = 2024;
+    for (uint32_t i = 0; i < adds; i++)
+    {
+        // Store the float-rounded element so both sketches see the same data.
+        data.push_back ((Real_t) noise (state));
+        sketch.add (data.back ());
+        floatSketch.add (data.back ());
+    }
+    std::vector<double> sorted (data);
+    std::sort (sorted.begin (), sorted.end ());
+
+    CHECK_TRUE (checkRanks (sketch, sorted));
+    CHECK_TRUE (checkRanks (floatSketch, sorted));
+    CHECK_EQUAL (sketch.getCount (), adds);
+    CHECK_EQUAL (sketch.getMin (), sorted.front ());
+    CHECK_EQUAL (sketch.getMax (), sorted.back ());
+
+    // Few elements are not compressed, so percentiles interpolate between the
+    // elements themselves.
+    QuantileSketch<8> small;
+    small.add (4);
+    small.add (1);
+    small.add (5);
+    small.add (3);
+    small.add (2);
+    CHECK_EQUAL (small.getMedian (), 3);
+    CHECK_EQUAL (small.getPercentile (0), 1);
+    CHECK_EQUAL (small.getPercentile (100), 5);
+
+    small.clear ();
+    small.add (-7);
+    CHECK_EQUAL (small.getCount (), 1);
+    CHECK_EQUAL (small.getMedian (), -7);
+}
+
+/**
+ * Tests that merging sketches of parts of a stream, each with a different
+ * distribution, estimates the percentiles of the whole stream.
+ */
+void testQuantileSketchMerge ()
+{
+    TEST_DEFINE ("QuantileSketchMerge");
+
+    const uint32_t parts = 8;
+    const uint32_t addsPerPart = 25000;
+    QuantileSketch<64, 64, double> partSketches[parts];
+    std::vector<double> data;
+    uint32_t state = 77;
+    for (uint32_t p = 0; p < parts; p++)
+    {
+        for (uint32_t i = 0; i < addsPerPart; i++)
+        {
+            data.push_back (noise (state) + 0.3 * p);
+            partSketches[p].add (data.back ());
+        }
+    }
+    std::vector<double> sorted (data);
+    std::sort (sorted.begin (), sorted.end ());
+
+    QuantileSketch<64, 64, double> merged;
+    for (uint32_t p = 0; p < parts; p++)
+    {
+        merged.merge (partSketches[p]);
+    }
+    CHECK_TRUE (checkRanks (merged, sorted));
+    CHECK_EQUAL (merged.getCount (), parts * addsPerPart);
+
+    // Merging an empty sketch changes nothing.
+    QuantileSketch<64, 64, double> empty;
+    const double p95 = merged.getPercentile (95);
+    merged.merge (empty);
+    CHECK_EQUAL (merged.getPercentile (95), p95);
+    empty.merge (merged);
+    CHECK_EQUAL (empty.getMin (), sorted.front ());
+}
+
+/**
+ * Entry point for quantile sketch tests.
+ */
+void test ()
+{
+    testQuantileSketchAccuracy ();
+    testQuantileSketchMerge ();
+}
+
+} // namespace TestQuantileSketch
+
+#endif
@@ -0,0 +1,195 @@
+/**
+ * Tests for Quaternion.
+ */
+
+#ifndef TEST_QUATERNION_HPP
+#define TEST_QUATERNION_HPP
+
+#include "MathUtils.hpp"
+#include "Quaternion.hpp"
+#include "TestMacros.hpp"
+
+using namespace Photic;
+
+namespace TestQuaternion
+{
+
+/**
+ * Gets if two quaternions represent the same rotation to within a tolerance,
+ * i.e. are equal up to sign.
+ *
+ * @param   kLhs LHS quaternion.
+ * @param   kRhs RHS quaternion.
+ *
+ * @ret     If the rotations match.
+ */
+bool sameRotation (const Quaternion& kLhs, const Quaternion& kRhs)
+{
+    const Real_t dot = kLhs.w () * kRhs.w () + kLhs.x () * kRhs.x () +
+                       kLhs.y () * kRhs.y () + kLhs.z () * kRhs.z ();
+    return fabs (fabs (dot) - 1) < 1e-5;
+}
+
+/**
+ * Gets if two vectors are equal to within a tolerance.
+ *
+ * @param   kLhs LHS vector.
+ * @param   kRhs RHS vector.
+ *
+ * @ret     If every pair of components differs by at most 1e-5.
+ */
+bool approxEqual (const Vector3_t& kLhs, const Vector3_t& kRhs)
+{
+    return fabs (kLhs[0] - kRhs[0]) < 1e-5 &&
+           fabs (kLhs[1] - kRhs[1]) < 1e-5 &&
+           fabs (kLhs[2] - kRhs[2]) < 1e-5;
+}
+
+/**
+ * Tests the fast inverse square root across many orders of magnitude.
+ */
+void testQuaternionFastInvSqrt ()
+{
+    TEST_DEFINE ("QuaternionFastInvSqrt");
+
+    double maxErr = 0;
+    for (float x = 1e-6; x < 1e6; x *= 1.01)
+    {
+        const double exact = 1 / sqrt ((double) x);
+        const double err =
+            fabs (MathUtils::Fast::invSqrt (x) - exact) / exact;
+        maxErr = err > maxErr ? err : maxErr;
+    }
+    PRINTF ("    max invSqrt relative error: %.3g\n", maxErr);
+    CHECK_TRUE (maxErr < 5e-6);
+    CHECK_EQUAL (MathUtils::Fast::invSqrt (0.25), 2);
+}
+
+/**
+ * Tests normalization, products and conjugates.
+ */
+void testQuaternionAlgebra ()
+{
+    TEST_DEFINE ("QuaternionAlgebra");
+
+    Quaternion p (1, 2, 3, 4);
+    p.normalize ();
+    CHECK_APPROX (p.squaredNorm (), 1, 1e-5);
+    CHECK_APPROX (p.w (), 1 / sqrt (30), 1e-6);
+
+    // A unit quaternion times its conjugate is the identity.
+    CHECK_TRUE (sameRotation (p * p.conjugate (), Quaternion::identity ()));
+
+    // Products compose rotations, applying the RHS first.
+    const Quaternion q = Quaternion (-0.3, 0.1, 0.8, -0.2).normalized ();
+    const Vector3_t v = MathUtils::makeVector3 (0.5, -1, 2);
+    CHECK_TRUE (approxEqual ((p * q).rotate (v), p.rotate (q.rotate (v))));
+
+    // The identity leaves vectors unchanged.
+    CHECK_TRUE (approxEqual (Quaternion::identity ().rotate (v), v));
+}
+
+/**
+ * Tests conversion to and from rotation matrices and Euler angles.
+ */
+void testQuaternionConversions ()
+{
+    TEST_DEFINE ("QuaternionConversions");
+
+    // Each of the four quaternions has a different largest component, so
+    // every branch of the conversion from a rotation matrix is used.
+    const Quaternion quats[4] = {
+        Quaternion (0.9, 0.1, -0.3, 0.2).normalized (),
+        Quaternion (0.1, -0.9, 0.3, 0.2).normalized (),
+        Quaternion (0.1, 0.3, 0.9, -0.2).normalized (),
+        Quaternion (-0.1, 0.3, 0.2, 0.9).normalized ()};
+    const Vector3_t v = MathUtils::makeVector3 (3, -1, 0.25);
+
+    bool matrixOk = true;
+    bool eulerOk = true;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        const Matrix<3, 3> rot = quats[i].toRotationMatrix ();
+        const Vector3_t rotated = rot * v;
+        matrixOk = matrixOk && approxEqual (rotated, quats[i].rotate (v)) &&
+                   sameRotation (Quaternion::fromRotationMatrix (rot),
+                                 quats[i]);
+
+        const Vector3_t euler = quats[i].toEuler ();
+        eulerOk = eulerOk &&
+                  sameRotation (Quaternion::fromEuler (euler[0], euler[1],
+                                                       euler[2]),
+                                quats[i]);
+    }
+    CHECK_TRUE (matrixOk);
+    CHECK_TRUE (eulerOk);
+
+    // Yaw of pi/2 rotates x onto y, and pitch of pi/2 rotates x onto -z.
+    const Vector3_t x = MathUtils::makeVector3 (1, 0, 0);
+    CHECK_TRUE (approxEqual (Quaternion::fromEuler (0, 0, M_PI / 2).rotate (x),
+                             MathUtils::makeVector3 (0, 1, 0)));
+    CHECK_TRUE (approxEqual (Quaternion::fromEuler (0, M_PI / 2, 0).rotate (x),
+                             MathUtils::makeVector3 (0, 0, -1)));
+    const Vector3_t euler = Quaternion::fromEuler (0.3, -0.4, 2.5).toEuler ();
+    CHECK_TRUE (approxEqual (euler, MathUtils::makeVector3 (0.3, -0.4, 2.5)));
+
+    // Fast Euler angles agree with the exact ones to within the documented
+    // approximation error.
+    bool fastOk = true;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        const Vector3_t diff = quats[i].toEulerFast () - quats[i].toEuler ();
+        fastOk = fastOk && fabs (diff[0]) < 1.5e-5 && fabs (diff[1]) < 1.5e-5 &&
+                 fabs (diff[2]) < 1.5e-5;
+    }
+    CHECK_TRUE (fastOk);
+}
+
+/**
+ * Tests integration of body rates.
+ */
+void testQuaternionIntegration ()
+{
+    TEST_DEFINE ("QuaternionIntegration");
+
+    // Spin at 1 rad/s about z for 1 s in 10 large steps.
+    const Vector3_t rates = MathUtils::makeVector3 (0, 0, 1);
+    Quaternion first = Quaternion::identity ();
+    Quaternion second = Quaternion::identity ();
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        first.integrateFirstOrder (rates, 0.1);
+        second.integrateSecondOrder (rates, 0.1);
+    }
+    const Real_t firstErr = fabs (first.toEuler ()[2] - 1);
+    const Real_t secondErr = fabs (second.toEuler ()[2] - 1);
+    PRINTF ("    yaw error, first order: %.3g, second order: %.3g\n",
+            firstErr, secondErr);
+    CHECK_TRUE (firstErr < 1e-3);
+    CHECK_TRUE (secondErr < firstErr);
+    CHECK_APPROX (second.squaredNorm (), 1, 1e-5);
+
+    // A rate about an arbitrary axis rotates that axis onto itself.
+    const Vector3_t axis = MathUtils::makeVector3 (0.6, 0, 0.8);
+    Quaternion q = Quaternion::identity ();
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        q.integrateSecondOrder (axis * 2, 0.01);
+    }
+    CHECK_TRUE (approxEqual (q.rotate (axis), axis));
+}
+
+/**
+ * Entry point for quaternion tests.
+ */
+void test ()
+{
+    testQuaternionFastInvSqrt ();
+    testQuaternionAlgebra ();
+    testQuaternionConversions ();
+    testQuaternionIntegration ();
+}
+
+} // namespace TestQuaternion
+
+#endif
@@ -0,0 +1,166 @@
+/**
+ * Tests for RegressionHistory.
+ */
+
+#ifndef TEST_REGRESSION_HISTORY_HPP
+#define TEST_REGRESSION_HISTORY_HPP
+
+#include <math.h>
+#include <type_traits>
+
+#include "RegressionHistory.hpp"
+#include "TestMacros.hpp"
+
+using namespace Photic;
+
+namespace TestRegressionHistory
+{
+
+/**
+ * Adds a noisy curve to a history and compares the fits after every add to
+ * least squares fits of the same window computed directly.
+ *
+ * @ret     If every fit matched.
+ */
+template <HistoryDim_t T_Dim>
+bool checkAgainstDirect ()
+{
+    const uint32_t adds = 400;
+    RegressionHistory<T_Dim, double> hist;
+    double data[adds];
+    uint32_t state = 99;
+    bool match = true;
+    for (uint32_t i = 0; i < adds; i++)
+    {
+        state = state * 1103515245 + 12345;
+        data[i] = 1000 + 2.5 * i - 0.01 * i * i +
+                  (double) ((state >> 16) % 100) / 20;
+        hist.add (data[i]);
+
+        // Fit over time t = j - i, so the newest element is at t = 0.
+        const uint32_t first = i + 1 < T_Dim ? 0 : i + 1 - T_Dim;
+        const double n = i - first + 1;
+        double meanT = 0;
+        double meanX = 0;
+        for (uint32_t j = first; j <= i; j++)
+        {
+            meanT += ((double) j - i) / n;
+            meanX += data[j] / n;
+        }
+
+        // Line.
+        double stt = 0;
+        double stx = 0;
+        for (uint32_t j = first; j <= i; j++)
+        {
+            const double t = (double) j - i - meanT;
+            stt += t * t;
+            stx += t * (data[j] - meanX);
+        }
+        const double slope = n < 2 ? 0 : stx / stt;
+        const double intercept = meanX - slope * meanT;
+        double sse = 0;
+        for (uint32_t j = first; j <= i; j++)
+        {
+            const double r = data[j] - intercept - slope * ((double) j - i);
+            sse += r * r;
+        }
+
+        // Parabola about the mean time, where t has zero mean and, for evenly
+        // spaced times, zero third moment.
+        double s4 = 0;
+        double s2x = 0;
+        for (uint32_t j = first; j <= i; j++)
+        {
+            const double t = (double) j - i - meanT;
+            s4 += t * t * t * t;
+            s2x += t * t * data[j];
+        }
+        const double curvature = n < 3 ?
+            0 : 2 * (n * s2x - stt * meanX * n) / (n * s4 - stt * stt);
+
+        match = match && fabs (hist.getSlope () - slope) < 1e-8 &&
+                fabs (hist.getIntercept () - intercept) < 1e-8 &&
+                fabs (hist.getResidual () - sqrt (sse / n)) < 1e-6 &&
+                fabs (hist.getCurvature () - curvature) < 1e-8;
+    }
+
+    return match;
+}
+
+/**
+ * Tests fits against direct least squares for several capacities.
+ */
+void testRegressionHistoryWindow ()
+{
+    TEST_DEFINE ("RegressionHistoryWindow");
+
+    CHECK_TRUE (checkAgainstDirect<1> ());
+    CHECK_TRUE (checkAgainstDirect<2> ());
+    CHECK_TRUE (checkAgainstDirect<17> ());
+    CHECK_TRUE (checkAgainstDirect<64> ());
+}
+
+/**
+ * Tests exact fits of a line and a parabola, and clearing.
+ */
+void testRegressionHistoryBehavior ()
+{
+    TEST_DEFINE ("RegressionHistoryBehavior");
+
+    // Altitude climbing 2 m per sample is fit exactly.
+    RegressionHistory<10> hist;
+    for (uint32_t i = 0; i < 25; i++)
+    {
+        hist.add (100 + 2 * i);
+    }
+    CHECK_APPROX (hist.getSlope (), 2, 1e-4);
+    CHECK_APPROX (hist.getIntercept (), 148, 1e-3);
+    CHECK_APPROX (hist.getResidual (), 0, 1e-2);
+    CHECK_APPROX (hist.getCurvature (), 0, 1e-4);
+    CHECK_APPROX (hist.getMean (), 139, 1e-3);
+
+    // Coasting to apogee: x = -0.5 t^2 has slope 0 at the peak and
+    // curvature -1 throughout.
+    hist.clear ();
+    for (int32_t t = -9; t <= 0; t++)
+    {
+        hist.add (-0.5 * t * t);
+    }
+    CHECK_APPROX (hist.getCurvature (), -1, 1e-4);
+    CHECK_TRUE (hist.getSlope () > 0);
+
+    // The trend turns negative once the peak is older than the middle of the
+    // window.
+    for (int32_t t = 1; t <= 5; t++)
+    {
+        hist.add (-0.5 * t * t);
+    }
+    CHECK_TRUE (hist.getSlope () < 0);
+    CHECK_APPROX (hist.getCurvature (), -1, 1e-4);
+
+    // Too few elements to fit.
+    hist.clear ();
+    hist.add (5);
+    CHECK_EQUAL (hist.getSlope (), 0);
+    CHECK_EQUAL (hist.getIntercept (), 5);
+    CHECK_EQUAL (hist.getResidual (), 0);
+    CHECK_EQUAL (hist.getCurvature (), 0);
+
+    // The History base cannot be used to add around the weighted sums.
+    CHECK_TRUE ((!std::is_convertible<RegressionHistory<10>*,
+                                      History<10>*>::value));
+}
+
+/**
+ * Entry point for regression history tests.
+ */
+void test ()
+{
+    testRegressionHistoryWindow ();
+    testRegressionHistoryBehavior ();
+}
+
+} // namespace TestRegressionHistory
+
+#endif
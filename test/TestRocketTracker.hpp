@@ -9,6 +9,7 @@
 #include <math.h>
 #include <random>
 
+#include "Fixed.hpp"
 #include "RocketTracker.hpp"
 #include "TestMacros.hpp"
 
@@ -88,12 +89,39 @@ public:
     }
 };
 
+/**
+ * BarometerInterface whose readings drift 500 m while RocketTracker profiles
+ * it, further from the first reading than centimeter int16_t storage reaches,
+ * then read below the launchpad.
+ */
+class DriftingBarometerInterface final : public BarometerInterface
+{
+public:
+    DriftingBarometerInterface () : mReadings (0) {}
+
+    virtual bool init ()
+    {
+        return true;
+    }
+
+    virtual bool run ()
+    {
+        mData.altitude = mReadings < 1000 ? 1500 + 0.5 * mReadings : 1000;
+        mReadings++;
+
+        return true;
+    }
+
+private:
+    uint32_t mReadings; /* Number of readings taken. */
+};
+
 /**
  * Tests that RocketTracker correctly tracks the rocket's state. This runs the
  * same falling simulation and accuracy tests as KalmanFilterAccuracyIncrease in
  * TestKalmanFilter.hpp.
  */
-void test ()
+void testRocketTracker ()
 {
     TEST_DEFINE ("RocketTracker");
 
@@ -151,6 +179,119 @@ void test ()
     delete pBarometer;
 }
 
+/**
+ * Compares a fixed-point Kalman filter against the float filter used by
+ * RocketTracker over the same falling simulation. Both filters are fed the
+ * same observations. Q18.14 is used since the simulated fall reaches ~49 km,
+ * which is out of range for Q16.16.
+ */
+void testRocketTrackerFixedPoint ()
+{
+    TEST_DEFINE ("RocketTrackerFixedPoint");
+
+    typedef Fixed<14> Fixed_t;
+
+    // Current timestep, timestep size, and duration of simulation.
+    Real_t t = 0;
+    const Real_t tStep = 0.1;
+    const Real_t duration = 100;
+
+    // Float and fixed-point filters configured identically.
+    KalmanFilter kf;
+    BasicKalmanFilter<Fixed_t> kfFixed;
+    kf.setDeltaT (tStep);
+    kfFixed.setDeltaT (tStep);
+    kf.setSensorVariance (posVariance, accelVariance);
+    kfFixed.setSensorVariance (posVariance, accelVariance);
+    kf.setInitialState (0, 0, 0);
+    kfFixed.setInitialState (0, 0, 0);
+    kf.computeKg (100);
+    kfFixed.computeKg (100);
+
+    Vector3_t state (0);
+    Vector3_t stateFiltered (0);
+    Matrix<3, 1, Fixed_t> stateFixed (0);
+    Real_t maxDivergence = 0;
+
+    // Run falling simulation loop.
+    while (t < duration)
+    {
+        state[2] = 9.81;
+        state[1] += state[2] * tStep;
+        state[0] += state[1] * tStep;
+
+        const Real_t posObserved = state[0] + posErrDistr (generator);
+        const Real_t accelObserved = state[2] + accelErrDistr (generator);
+        stateFiltered = kf.filter (posObserved, accelObserved);
+        stateFixed = kfFixed.filter (posObserved, accelObserved);
+
+        const Real_t divergence = fabs ((Real_t) stateFixed[0] -
+                                        stateFiltered[0]);
+        maxDivergence = divergence > maxDivergence ? divergence : maxDivergence;
+
+        t += tStep;
+    }
+
+    // Report the accuracy of both filters so the trade can be judged.
+    Real_t floatError[3];
+    Real_t fixedError[3];
+    for (Dim_t i = 0; i < 3; i++)
+    {
+        floatError[i] = fabs (state[i] - stateFiltered[i]) / state[i];
+        fixedError[i] = fabs (state[i] - (Real_t) stateFixed[i]) / state[i];
+    }
+    PRINTF ("    float error: pos %.2e, vel %.2e, accel %.2e\n",
+            floatError[0], floatError[1], floatError[2]);
+    PRINTF ("    Q18.14 error: pos %.2e, vel %.2e, accel %.2e\n",
+            fixedError[0], fixedError[1], fixedError[2]);
+    PRINTF ("    max Q18.14 altitude divergence from float: %.3f\n",
+            maxDivergence);
+
+    // Fixed-point estimates meet the same bounds as the float tracker and stay
+    // close to the float estimates throughout.
+    CHECK_TRUE (fixedError[0] < 0.01);
+    CHECK_TRUE (fixedError[1] < 0.01);
+    CHECK_TRUE (fixedError[2] < 0.01);
+    CHECK_TRUE (maxDivergence < 1);
+}
+
+/**
+ * Tests that the launchpad altitude found while profiling is the mean of every
+ * barometer reading, however far they drift from the first.
+ */
+void testRocketTrackerDrift ()
+{
+    TEST_DEFINE ("RocketTrackerDrift");
+
+    // Rocket at rest on the launchpad.
+    stateTrue = Vector3_t (0);
+    SimulationIMUInterface* pImu = new SimulationIMUInterface ();
+    DriftingBarometerInterface* pBarometer = new DriftingBarometerInterface ();
+
+    RocketTracker::Config_t trackerConfig = RocketTracker::getDefaultConfig ();
+    trackerConfig.pImu = pImu;
+    trackerConfig.pBarometer = pBarometer;
+
+    // Readings below the launchpad are floored at the launchpad altitude, so
+    // the tracker starts and stays there.
+    RocketTracker tracker (trackerConfig);
+    const Vector3_t stateTracked = tracker.track ();
+    CHECK_TRUE (fabs (stateTracked[0] - (1500 + 0.5 * 999 / 2)) < 0.5);
+
+    delete pImu;
+    delete pBarometer;
+}
+
+/**
+ * Entry point for RocketTracker tests.
+ */
+void test ()
+{
+    testRocketTracker ();
+    testRocketTrackerFixedPoint ();
+    testRocketTrackerDrift ();
+}
+
 } // namespace RocketTrackerTests
 
 #endif
\ No newline at end of file
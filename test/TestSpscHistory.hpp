@@ -0,0 +1,124 @@
+/**
+ * Tests for SpscHistory.
+ */
+
+#ifndef TEST_SPSC_HISTORY_HPP
+#define TEST_SPSC_HISTORY_HPP
+
+#include <atomic>
+#include <math.h>
+#include <thread>
+
+#include "SpscHistory.hpp"
+#include "TestMacros.hpp"
+
+using namespace Photic;
+
+namespace TestSpscHistory
+{
+
+/**
+ * Tests queueing, overruns and clearing from a single thread.
+ */
+void testSpscHistoryBehavior ()
+{
+    TEST_DEFINE ("SpscHistoryBehavior");
+
+    SpscHistory<4, Real_t, Real_t, HistoryStorage<Real_t>, 3> hist;
+    CHECK_TRUE (hist.add (1));
+    CHECK_TRUE (hist.add (2));
+    CHECK_TRUE (hist.add (3));
+
+    // The queue is full until the reader drains it.
+    CHECK_TRUE (!hist.add (4));
+    CHECK_EQUAL (hist.getOverruns (), 1);
+    CHECK_EQUAL (hist.getMean (), 2);
+    CHECK_TRUE (!hist.atCapacity ());
+    CHECK_TRUE (hist.add (4));
+    CHECK_TRUE (hist.add (5));
+    CHECK_EQUAL (hist.drain (), 2);
+    CHECK_TRUE (hist.atCapacity ());
+    CHECK_EQUAL (hist.getMean (), 3.5);
+
+    // Clearing drops queued elements too.
+    hist.add (100);
+    hist.clear ();
+    hist.add (-1);
+    CHECK_EQUAL (hist.getMean (), -1);
+    CHECK_EQUAL (hist.getStdev (), 0);
+    CHECK_EQUAL (hist.getOverruns (), 1);
+}
+
+/**
+ * Tests a writer thread adding consecutive integers as fast as it can while
+ * a reader thread reads statistics. A window of consecutive integers has a
+ * known standard deviation and a mean that must never decrease, so a torn or
+ * reordered element shows up in either.
+ */
+void testSpscHistoryStress ()
+{
+    TEST_DEFINE ("SpscHistoryStress");
+
+    const HistoryDim_t dim = 64;
+    const uint32_t adds = 200000;
+    const double windowStdev = sqrt ((dim * dim - 1) / 12.0);
+    SpscHistory<dim, double, double, HistoryStorage<double>, 16> hist;
+
+    // Writer retries dropped elements so that every integer arrives. Both
+    // sides yield when blocked so the test also progresses on one core.
+    uint32_t retries = 0;
+    std::atomic<bool> done (false);
+    std::thread writer ([&hist, &retries, &done, adds] ()
+    {
+        for (uint32_t i = 0; i < adds; i++)
+        {
+            while (!hist.add (i))
+            {
+                retries++;
+                std::this_thread::yield ();
+            }
+        }
+        done = true;
+    });
+
+    // Read until the writer is done and the queue is empty.
+    bool ordered = true;
+    double lastMean = -1;
+    while (true)
+    {
+        const bool writerDone = done;
+        if (hist.drain () == 0)
+        {
+            if (writerDone)
+            {
+                break;
+            }
+            std::this_thread::yield ();
+        }
+        if (hist.atCapacity ())
+        {
+            const double mean = hist.getMean ();
+            ordered = ordered && mean >= lastMean &&
+                      fabs (hist.getStdev () - windowStdev) < 1e-6;
+            lastMean = mean;
+        }
+    }
+    writer.join ();
+
+    CHECK_TRUE (ordered);
+    CHECK_EQUAL (hist.getMean (), adds - 1 - (dim - 1) / 2.0);
+    CHECK_EQUAL (hist.getOverruns (), retries);
+}
+
+/**
+ * Entry point for SPSC history tests.
+ */
+void test ()
+{
+    testSpscHistoryBehavior ();
+    testSpscHistoryStress ();
+}
+
+} // namespace TestSpscHistory
+
+#endif
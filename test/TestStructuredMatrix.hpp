@@ -0,0 +1,147 @@
+/**
+ * Tests for StructuredMatrix.
+ */
+
+#ifndef TEST_STRUCTURED_MATRIX_HPP
+#define TEST_STRUCTURED_MATRIX_HPP
+
+#include "Matrix.hpp"
+#include "MathUtils.hpp"
+#include "StructuredMatrix.hpp"
+#include "SymmetricMatrix.hpp"
+#include "TestMacros.hpp"
+
+using namespace Photic;
+
+namespace TestStructuredMatrix
+{
+
+/**
+ * Selector and unit upper triangular matrices used in tests.
+ */
+static constexpr uint64_t selectorPattern =
+    matrixPatternBit (0, 0, 3) | matrixPatternBit (1, 2, 3);
+typedef StructuredMatrix<2, 3, selectorPattern, selectorPattern> Selector_t;
+typedef StructuredMatrix<3, 3, matrixPatternUpper (3, 3),
+                         matrixPatternDiagonal (3, 3)> UnitUpper3_t;
+typedef StructuredMatrix<4, 4, matrixPatternUpper (4, 4),
+                         matrixPatternDiagonal (4, 4)> UnitUpper4_t;
+
+/**
+ * Tests pattern helpers and structured matrix construction.
+ */
+void testStructuredMatrixConstruct ()
+{
+    TEST_DEFINE ("StructuredMatrixConstruct");
+
+    // Check pattern helpers.
+    static_assert (matrixPatternDiagonal (3, 3) == 0x111, "diagonal pattern");
+    static_assert (matrixPatternUpper (3, 3) == 0x137, "upper pattern");
+    static_assert (matrixPatternDiagonal (2, 3) == 0x11, "diagonal pattern");
+    static_assert (matrixPatternUpper (2, 3) == 0x37, "upper pattern");
+
+    // Check that structural elements are set and free elements are zeroed.
+    const Selector_t h;
+    const Matrix<2, 3> hFull = h;
+    Matrix<2, 3> hExpected = Matrix<2, 3>::zero ();
+    hExpected (0, 0) = 1;
+    hExpected (1, 2) = 1;
+    CHECK_TRUE (hFull == hExpected);
+    CHECK_TRUE (Selector_t::unit (1, 2));
+    CHECK_TRUE (Selector_t::zero (1, 1));
+
+    UnitUpper3_t a;
+    const Matrix<3, 3> aFull = a;
+    CHECK_TRUE ((aFull == Matrix<3, 3>::identity ()));
+    a (0, 2) = 5;
+    CHECK_EQUAL (a (0, 2), 5);
+    CHECK_TRUE (!UnitUpper3_t::zero (0, 2) && !UnitUpper3_t::unit (0, 2));
+}
+
+/**
+ * Tests that structured products match the equivalent dense products.
+ */
+void testStructuredMatrixProducts ()
+{
+    TEST_DEFINE ("StructuredMatrixProducts");
+
+    const Selector_t h;
+    UnitUpper3_t a;
+    a (0, 1) = 0.1;
+    a (0, 2) = 0.005;
+    a (1, 2) = 0.1;
+    const Matrix<2, 3> hFull = h;
+    const Matrix<3, 3> aFull = a;
+    const Matrix<3, 3> m = MathUtils::makeMatrix3 ( 1,  2, -3,
+                                                    4, -5,  6,
+                                                   -7,  8,  9);
+    const Vector3_t v = MathUtils::makeVector3 (3, -2, 0.5);
+
+    // Expression products.
+    Vector2_t hv = h * v;
+    Vector2_t hvExpected = hFull * v;
+    CHECK_TRUE (hv == hvExpected);
+    Matrix<3, 3> am = a * m * a.transpose ();
+    Matrix<3, 3> amExpected = aFull * m * aFull.transpose ();
+    CHECK_TRUE (am == amExpected);
+
+    // Destination-passing kernels.
+    Vector3_t av;
+    multiplyInto (av, a, v);
+    const Vector3_t avExpected = aFull * v;
+    CHECK_TRUE (av == avExpected);
+    multiplySubtractInto (hv, h, v);
+    CHECK_TRUE (hv == Vector2_t (0));
+    Matrix<3, 2> mht;
+    multiplyTransposedInto (mht, m, h);
+    const Matrix<3, 2> mhtExpected = m * hFull.transpose ();
+    CHECK_TRUE (mht == mhtExpected);
+
+    // Symmetric kernels.
+    SymmetricMatrix<3> p = SymmetricMatrix<3>::identity ();
+    p (0, 1) = 0.5;
+    p (1, 2) = -0.25;
+    const Matrix<3, 3> pFull = p;
+    SymmetricMatrix<3> apat;
+    propagateInto (apat, a, p);
+    const Matrix<3, 3> apatExpected = aFull * pFull * aFull.transpose ();
+    for (Dim_t i = 0; i < 3; i++)
+    {
+        for (Dim_t j = i; j < 3; j++)
+        {
+            CHECK_APPROX (apat (i, j), apatExpected (i, j), 1e-6);
+        }
+    }
+    SymmetricMatrix<2> hpht;
+    propagateInto (hpht, h, p);
+    const Matrix<2, 2> hphtFull = hpht;
+    const Matrix<2, 2> hphtExpected = hFull * pFull * hFull.transpose ();
+    CHECK_TRUE (hphtFull == hphtExpected);
+
+    // A product wide enough for the vectorized kernel.
+    UnitUpper4_t b;
+    b (0, 3) = 2;
+    b (1, 2) = -1;
+    const Matrix<4, 4> bFull = b;
+    Matrix<4, 4> n;
+    for (Dim_t i = 0; i < 16; i++)
+    {
+        n[i] = i - 7.5;
+    }
+    const Matrix<4, 4> bn = b * n;
+    const Matrix<4, 4> bnExpected = bFull * n;
+    CHECK_TRUE (bn == bnExpected);
+}
+
+/**
+ * Runs all tests.
+ */
+void test ()
+{
+    testStructuredMatrixConstruct ();
+    testStructuredMatrixProducts ();
+}
+
+} // namespace TestStructuredMatrix
+
+#endif
@@ -0,0 +1,167 @@
+/**
+ * Tests for SymmetricMatrix.
+ */
+
+#ifndef TEST_SYMMETRIC_MATRIX_HPP
+#define TEST_SYMMETRIC_MATRIX_HPP
+
+#include "Matrix.hpp"
+#include "MathUtils.hpp"
+#include "SymmetricMatrix.hpp"
+#include "TestMacros.hpp"
+
+using namespace Photic;
+
+namespace TestSymmetricMatrix
+{
+
+/**
+ * Gets a 3x3 symmetric matrix with distinct elements for use in tests.
+ */
+SymmetricMatrix<3> makeTestMatrix ()
+{
+    SymmetricMatrix<3> p;
+    p (0, 0) = 4;
+    p (0, 1) = 1.5;
+    p (0, 2) = -2;
+    p (1, 1) = 3;
+    p (1, 2) = 0.25;
+    p (2, 2) = 5;
+    return p;
+}
+
+/**
+ * Tests symmetric matrix construction, access, and mutation.
+ */
+void testSymmetricMatrixConstructAccessMutate ()
+{
+    TEST_DEFINE ("SymmetricMatrixConstructAccessMutate");
+
+    // Check that 6 elements are stored for a 3x3.
+    CHECK_EQUAL (sizeof (SymmetricMatrix<3>), 6 * sizeof (Real_t));
+
+    // Check fill constructor.
+    SymmetricMatrix<3> p (3);
+    for (Dim_t i = 0; i < 3; i++)
+    {
+        for (Dim_t j = 0; j < 3; j++)
+        {
+            CHECK_EQUAL (p (i, j), 3);
+        }
+    }
+
+    // Check that writing (i, j) also writes (j, i).
+    p (2, 0) = 7;
+    CHECK_EQUAL (p (0, 2), 7);
+    CHECK_EQUAL (p (2, 0), 7);
+    CHECK_EQUAL (p (1, 1), 3);
+
+    // Check zero and identity, including in constant expressions.
+    constexpr SymmetricMatrix<3> kIdentity = SymmetricMatrix<3>::identity ();
+    static_assert (kIdentity (1, 1) == 1 && kIdentity (0, 2) == 0,
+                   "identity must be constexpr");
+    const Matrix<3, 3> identityFull = kIdentity;
+    const Matrix<3, 3> zeroFull = SymmetricMatrix<3>::zero ();
+    CHECK_TRUE ((identityFull == Matrix<3, 3>::identity ()));
+    CHECK_TRUE ((zeroFull == Matrix<3, 3>::zero ()));
+
+    // Check conversion to a full matrix.
+    const SymmetricMatrix<3> q = makeTestMatrix ();
+    Matrix<3, 3> full = q;
+    CHECK_TRUE (full == full.transpose ());
+    CHECK_EQUAL (full (2, 1), 0.25);
+
+    // Check in-place addition and subtraction.
+    SymmetricMatrix<3> r = q;
+    r += q;
+    const Matrix<3, 3> rFull = r;
+    CHECK_TRUE (rFull == full + full);
+    r -= q;
+    CHECK_TRUE (r == q);
+}
+
+/**
+ * Tests the symmetric matrix kernels against the equivalent full products.
+ */
+void testSymmetricMatrixKernels ()
+{
+    TEST_DEFINE ("SymmetricMatrixKernels");
+
+    const SymmetricMatrix<3> p = makeTestMatrix ();
+    const Matrix<3, 3> pFull = p;
+    const Matrix<3, 3> a = MathUtils::makeMatrix3 (1, 0.1, 0.005,
+                                                   0, 1,   0.1,
+                                                   0, 0,   1);
+    Matrix<2, 3> h = Matrix<2, 3>::zero ();
+    h (0, 0) = 1;
+    h (1, 2) = 1;
+
+    // P H^T.
+    Matrix<3, 2> pht;
+    multiplyTransposedInto (pht, p, h);
+    const Matrix<3, 2> phtExpected = pFull * h.transpose ();
+    CHECK_TRUE (pht == phtExpected);
+
+    // A P.
+    Matrix<3, 3> ap;
+    multiplyInto (ap, a, p);
+    const Matrix<3, 3> apExpected = a * pFull;
+    CHECK_TRUE (ap == apExpected);
+
+    // A P A^T.
+    SymmetricMatrix<3> apat;
+    propagateInto (apat, a, p);
+    const Matrix<3, 3> apatExpected = a * pFull * a.transpose ();
+    for (Dim_t i = 0; i < 3; i++)
+    {
+        for (Dim_t j = i; j < 3; j++)
+        {
+            CHECK_APPROX (apat (i, j), apatExpected (i, j), 1e-5);
+        }
+    }
+
+    // A P A^T in place.
+    SymmetricMatrix<3> pInPlace = p;
+    propagateInto (pInPlace, a, pInPlace);
+    CHECK_TRUE (pInPlace == apat);
+
+    // H P H^T, both directly and as H (P H^T).
+    SymmetricMatrix<2> hpht;
+    propagateInto (hpht, h, p);
+    const Matrix<2, 2> hphtExpected = h * pFull * h.transpose ();
+    const Matrix<2, 2> hphtFull = hpht;
+    CHECK_TRUE (hphtFull == hphtExpected);
+    SymmetricMatrix<2> hpht2;
+    multiplyInto (hpht2, h, pht);
+    CHECK_TRUE (hpht2 == hpht);
+
+    // P - K (P H^T)^T.
+    const Matrix<3, 2> k = pht * 0.5;
+    SymmetricMatrix<3> pUpdated = p;
+    multiplyTransposedSubtractInto (pUpdated, k, pht);
+    const Matrix<3, 3> pUpdatedExpected = pFull - k * pht.transpose ();
+    for (Dim_t i = 0; i < 3; i++)
+    {
+        for (Dim_t j = i; j < 3; j++)
+        {
+            CHECK_APPROX (pUpdated (i, j), pUpdatedExpected (i, j), 1e-5);
+        }
+    }
+
+    // Symmetric matrices in expressions.
+    const Matrix<3, 3> sum = p + a;
+    CHECK_TRUE (sum == pFull + a);
+}
+
+/**
+ * Runs all tests.
+ */
+void test ()
+{
+    testSymmetricMatrixConstructAccessMutate ();
+    testSymmetricMatrixKernels ();
+}
+
+} // namespace TestSymmetricMatrix
+
+#endif
@@ -0,0 +1,122 @@
+/**
+ * Tests for TieredHistory.
+ */
+
+#ifndef TEST_TIERED_HISTORY_HPP
+#define TEST_TIERED_HISTORY_HPP
+
+#include <math.h>
+
+#include "TieredHistory.hpp"
+#include "TestMacros.hpp"
+
+using namespace Photic;
+
+namespace TestTieredHistory
+{
+
+/**
+ * Adds a pseudorandom sequence to a history and compares the statistics of
+ * every prefix of tiers after every add to a scan of the elements they span.
+ *
+ * @ret     If every statistic matched.
+ */
+template <HistoryDim_t T_TierDim, Dim_t T_Tiers, uint16_t T_Decimation>
+bool checkAgainstScan ()
+{
+    const uint32_t adds = 3000;
+    TieredHistory<T_TierDim, T_Tiers, T_Decimation> hist;
+    Real_t data[adds];
+    uint32_t state = 4321;
+    bool match = true;
+    for (uint32_t i = 0; i < adds; i++)
+    {
+        state = state * 1103515245 + 12345;
+        data[i] = (Real_t) ((state >> 16) % 1000) / 10 + 0.01 * i;
+        hist.add (data[i]);
+
+        for (Dim_t k = 1; k <= T_Tiers; k++)
+        {
+            const uint32_t span = hist.getSpan (k);
+            const uint32_t first = i + 1 - span;
+            Real_t min = data[first];
+            Real_t max = data[first];
+            Real_t sum = 0;
+            for (uint32_t j = first; j <= i; j++)
+            {
+                min = data[j] < min ? data[j] : min;
+                max = data[j] > max ? data[j] : max;
+                sum += data[j];
+            }
+            match = match && span <= i + 1 && hist.getMin (k) == min &&
+                    hist.getMax (k) == max &&
+                    fabs (hist.getMean (k) - sum / span) < 1e-3;
+        }
+
+        // Nothing is lost until the last tier starts evicting.
+        match = match && (hist.getSpan (T_Tiers) == i + 1 ||
+                          hist.getSpan (T_Tiers) >= T_TierDim);
+    }
+
+    return match;
+}
+
+/**
+ * Tests statistics against a linear scan for several tier layouts.
+ */
+void testTieredHistoryWindow ()
+{
+    TEST_DEFINE ("TieredHistoryWindow");
+
+    CHECK_TRUE ((checkAgainstScan<4, 3, 2> ()));
+    CHECK_TRUE ((checkAgainstScan<10, 3, 5> ()));
+    CHECK_TRUE ((checkAgainstScan<8, 4, 8> ()));
+}
+
+/**
+ * Tests the span of each tier, long-horizon extrema and clearing.
+ */
+void testTieredHistoryBehavior ()
+{
+    TEST_DEFINE ("TieredHistoryBehavior");
+
+    // 10 entries per tier decimated by 10: 10 + 100 + 1000 elements in 30
+    // entries, plus 9 tier 1 entries evicted and pending a tier 2 entry.
+    TieredHistory<10, 3, 10> hist;
+    for (uint32_t i = 0; i < 5000; i++)
+    {
+        hist.add (i == 1000 ? 1e4 : (Real_t) (i % 100));
+    }
+    CHECK_EQUAL (hist.getSpan (1), 10);
+    CHECK_EQUAL (hist.getSpan (2), 110);
+    CHECK_EQUAL (hist.getSpan (3), 1200);
+
+    // The spike is 4000 elements old, beyond the horizon.
+    CHECK_EQUAL (hist.getMax (3), 99);
+    CHECK_EQUAL (hist.getMin (1), 90);
+    CHECK_EQUAL (hist.getMean (1), 94.5);
+
+    hist.add (1e4);
+    CHECK_EQUAL (hist.getMax (1), 1e4);
+    CHECK_EQUAL (hist.getSpan (3), 1201);
+
+    hist.clear ();
+    hist.add (-2);
+    CHECK_EQUAL (hist.getSpan (3), 1);
+    CHECK_EQUAL (hist.getMin (3), -2);
+    CHECK_EQUAL (hist.getMax (3), -2);
+    CHECK_EQUAL (hist.getMean (3), -2);
+}
+
+/**
+ * Entry point for tiered history tests.
+ */
+void test ()
+{
+    testTieredHistoryWindow ();
+    testTieredHistoryBehavior ();
+}
+
+} // namespace TestTieredHistory
+
+#endif
@@ -0,0 +1,184 @@
+/**
+ * Tests for TimedHistory.
+ */
+
+#ifndef TEST_TIMED_HISTORY_HPP
+#define TEST_TIMED_HISTORY_HPP
+
+#include <math.h>
+
+#include "TimedHistory.hpp"
+#include "TestMacros.hpp"
+
+using namespace Photic;
+
+namespace TestTimedHistory
+{
+
+/**
+ * Adds a noisy sequence at jittered intervals, starting just before the
+ * timestamps wrap around, and compares the statistics after every add to a
+ * scan of the elements within the window.
+ *
+ * @ret     If every statistic matched.
+ */
+bool checkAgainstScan ()
+{
+    const uint32_t adds = 2000;
+    const uint32_t window = 200000;
+    TimedHistory<64, double> hist (window);
+    double data[adds];
+    uint32_t time[adds];
+    uint32_t state = 777;
+    uint32_t now = 0xffffffff - 3000000;
+    bool match = true;
+    for (uint32_t i = 0; i < adds; i++)
+    {
+        // 5 to 15 ms between samples, with some repeated timestamps.
+        state = state * 1103515245 + 12345;
+        now += (state >> 16) % 7 == 0 ? 0 : 5000 + (state >> 16) % 10000;
+        state = state * 1103515245 + 12345;
+        time[i] = now;
+        data[i] = 0.5 * i + (double) ((state >> 16) % 100) / 10;
+        hist.add (data[i], time[i]);
+
+        uint32_t first = i;
+        while (first > 0 && now - time[first - 1] <= window)
+        {
+            first--;
+        }
+        const double n = i - first + 1;
+        double min = data[first];
+        double max = data[first];
+        double sumX = 0;
+        double sumT = 0;
+        for (uint32_t j = first; j <= i; j++)
+        {
+            min = data[j] < min ? data[j] : min;
+            max = data[j] > max ? data[j] : max;
+            sumX += data[j];
+            sumT += (double) (uint32_t) (time[j] - time[first]) * 1e-6;
+        }
+        double stt = 0;
+        double stx = 0;
+        for (uint32_t j = first; j <= i; j++)
+        {
+            const double t = (double) (uint32_t) (time[j] - time[first]) *
+                             1e-6 - sumT / n;
+            stt += t * t;
+            stx += t * (data[j] - sumX / n);
+        }
+        const double slope = stt > 0 ? stx / stt : 0;
+
+        match = match && hist.getSize () == n && hist.getMin () == min &&
+                hist.getMax () == max &&
+                fabs (hist.getMean () - sumX / n) < 1e-9 &&
+                fabs (hist.getSlope () - slope) < 1e-6 &&
+                hist.getSpan () == now - time[first];
+    }
+
+    return match;
+}
+
+/**
+ * Tests windows against a linear scan.
+ */
+void testTimedHistoryWindow ()
+{
+    TEST_DEFINE ("TimedHistoryWindow");
+
+    CHECK_TRUE (checkAgainstScan ());
+}
+
+/**
+ * Tests a rate-independent window, the capacity limit, expiry and clearing.
+ */
+void testTimedHistoryBehavior ()
+{
+    TEST_DEFINE ("TimedHistoryBehavior");
+
+    // A ramp of 3 units per second over a 1 s window holds the same slope and
+    // span at 100 Hz and 20 Hz.
+    TimedHistory<128> fast (1000000);
+    TimedHistory<128> slow (1000000);
+    for (uint32_t t = 0; t <= 5000000; t += 10000)
+    {
+        fast.add (1 + 3e-6 * t, t);
+        if (t % 50000 == 0)
+        {
+            slow.add (1 + 3e-6 * t, t);
+        }
+    }
+    CHECK_APPROX (fast.getSlope (), 3, 1e-3);
+    CHECK_APPROX (slow.getSlope (), 3, 1e-3);
+    CHECK_EQUAL (fast.getSpan (), 1000000);
+    CHECK_EQUAL (slow.getSpan (), 1000000);
+    CHECK_EQUAL (fast.getSize (), 101);
+    CHECK_EQUAL (slow.getSize (), 21);
+    CHECK_APPROX (fast.getMean (), 14.5, 1e-4);
+    CHECK_APPROX (fast.getMin (), 13, 1e-4);
+    CHECK_APPROX (fast.getMax (), 16, 1e-4);
+
+    // A history too small for its window keeps the newest elements.
+    TimedHistory<4> small (1000000);
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        small.add (i, i * 1000);
+    }
+    CHECK_EQUAL (small.getSize (), 4);
+    CHECK_EQUAL (small.getMin (), 6);
+    CHECK_EQUAL (small.getMean (), 7.5);
+
+    // Expiry without new elements empties the window.
+    small.expire (1008500);
+    CHECK_EQUAL (small.getSize (), 1);
+    CHECK_EQUAL (small.getMax (), 9);
+    CHECK_EQUAL (small.getSlope (), 0);
+    small.expire (2000000);
+    CHECK_EQUAL (small.getSize (), 0);
+    CHECK_EQUAL (small.getSpan (), 0);
+    small.add (-4, 2000001);
+    CHECK_EQUAL (small.getMean (), -4);
+
+    small.clear ();
+    small.add (2, 5);
+    CHECK_EQUAL (small.getSize (), 1);
+    CHECK_EQUAL (small.getMin (), 2);
+}
+
+/**
+ * Tests that the slope stays accurate over a long run when the capacity is
+ * much larger than the window needs, so the ring buffer index rarely wraps.
+ */
+void testTimedHistoryLongRun ()
+{
+    TEST_DEFINE ("TimedHistoryLongRun");
+
+    // Altitude climbing at 100 m/s, sampled at 100 Hz for 40 s, in a 0.5 s
+    // window.
+    TimedHistory<4096> hist (500000);
+    Real_t maxError = 0;
+    for (uint32_t i = 0; i < 4000; i++)
+    {
+        const uint32_t now = 10000 * i;
+        hist.add (1000 + 100 * (Real_t) now * 1e-6, now);
+        const Real_t error = fabs (hist.getSlope () - 100);
+        maxError = i > 0 && error > maxError ? error : maxError;
+    }
+    CHECK_TRUE (maxError < 0.1);
+    CHECK_EQUAL (hist.getSize (), 51);
+}
+
+/**
+ * Entry point for timed history tests.
+ */
+void test ()
+{
+    testTimedHistoryWindow ();
+    testTimedHistoryBehavior ();
+    testTimedHistoryLongRun ();
+}
+
+} // namespace TestTimedHistory
+
+#endif
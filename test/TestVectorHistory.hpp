@@ -0,0 +1,150 @@
+/**
+ * Tests for VectorHistory.
+ */
+
+#ifndef TEST_VECTOR_HISTORY_HPP
+#define TEST_VECTOR_HISTORY_HPP
+
+#include "History.hpp"
+#include "MathUtils.hpp"
+#include "MatrixView.hpp"
+#include "TestMacros.hpp"
+#include "VectorHistory.hpp"
+
+using namespace Photic;
+
+namespace TestVectorHistory
+{
+
+/**
+ * Tests that per-channel statistics match a History per channel and that the
+ * covariance matches a direct computation.
+ */
+void testVectorHistoryStats ()
+{
+    TEST_DEFINE ("VectorHistoryStats");
+
+    // Overflow the history so it is forced to throw out old samples.
+    VectorHistory<5, 3> hist;
+    History<5> channels[3];
+    Vector3_t samples[8];
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        samples[i] = MathUtils::makeVector3 (9.81 + 0.1 * (i % 3),
+                                             2 * (i % 3) - 1.0 * i,
+                                             (Real_t) (i * i % 5));
+        hist.add (samples[i]);
+        for (Dim_t c = 0; c < 3; c++)
+        {
+            channels[c].add (samples[i][c]);
+        }
+    }
+
+    const Vector3_t mean = hist.getMean ();
+    const Vector3_t stdev = hist.getStdev ();
+    const SymmetricMatrix<3> cov = hist.getCovariance ();
+    bool statsOk = true;
+    for (Dim_t c = 0; c < 3; c++)
+    {
+        statsOk = statsOk && fabs (mean[c] - channels[c].getMean ()) < 1e-5 &&
+                  fabs (stdev[c] - channels[c].getStdev ()) < 1e-5;
+    }
+    CHECK_TRUE (statsOk);
+
+    // Covariance of the last 5 samples, computed directly.
+    bool covOk = true;
+    for (Dim_t c = 0; c < 3; c++)
+    {
+        for (Dim_t d = 0; d < 3; d++)
+        {
+            Real_t expected = 0;
+            for (uint32_t i = 3; i < 8; i++)
+            {
+                expected += (samples[i][c] - mean[c]) *
+                            (samples[i][d] - mean[d]) / 5;
+            }
+            covOk = covOk && fabs (cov (c, d) - expected) < 1e-4;
+        }
+    }
+    CHECK_TRUE (covOk);
+    CHECK_APPROX (cov (1, 1), stdev[1] * stdev[1], 1e-4);
+}
+
+/**
+ * Tests adding views, capacity and clearing.
+ */
+void testVectorHistoryCapAndClear ()
+{
+    TEST_DEFINE ("VectorHistoryCapAndClear");
+
+    // Samples can be views of raw sensor buffers.
+    const Real_t reading[2] = {3, -4};
+    VectorHistory<2, 2, float, double> hist;
+    CHECK_TRUE (!hist.atCapacity ());
+    hist.add (MatrixView<2, 1, const Real_t> (reading));
+    CHECK_TRUE (!hist.atCapacity ());
+    CHECK_EQUAL (hist.getMean ()[1], -4);
+    CHECK_EQUAL (hist.getStdev ()[0], 0);
+    hist.add (MathUtils::makeVector2 (5, -4));
+    CHECK_TRUE (hist.atCapacity ());
+    CHECK_EQUAL (hist.getMean ()[0], 4);
+    CHECK_EQUAL (hist.getStdev ()[0], 1);
+    CHECK_EQUAL (hist.getStdev ()[1], 0);
+
+    hist.clear ();
+    CHECK_TRUE (!hist.atCapacity ());
+    hist.add (MathUtils::makeVector2 (7, 8));
+    CHECK_EQUAL (hist.getMean ()[0], 7);
+    CHECK_EQUAL (hist.getCovariance () (0, 1), 0);
+}
+
+/**
+ * Tests that a covariance accumulator matches a VectorHistory holding every
+ * sample, whether samples are added as vectors or as strided buffers.
+ */
+void testCovarianceAccumulator ()
+{
+    TEST_DEFINE ("CovarianceAccumulator");
+
+    VectorHistory<20, 2, float, double> hist;
+    CovarianceAccumulator<2, float, double> accum;
+    CovarianceAccumulator<2, float, double> strided;
+    float buffer[2][20];
+    for (uint32_t i = 0; i < 20; i++)
+    {
+        buffer[0][i] = 1000 + 0.01f * (i * 7 % 11);
+        buffer[1][i] = -0.5f * i + (i % 4);
+        const Matrix<2, 1, float> sample =
+            MatrixView<2, 1, const float, 20> (&buffer[0][i]);
+        hist.add (sample);
+        accum.add (sample);
+        strided.add (&buffer[0][i], 20);
+    }
+    const SymmetricMatrix<2, double> cov = hist.getCovariance ();
+    CHECK_EQUAL (accum.getCount (), 20);
+    CHECK_EQUAL (accum.getMean ()[0], hist.getMean ()[0]);
+    CHECK_EQUAL (strided.getMean ()[1], hist.getMean ()[1]);
+    CHECK_EQUAL (accum.getCovariance () (0, 0), cov (0, 0));
+    CHECK_EQUAL (accum.getCovariance () (0, 1), cov (0, 1));
+    CHECK_EQUAL (strided.getCovariance () (1, 1), cov (1, 1));
+
+    // One sample has no spread, and clearing restarts from the next sample.
+    accum.clear ();
+    accum.add (MathUtils::makeVector2<float> (3, 4));
+    CHECK_EQUAL (accum.getMean ()[0], 3);
+    CHECK_EQUAL (accum.getCovariance () (1, 1), 0);
+}
+
+/**
+ * Entry point for vector history tests.
+ */
+void test ()
+{
+    testVectorHistoryStats ();
+    testVectorHistoryCapAndClear ();
+    testCovarianceAccumulator ();
+}
+
+} // namespace TestVectorHistory
+
+#endif